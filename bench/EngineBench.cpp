@@ -0,0 +1,211 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Runs a stress scene (resources/scripts/bench.lua) for a fixed number of frames and writes a JSON report
+// with the profiler's stage times, the draw calls and the peak memory.
+// Usage: SDL3DBench [--frames 1000] [--output Bench.json] [--objects 500] [--model suzanne|building]
+//                   [--bodies 100] [--lights 1] [--scripted 100] [--pipelined 1] [--headless 1] [--dump-frames 0]
+//                   [--deferred 1] [--shadows 0] [--static 0]
+// Every --name value pair is given to the scene as a launch parameter.
+
+#include <Game.hpp>
+#include <Profiler.hpp>
+#include <Utils.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define BENCH_SCRIPT_FILE "bench.lua"
+#define BENCH_DEFAULT_FRAMES 1000
+#define BENCH_DEFAULT_OUTPUT "Bench.json"
+
+// In kilobytes, -1 if we can't know
+static long getPeakMemory()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return -1;
+
+	return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+
+#if defined(__APPLE__)
+	return static_cast<long>(usage.ru_maxrss / 1024); // In bytes on OS X
+#else
+	return static_cast<long>(usage.ru_maxrss); // Already in kilobytes on Linux
+#endif
+#endif
+}
+
+// For JSON strings: quotes, backslashes and control characters are escaped (Windows paths are full of backslashes)
+static std::string escapeJSON(const std::string& text)
+{
+	std::string escaped;
+
+	for(char character : text)
+	{
+		switch(character)
+		{
+			case '"': escaped += "\\\""; break;
+			case '\\': escaped += "\\\\"; break;
+			case '\n': escaped += "\\n"; break;
+			case '\r': escaped += "\\r"; break;
+			case '\t': escaped += "\\t"; break;
+
+			default:
+				if(static_cast<unsigned char>(character) < 0x20)
+				{
+					char code[7];
+					std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(character));
+					escaped += code;
+				} else
+					escaped += character;
+		}
+	}
+
+	return escaped;
+}
+
+static bool writeReport(const std::string& path, const std::map<std::string, std::string>& parameters,
+	int frames, const Profiler& profiler)
+{
+	FILE* file = std::fopen(path.c_str(), "w");
+
+	if(!file)
+	{
+		std::fprintf(stderr, "Could not open '%s' to write the report!\n", path.c_str());
+		return false;
+	}
+
+	std::fprintf(file, "{\n\t\"parameters\": {");
+	bool first = true;
+	for(auto& parameter : parameters)
+	{
+		std::fprintf(file, "%s\n\t\t\"%s\": \"%s\"", first ? "" : ",",
+			escapeJSON(parameter.first).c_str(), escapeJSON(parameter.second).c_str());
+		first = false;
+	}
+	std::fprintf(file, "\n\t},\n");
+
+	std::fprintf(file, "\t\"frames\": %d,\n", frames);
+	std::fprintf(file, "\t\"recordedFrames\": %d,\n", profiler.getRecordedFrames()); // Stats are over these last frames
+	std::fprintf(file, "\t\"peakMemoryKB\": %ld,\n", getPeakMemory());
+
+	// Times are in microseconds, counters are counts
+	std::fprintf(file, "\t\"stages\": {");
+	for(int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+	{
+		std::fprintf(file, "%s\n\t\t\"%s\": {\"average\": %.2f, \"min\": %.0f, \"max\": %.0f, \"p50\": %.0f, \"p95\": %.0f, \"p99\": %.0f}",
+			(stage == 0) ? "" : ",",
+			escapeJSON(Profiler::getStageName(stage)).c_str(),
+			profiler.getAverage(stage),
+			profiler.getMin(stage),
+			profiler.getMax(stage),
+			profiler.getPercentile(stage, 50.0f),
+			profiler.getPercentile(stage, 95.0f),
+			profiler.getPercentile(stage, 99.0f));
+	}
+	std::fprintf(file, "\n\t}\n}\n");
+
+	std::fclose(file);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	Utils::clearDataOutput();
+
+	int frames = BENCH_DEFAULT_FRAMES;
+	std::string outputPath = BENCH_DEFAULT_OUTPUT;
+	bool headless = false;
+	bool deferred = false;
+	int dumpInterval = 0;
+	std::map<std::string, std::string> parameters;
+
+	for(int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string name = argv[i];
+		std::string value = argv[i + 1];
+
+		if(name.compare(0, 2, "--") != 0)
+		{
+			std::fprintf(stderr, "Unexpected argument '%s'!\n", name.c_str());
+			return 1;
+		}
+
+		name = name.substr(2);
+
+		if(name == "frames")
+			frames = std::atoi(value.c_str());
+		else if(name == "output")
+			outputPath = value;
+		else if(name == "headless")
+			headless = (std::atoi(value.c_str()) != 0);
+		else if(name == "dump-frames")
+			dumpInterval = std::atoi(value.c_str());
+		else if(name == "deferred")
+			deferred = (std::atoi(value.c_str()) != 0);
+		else
+			parameters[name] = value;
+	}
+
+	if(frames < 1)
+	{
+		std::fprintf(stderr, "Need at least one frame!\n");
+		return 1;
+	}
+
+	Game game;
+	game.setMainScriptFile(BENCH_SCRIPT_FILE);
+	game.setHeadless(headless, HEADLESS_FRAME_DUMP_PREFIX, dumpInterval);
+	game.setFrameLimit(frames);
+	game.setRenderingPath(deferred ? RENDERING_PATH_DEFERRED : RENDERING_PATH_FORWARD);
+
+	for(auto& parameter : parameters)
+		game.setLaunchParameter(parameter.first, parameter.second);
+
+	game.init();
+	game.startMainLoop(); // Returns after the last frame
+
+	if(!writeReport(outputPath, parameters, game.getFrameCount(), game.getProfiler()))
+		return 1;
+
+	std::printf("%d frames, average frame %.0f us, p99 %.0f us, %.0f draw calls. Report written to '%s'.\n",
+		game.getFrameCount(),
+		game.getProfiler().getAverage(PROFILER_STAGE_FRAME),
+		game.getProfiler().getPercentile(PROFILER_STAGE_FRAME, 99.0f),
+		game.getProfiler().getAverage(PROFILER_COUNTER_DRAW_CALLS),
+		outputPath.c_str());
+
+	return 0;
+}
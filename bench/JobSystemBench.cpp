@@ -0,0 +1,146 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// Shows how the job system scales from 1 thread to every core.
+// For each thread count, transforms a lot of points with parallelFor and runs a small task graph.
+// Usage: SDL3DJobBench [points] [runs]
+
+#include <JobSystem.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using benchClock = std::chrono::steady_clock;
+
+// In miliseconds
+static double getElapsedTime(benchClock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(benchClock::now() - start).count();
+}
+
+// Enough math per point that we measure the threads, not the memory
+static void transformPoints(std::vector<glm::vec3>& points, std::size_t begin, std::size_t end)
+{
+	glm::mat4 matrix = glm::rotate(glm::mat4(1.0f), 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	for(std::size_t i = begin; i < end; i++)
+	{
+		glm::vec4 point(points[i], 1.0f);
+
+		for(int j = 0; j < 16; j++)
+			point = matrix * point;
+
+		points[i] = glm::vec3(point);
+	}
+}
+
+// Fans out in layers, each layer depending on the whole last one, like a frame's systems would
+static void runTaskGraph(JobSystem& jobSystem, std::vector<glm::vec3>& points)
+{
+	const std::size_t layers = 4;
+	const std::size_t jobsPerLayer = 32;
+	std::size_t slice = points.size() / jobsPerLayer;
+
+	std::vector<JobSystem::jobPointer> lastLayer;
+
+	for(std::size_t layer = 0; layer < layers; layer++)
+	{
+		std::vector<JobSystem::jobPointer> currentLayer;
+
+		for(std::size_t i = 0; i < jobsPerLayer; i++)
+		{
+			std::size_t begin = i * slice;
+			std::size_t end = (i == jobsPerLayer - 1) ? points.size() : begin + slice;
+
+			JobSystem::jobPointer job = jobSystem.createJob([&points, begin, end]() {transformPoints(points, begin, end);});
+
+			for(auto &dependency : lastLayer)
+				jobSystem.addDependency(job, dependency);
+
+			jobSystem.submit(job);
+			currentLayer.push_back(job);
+		}
+
+		lastLayer.swap(currentLayer);
+	}
+
+	for(auto &job : lastLayer)
+		jobSystem.wait(job);
+}
+
+int main(int argc, char* argv[])
+{
+	std::size_t pointCount = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+	int runs = (argc > 2) ? std::atoi(argv[2]) : 5;
+
+	int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+	if(maxThreads < 1)
+		maxThreads = 1;
+
+	std::vector<glm::vec3> points(pointCount, glm::vec3(1.0f, 2.0f, 3.0f));
+
+	std::printf("%zu points, best of %d runs, %d hardware threads\n\n", pointCount, runs, maxThreads);
+	std::printf("threads  parallelFor (ms)  speedup  task graph (ms)  speedup\n");
+
+	double baseParallelFor = 0.0;
+	double baseTaskGraph = 0.0;
+
+	for(int threads = 1; threads <= maxThreads; threads++)
+	{
+		JobSystem jobSystem(threads - 1); // The main thread helps while waiting
+
+		double bestParallelFor = 1e30;
+		double bestTaskGraph = 1e30;
+
+		for(int run = 0; run < runs; run++)
+		{
+			benchClock::time_point start = benchClock::now();
+			jobSystem.parallelFor(points.size(), 0, [&points](std::size_t begin, std::size_t end)
+			{
+				transformPoints(points, begin, end);
+			});
+			bestParallelFor = std::min(bestParallelFor, getElapsedTime(start));
+
+			start = benchClock::now();
+			runTaskGraph(jobSystem, points);
+			bestTaskGraph = std::min(bestTaskGraph, getElapsedTime(start));
+		}
+
+		if(threads == 1)
+		{
+			baseParallelFor = bestParallelFor;
+			baseTaskGraph = bestTaskGraph;
+		}
+
+		std::printf("%7d  %16.2f  %6.2fx  %15.2f  %6.2fx\n", threads,
+			bestParallelFor, baseParallelFor / bestParallelFor,
+			bestTaskGraph, baseTaskGraph / bestTaskGraph);
+	}
+
+	// So the compiler can't throw the work away
+	std::printf("\nchecksum: %f\n", points[pointCount / 2].x);
+	return 0;
+}
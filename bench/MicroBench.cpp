@@ -0,0 +1,618 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Times the engine's hot functions over growing inputs, so we can see how they scale
+// and prove that optimizations actually help.
+// Needs OpenGL for some of them, so a hidden window is opened (or a headless context with "headless").
+// Usage: SDL3DMicroBench [runs] [csvFile] [headless]
+
+#include <Definitions.hpp>
+#include <PhysicsBody.hpp>
+#include <Camera.hpp>
+#include <Frustum.hpp>
+#include <LightClusterGrid.hpp>
+#include <ObjectGeometry.hpp>
+#include <ObjectGeometryGroup.hpp>
+#include <MeshSimplifier.hpp>
+#include <Texture.hpp>
+#include <Shader.hpp>
+#include <HighResolutionClock.hpp>
+#include <HeadlessContext.hpp>
+#include <Graphics.hpp>
+#include <Utils.hpp>
+
+#include <SDL.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#define MICRO_BENCH_TEMP_FILE "MicroBenchTemp" // Generated inputs, removed after
+
+class MicroBench
+{
+private:
+	int mRuns;
+	FILE* mCSVFile;
+	std::uint64_t mSink; // Results go here so the compiler can't skip the work
+
+	SDL_Window* mWindow;
+	SDL_GLContext mContext;
+	HeadlessContext mHeadlessContext;
+
+	// Best of mRuns, in nanoseconds
+	template<typename Function>
+	std::int64_t measure(Function function)
+	{
+		std::int64_t best = INT64_MAX;
+
+		for(int run = 0; run < mRuns; run++)
+		{
+			std::int64_t start = HighResolutionClock::getNanoseconds();
+			function();
+			best = std::min(best, HighResolutionClock::getNanoseconds() - start);
+		}
+
+		return best;
+	}
+
+	void report(const char* benchmark, std::size_t size, std::int64_t nanoseconds)
+	{
+		double perItem = static_cast<double>(nanoseconds) / size;
+
+		std::printf("%-26s %10zu %14.1f %14.2f\n", benchmark, size, nanoseconds / 1000.0, perItem);
+
+		if(mCSVFile)
+			std::fprintf(mCSVFile, "%s,%zu,%lld,%.3f\n", benchmark, size, static_cast<long long>(nanoseconds), perItem);
+	}
+
+	static std::string getTempFile(const std::string& extension)
+	{
+		return MICRO_BENCH_TEMP_FILE + extension;
+	}
+
+	// UV sphere, (segments + 1)^2 vertices
+	static ObjectGeometryGroup::GeometryData generateSphere(int segments)
+	{
+		ObjectGeometryGroup::GeometryData sphere;
+		sphere.name = "sphere";
+
+		for(int ring = 0; ring <= segments; ring++)
+		{
+			float theta = CONST_PI * ring / segments;
+
+			for(int segment = 0; segment <= segments; segment++)
+			{
+				float phi = 2.0f * CONST_PI * segment / segments;
+				glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+
+				ObjectGeometry::Vertex vertex;
+				vertex.position = normal * 10.0f;
+				vertex.UV = glm::vec2(static_cast<float>(segment) / segments, static_cast<float>(ring) / segments);
+				vertex.normal = normal;
+				sphere.vertices.push_back(vertex);
+			}
+		}
+
+		for(int ring = 0; ring < segments; ring++)
+		{
+			for(int segment = 0; segment < segments; segment++)
+			{
+				unsigned int first = ring * (segments + 1) + segment;
+				unsigned int second = first + segments + 1;
+
+				unsigned int triangles[] = {first, second, first + 1, second, second + 1, first + 1};
+				sphere.indices.insert(sphere.indices.end(), triangles, triangles + 6);
+			}
+		}
+
+		return sphere;
+	}
+
+	static void writeOBJFile(const std::string& path, const ObjectGeometryGroup::GeometryData& geometry)
+	{
+		std::ofstream file(path);
+
+		file << "o " << geometry.name << '\n';
+		for(auto& vertex : geometry.vertices)
+			file << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+		for(auto& vertex : geometry.vertices)
+			file << "vt " << vertex.UV.x << ' ' << vertex.UV.y << '\n';
+		for(auto& vertex : geometry.vertices)
+			file << "vn " << vertex.normal.x << ' ' << vertex.normal.y << ' ' << vertex.normal.z << '\n';
+
+		for(std::size_t i = 0; i < geometry.indices.size(); i += 3)
+		{
+			file << 'f';
+			for(std::size_t j = 0; j < 3; j++)
+			{
+				unsigned int index = geometry.indices[i + j] + 1; // OBJ starts at 1
+				file << ' ' << index << '/' << index << '/' << index;
+			}
+			file << '\n';
+		}
+	}
+
+	// DXT1 with all of its mipmaps, the blocks are garbage but valid
+	static void writeDDSFile(const std::string& path, unsigned int size)
+	{
+		std::vector<char> header(124, 0);
+		unsigned int linearSize = std::max(1u, size / 4) * std::max(1u, size / 4) * 8;
+		unsigned int mipmapCount = 1;
+		for(unsigned int mipmapSize = size; mipmapSize > 1; mipmapSize /= 2)
+			mipmapCount++;
+
+		std::memcpy(&header[8], &size, 4); // Height
+		std::memcpy(&header[12], &size, 4); // Width
+		std::memcpy(&header[16], &linearSize, 4);
+		std::memcpy(&header[24], &mipmapCount, 4);
+		std::memcpy(&header[80], "DXT1", 4);
+
+		std::vector<char> blocks(linearSize * 2, 0x55); // The loader reads twice the top level for the mipmaps
+
+		std::ofstream file(path, std::ios::binary);
+		file.write("DDS ", 4);
+		file.write(header.data(), header.size());
+		file.write(blocks.data(), blocks.size());
+	}
+
+	// Every uniform is used, so none are optimized out
+	static void writeShaderFiles(const std::string& vertexPath, const std::string& fragmentPath, int uniformCount)
+	{
+		std::ofstream vertexFile(vertexPath);
+		vertexFile << "#version 330 core\n"
+			"layout(location = 0) in vec3 position;\n"
+			"void main() { gl_Position = vec4(position, 1.0); }\n";
+
+		std::ofstream fragmentFile(fragmentPath);
+		fragmentFile << "#version 330 core\nout vec4 color;\n";
+		for(int i = 0; i < uniformCount; i++)
+			fragmentFile << "uniform float value" << i << ";\n";
+
+		fragmentFile << "void main() { float total = 0.0;\n";
+		for(int i = 0; i < uniformCount; i++)
+			fragmentFile << "total += value" << i << ";\n";
+		fragmentFile << "color = vec4(total); }\n";
+	}
+
+public:
+	MicroBench(int runs, FILE* CSVFile)
+	{
+		mRuns = runs;
+		mCSVFile = CSVFile;
+		mSink = 0;
+
+		mWindow = nullptr;
+		mContext = nullptr;
+	}
+
+	~MicroBench()
+	{
+		if(mContext)
+			SDL_GL_DeleteContext(mContext);
+
+		if(mWindow)
+			SDL_DestroyWindow(mWindow);
+
+		SDL_Quit();
+	}
+
+	// Same context as the game, in a window nobody sees
+	bool createWindow()
+	{
+		if(SDL_Init(SDL_INIT_VIDEO) < 0)
+		{
+			std::fprintf(stderr, "Unable to initialize SDL: %s\n", SDL_GetError());
+			return false;
+		}
+
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, GRAPHICS_OPENGL_MAJOR_VERSION);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, GRAPHICS_OPENGL_MINOR_VERSION);
+
+		mWindow = SDL_CreateWindow("SDL3D MicroBench", 0, 0, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+		if(!mWindow)
+		{
+			std::fprintf(stderr, "Unable to create a window: %s\n", SDL_GetError());
+			return false;
+		}
+
+		mContext = SDL_GL_CreateContext(mWindow);
+		if(!mContext || !gladLoadGL())
+		{
+			std::fprintf(stderr, "Unable to create an OpenGL context: %s\n", SDL_GetError());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool initGraphics(bool headless)
+	{
+		if(headless)
+		{
+			if(!mHeadlessContext.create(glm::ivec2(64, 64)))
+				return false;
+		} else if(!createWindow())
+			return false;
+
+		// Like Game::setupGraphics()
+		GLuint vertexArrayID;
+		glGenVertexArrays(1, &vertexArrayID);
+		glBindVertexArray(vertexArrayID);
+		Graphics::setDefaultVertexArray(vertexArrayID);
+		return true;
+	}
+
+	void benchConvexHull()
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+
+		for(std::size_t size = 64; size <= 262144; size *= 8)
+		{
+			PhysicsBody::B2Vec2Vector points(size);
+			for(auto& point : points)
+				point.Set(distribution(random), distribution(random));
+
+			std::int64_t time = measure([&]()
+			{
+				mSink += PhysicsBody::monotoneChainConvexHull(points).size();
+			});
+
+			report("monotoneChainConvexHull", size, time);
+		}
+	}
+
+	// Projection, hull, then poly2tri's triangulation and the Box2D shapes
+	void benchCreateShapes()
+	{
+		for(int segments = 8; segments <= 128; segments *= 2)
+		{
+			ObjectGeometryGroup::GeometryData sphere = generateSphere(segments);
+			ObjectGeometry geometry("sphere", sphere.indices, sphere.vertices);
+
+			std::int64_t time = measure([&]()
+			{
+				mSink += PhysicsBody::createShapesFromObjectGeometry(geometry, false, PHYSICS_PIXELS_PER_METER,
+					glm::vec3(0.0f), glm::vec3(1.0f)).size();
+			});
+
+			report("createShapesFromGeometry", sphere.vertices.size(), time);
+		}
+	}
+
+	// One vertex per index, like many exporters write them
+	void benchWeldVertices()
+	{
+		for(int segments = 8; segments <= 256; segments *= 2)
+		{
+			ObjectGeometryGroup::GeometryData sphere = generateSphere(segments);
+
+			ObjectGeometry::vertexVector unweldedVertices;
+			ObjectGeometry::uintVector unweldedIndices;
+			for(auto index : sphere.indices)
+			{
+				unweldedIndices.push_back(static_cast<unsigned int>(unweldedVertices.size()));
+				unweldedVertices.push_back(sphere.vertices[index]);
+			}
+
+			std::int64_t time = measure([&]()
+			{
+				ObjectGeometry::vertexVector vertices = unweldedVertices;
+				ObjectGeometry::uintVector indices = unweldedIndices;
+				mSink += ObjectGeometry::weldVertices(indices, vertices);
+			});
+
+			report("weldVertices", unweldedVertices.size(), time);
+		}
+	}
+
+	// Half the triangles, like one level of detail
+	void benchSimplifyMesh()
+	{
+		for(int segments = 8; segments <= 256; segments *= 2)
+		{
+			ObjectGeometryGroup::GeometryData sphere = generateSphere(segments);
+			ObjectGeometry::weldVertices(sphere.indices, sphere.vertices);
+
+			std::int64_t time = measure([&]()
+			{
+				MeshSimplifier simplifier(sphere.indices, sphere.vertices);
+				mSink += simplifier.simplify(sphere.indices.size() / 2, 1.0f);
+			});
+
+			report("simplifyMesh", sphere.indices.size() / 3, time);
+		}
+	}
+
+	void benchModelMatrix()
+	{
+		PhysicsBody body;
+
+		for(std::size_t size = 1000; size <= 1000000; size *= 10)
+		{
+			std::int64_t time = measure([&]()
+			{
+				for(std::size_t i = 0; i < size; i++)
+				{
+					body.setPosition(glm::vec3(static_cast<float>(i), 1.0f, 2.0f));
+					body.setRotation(glm::vec3(0.0f, static_cast<float>(i), 0.0f));
+					mSink += static_cast<std::uint64_t>(body.generateModelMatrix()[3][0]);
+				}
+			});
+
+			report("generateModelMatrix", size, time);
+		}
+	}
+
+	void benchProjectionMatrix()
+	{
+		Camera camera;
+
+		for(std::size_t size = 1000; size <= 1000000; size *= 10)
+		{
+			std::int64_t time = measure([&]()
+			{
+				for(std::size_t i = 0; i < size; i++)
+				{
+					camera.setFieldOfView(60.0f + (i % 30));
+					mSink += static_cast<std::uint64_t>(camera.getProjectionMatrix()[0][0]);
+				}
+			});
+
+			report("getProjectionMatrix", size, time);
+		}
+	}
+
+	// Spheres spread all around the camera, about a quarter of them are visible
+	void benchFrustumCulling()
+	{
+		Camera camera;
+		Frustum frustum(camera.getProjectionMatrix() * camera.getViewMatrix());
+
+		std::mt19937 generator(1);
+		std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> radius(0.5f, 5.0f);
+
+		for(std::size_t size = 1000; size <= 1000000; size *= 10)
+		{
+			std::vector<glm::vec4> spheres(size);
+			for(auto &sphere : spheres)
+				sphere = glm::vec4(position(generator), position(generator), position(generator), radius(generator));
+
+			std::vector<unsigned char> results(size);
+
+			std::int64_t time = measure([&]()
+			{
+				frustum.testSpheres(spheres.data(), spheres.size(), results.data());
+				mSink += results[size / 2];
+			});
+
+			report("testSpheres", size, time);
+		}
+	}
+
+	// Lights spread all around the camera, on this thread (the game uses jobs)
+	void benchLightClusters()
+	{
+		Camera camera;
+		LightClusterGrid lightClusterGrid;
+
+		std::mt19937 generator(1);
+		std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> range(5.0f, 50.0f);
+
+		for(std::size_t size = 16; size <= LIGHT_CLUSTER_MAX_LIGHTS; size *= 4)
+		{
+			std::vector<FrameLight> lights(size);
+			for(auto &light : lights)
+			{
+				light.position = glm::vec4(position(generator), position(generator), position(generator), 1.0f);
+				light.diffuseColor = glm::vec4(1.0f);
+				light.specularColor = glm::vec4(1.0f, 1.0f, 1.0f, range(generator));
+			}
+
+			std::int64_t time = measure([&]()
+			{
+				lightClusterGrid.build(lights, camera.getViewMatrix(), camera.getProjectionMatrix(),
+					LIGHT_CLUSTER_MAX_LIGHT_INDICES, nullptr);
+				mSink += lightClusterGrid.getLightIndices().size();
+			});
+
+			report("LightClusterGrid::build", size, time);
+		}
+	}
+
+	void benchLoadOBJFile()
+	{
+		std::string path = getTempFile(".obj");
+
+		for(int segments = 8; segments <= 256; segments *= 2)
+		{
+			ObjectGeometryGroup::GeometryData sphere = generateSphere(segments);
+			writeOBJFile(path, sphere);
+
+			std::int64_t time = measure([&]()
+			{
+				ObjectGeometryGroup group("sphere");
+				mSink += group.loadOBJFile(path);
+			});
+
+			report("loadOBJFile", sphere.vertices.size(), time);
+		}
+
+		std::remove(path.c_str());
+	}
+
+	void benchLoadDDSTexture()
+	{
+		std::string path = getTempFile(".dds");
+
+		for(unsigned int size = 64; size <= 4096; size *= 4)
+		{
+			writeDDSFile(path, size);
+
+			std::int64_t time = measure([&]()
+			{
+				GLuint texture = Texture::loadDDSTexture(path);
+				mSink += texture;
+				glDeleteTextures(1, &texture);
+			});
+
+			report("loadDDSTexture", size * size, time); // In texels
+		}
+
+		std::remove(path.c_str());
+	}
+
+	void benchGetFileContents()
+	{
+		std::string path = getTempFile(".txt");
+
+		for(std::size_t size = 4096; size <= 64 * 1024 * 1024; size *= 16)
+		{
+			{
+				std::vector<char> contents(size, 'a');
+				std::ofstream file(path, std::ios::binary);
+				file.write(contents.data(), contents.size());
+			}
+
+			std::int64_t time = measure([&]()
+			{
+				mSink += Utils::getFileContents(path).size();
+			});
+
+			report("getFileContents", size, time); // In bytes
+		}
+
+		std::remove(path.c_str());
+	}
+
+	// Every uniform looked up 1000 times
+	void benchFindUniform()
+	{
+		std::string vertexPath = getTempFile(".v.glsl");
+		std::string fragmentPath = getTempFile(".f.glsl");
+		const int lookups = 1000;
+
+		for(int uniformCount = 4; uniformCount <= 256; uniformCount *= 4)
+		{
+			writeShaderFiles(vertexPath, fragmentPath, uniformCount);
+			Shader shader("bench", vertexPath, fragmentPath);
+
+			std::vector<std::string> names;
+			std::vector<int> IDs;
+			for(int i = 0; i < uniformCount; i++)
+			{
+				names.push_back("value" + std::to_string(i));
+				IDs.push_back(Shader::getUniformID(names.back()));
+			}
+
+			std::int64_t time = measure([&]()
+			{
+				for(int i = 0; i < lookups; i++)
+				{
+					for(auto& name : names)
+						mSink += shader.findUniform(name);
+				}
+			});
+
+			report("findUniform", uniformCount, time / lookups); // Per lookup of every uniform
+
+			// What drawing does, IDs looked up once
+			time = measure([&]()
+			{
+				for(int i = 0; i < lookups; i++)
+				{
+					for(auto ID : IDs)
+						mSink += shader.getUniform(ID);
+				}
+			});
+
+			report("getUniform", uniformCount, time / lookups);
+		}
+
+		std::remove(vertexPath.c_str());
+		std::remove(fragmentPath.c_str());
+	}
+
+	void runAll()
+	{
+		std::printf("Best of %d runs\n\n", mRuns);
+		std::printf("%-26s %10s %14s %14s\n", "benchmark", "size", "time (us)", "per item (ns)");
+
+		if(mCSVFile)
+			std::fprintf(mCSVFile, "benchmark,size,nanoseconds,nanosecondsPerItem\n");
+
+		benchConvexHull();
+		benchCreateShapes();
+		benchWeldVertices();
+		benchSimplifyMesh();
+		benchModelMatrix();
+		benchProjectionMatrix();
+		benchFrustumCulling();
+		benchLightClusters();
+		benchLoadOBJFile();
+		benchLoadDDSTexture();
+		benchGetFileContents();
+		benchFindUniform();
+
+		std::printf("\n(%llu)\n", static_cast<unsigned long long>(mSink % 10)); // Use the sink
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	int runs = (argc > 1) ? std::atoi(argv[1]) : 5;
+	const char* CSVPath = (argc > 2) ? argv[2] : "MicroBench.csv";
+	bool headless = (argc > 3) && std::string(argv[3]) == "headless";
+
+	if(runs < 1)
+		runs = 1;
+
+	Utils::clearDataOutput();
+
+	FILE* CSVFile = std::fopen(CSVPath, "w");
+	if(!CSVFile)
+		std::fprintf(stderr, "Could not open '%s', results will only be printed.\n", CSVPath);
+
+	{
+		MicroBench bench(runs, CSVFile);
+
+		if(!bench.initGraphics(headless))
+			return 1;
+
+		bench.runAll();
+	}
+
+	if(CSVFile)
+		std::fclose(CSVFile);
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+-- Stress scene for SDL3DBench (bench/EngineBench.cpp)
+-- Everything comes from launch parameters:
+--   objects:   static objects, only rendered
+--   model:     suzanne or building
+--   bodies:    dynamic physics bodies bouncing around
+--   lights:    lights
+--   shadows:   how many of the lights cast shadows
+--   static:    1 to make the objects static bodies, their shadows are only drawn once
+--   scripted:  objects moved by gameStep() each step
+--   pipelined: 1 to simulate on another thread while rendering
+--   instanced: 0 to draw every object with its own draw call
+--   batching:  1 to merge static objects into a few big ones (needs static)
+--   lods:      1 to generate levels of detail for the model and draw far objects with them
+
+local game = getGame()
+
+local resourceManager = game:getResourceManager()
+local entityManager = game:getEntityManager()
+
+local scriptedObjects = {}
+local stepCount = 0
+
+local spacing = 3 -- Between objects, in meters
+
+local function getNumberParameter(name, default)
+	return tonumber(game:getLaunchParameter(name, tostring(default)))
+end
+
+-- Objects are laid out on a square grid, one after the other
+local function getGridPosition(index, side)
+	return Vec3((index % side) * spacing, 0, math.floor(index / side) * spacing)
+end
+
+function gameInit()
+	local objectCount = getNumberParameter("objects", 500)
+	local bodyCount = getNumberParameter("bodies", 100)
+	local lightCount = getNumberParameter("lights", 1)
+	local shadowCount = getNumberParameter("shadows", 0)
+	local scriptedCount = getNumberParameter("scripted", 100)
+	local model = game:getLaunchParameter("model", "suzanne")
+
+	game:setName("SDL3D Bench")
+	game:setMaxFramesPerSecond(0) -- As fast as we can
+	game:setPipelinedRendering(getNumberParameter("pipelined", 0) ~= 0)
+	game:setStaticBatching(getNumberParameter("batching", 0) ~= 0)
+	resourceManager:setLODGeneration(getNumberParameter("lods", 0) ~= 0)
+
+	resourceManager:addShader("shaded.v.glsl", "shaded.f.glsl")
+
+	if getNumberParameter("instanced", 1) ~= 0 then
+		resourceManager:addShader("shadedInstanced.v.glsl", "shaded.f.glsl")
+		resourceManager:findShader("shaded"):setInstancedShader(resourceManager:findShader("shadedInstanced"))
+	end
+	resourceManager:addTexture(model .. ".dds", TextureType.DDS)
+	resourceManager:addObjectGeometryGroup(model .. ".obj")
+
+	local geometry = resourceManager:findObjectGeometryGroup(model):getObjectGeometries()[1]
+	local shader = resourceManager:findShader("shaded")
+	local texture = resourceManager:findTexture(model)
+
+	local total = objectCount + bodyCount + scriptedCount
+	local side = math.max(math.ceil(math.sqrt(total)), 1)
+	local index = 0
+
+	-- Look at the whole grid from a corner
+	local camera = entityManager:getGameCamera()
+	camera:setFieldOfView(90)
+	camera:setFarClippingDistance(side * spacing * 3)
+	camera:getPhysicsBody():setPosition(Vec3(-spacing, side * spacing * 0.5, -spacing))
+	camera:setDirection(Vec4(1, -0.5, 1, 0))
+
+	local positions = {}
+	for i = 1, objectCount do
+		table.insert(positions, getGridPosition(index, side))
+		index = index + 1
+	end
+
+	local objectType = PhysicsBodyType.Ignored
+	if getNumberParameter("static", 0) ~= 0 then
+		objectType = PhysicsBodyType.Static
+	end
+
+	entityManager:addShadedObjectBatch(geometry, shader, texture, positions, objectType)
+
+	local bodies = {}
+	for i = 1, bodyCount do
+		local object = ShadedObject(geometry, shader, texture, false, PhysicsBodyType.Dynamic)
+		object:getPhysicsBody():setPosition(getGridPosition(index, side))
+		entityManager:addObject(object)
+		table.insert(bodies, object)
+		index = index + 1
+	end
+
+	-- All at once, on the job system
+	entityManager:calculateShapes(bodies)
+
+	for i, object in ipairs(bodies) do
+		object:getPhysicsBody():setRestitution(0.8)
+		object:getPhysicsBody():setVelocity(Vec3(math.random() * 4 - 2, 0, math.random() * 4 - 2))
+	end
+
+	for i = 1, scriptedCount do
+		local object = ShadedObject(geometry, shader, texture, false, PhysicsBodyType.Ignored)
+		local position = getGridPosition(index, side)
+		object:getPhysicsBody():setPosition(position)
+		entityManager:addObject(object)
+		table.insert(scriptedObjects, {object = object, center = position})
+		index = index + 1
+	end
+
+	for i = 1, lightCount do
+		local position = getGridPosition(math.floor((i - 1) * total / lightCount), side)
+		local light = Light(Vec3(position.x, 4, position.z), Vec3(1, 1, 1), Vec3(1, 1, 1), 60)
+		light:setShadowCasting(i <= shadowCount)
+		entityManager:addLight(light)
+	end
+
+	Utils.logprint("Bench scene: " .. objectCount .. " objects, " .. bodyCount .. " bodies, "
+		.. lightCount .. " lights (" .. math.min(shadowCount, lightCount) .. " with shadows), " .. scriptedCount .. " scripted objects (" .. model .. ")")
+end
+
+function gameStep()
+	stepCount = stepCount + 1
+
+	-- Small circles, so they stay in their spot
+	for i, scripted in ipairs(scriptedObjects) do
+		local angle = stepCount * 0.05 + i
+		local physicsBody = scripted.object:getPhysicsBody()
+
+		physicsBody:setPosition(Vec3(scripted.center.x + math.cos(angle), scripted.center.y + math.sin(angle), scripted.center.z))
+		physicsBody:setRotation(Vec3(0, stepCount + i, 0))
+	end
+end
@@ -25,6 +25,12 @@ local function foo()
 	resourceManager:addShader("basic.v.glsl", "basic.f.glsl")
 	resourceManager:addShader("textured.v.glsl", "textured.f.glsl")
 	resourceManager:addShader("shaded.v.glsl", "shaded.f.glsl")
+	resourceManager:addShader("texturedInstanced.v.glsl", "textured.f.glsl")
+	resourceManager:addShader("shadedInstanced.v.glsl", "shaded.f.glsl")
+	
+	-- Objects sharing a geometry, shader and texture are drawn all at once
+	resourceManager:findShader("textured"):setInstancedShader(resourceManager:findShader("texturedInstanced"))
+	resourceManager:findShader("shaded"):setInstancedShader(resourceManager:findShader("shadedInstanced"))
 	
 	resourceManager:addTexture("test.bmp", TextureType.BMP)
 	resourceManager:addTexture("suzanne.dds", TextureType.DDS)
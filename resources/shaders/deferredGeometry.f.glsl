@@ -0,0 +1,38 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+// Writes what deferredLighting.f.glsl needs to light the pixel, depth is written by OpenGL
+
+#version 330 core
+
+// Interpolated values from the vertex shader
+in vec2 UV;
+in vec3 normal_cameraspace;
+
+// The G-buffer's color attachments
+layout(location = 0) out vec4 albedo;
+layout(location = 1) out vec4 normal; // Camera space, from 0 to 1
+
+// Values that stay constant for the whole mesh
+uniform sampler2D textureSampler;
+
+void main()
+{
+	albedo = vec4(texture(textureSampler, UV).rgb, 1.0);
+	normal = vec4(normalize(normal_cameraspace) * 0.5 + 0.5, 1.0);
+}
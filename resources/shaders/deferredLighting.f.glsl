@@ -0,0 +1,157 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+// Lights every pixel of the G-buffer with the lights of its cluster, like shaded.f.glsl does for each object.
+// Everything is in camera space, positions come back from the depth.
+
+#version 330 core
+
+in vec2 UV;
+
+out vec3 color;
+
+// Filled once per frame, must match FrameData in RenderSnapshot.hpp
+layout(std140) uniform FrameData
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition; // World space
+	vec4 clusterDepthScale; // The light cluster slice of a depth is log(depth) * x + y
+	ivec4 clusterGridSize; // Light clusters on x, y and z
+	int lightCount;
+	ivec4 shadowLights; // The light using each shadow map slot, -1 for unused slots
+	mat4 shadowMatrices[24]; // SHADOW_MAP_MAX_LIGHTS * 6 cube faces, from world space to the shadow map atlas
+};
+
+// Lights of the frame, 3 texels each: position and power, diffuse color and on state, specular color and range
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightClusters; // Offset and count in lightIndices for each cluster
+uniform usamplerBuffer lightIndices;
+uniform sampler2DShadow shadowMap; // Cube faces of the shadow casting lights, in one atlas
+
+// The G-buffer, one texel per pixel
+uniform sampler2D albedoSampler;
+uniform sampler2D normalSampler;
+uniform sampler2D depthSampler;
+
+uniform mat4 inverseProjectionMatrix;
+
+// The lights reaching this pixel are lightIndices[x] to lightIndices[x + y - 1], see LightClusterGrid
+uvec2 findLightCluster(vec3 position_cameraspace)
+{
+	vec2 tile = floor(UV * vec2(clusterGridSize.xy));
+	float slice = floor(log(-position_cameraspace.z) * clusterDepthScale.x + clusterDepthScale.y);
+	ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), clusterGridSize.xyz - 1);
+	
+	return texelFetch(lightClusters, (cluster.z * clusterGridSize.y + cluster.y) * clusterGridSize.x + cluster.x).xy;
+}
+
+// How much of the light gets to a point, from the light's shadow map if it has one (see ShadowMapCache)
+float getShadow(int lightIndex, vec3 lightPosition_worldspace, vec3 position_worldspace)
+{
+	for(int slot = 0; slot < 4; slot++)
+	{
+		if(shadowLights[slot] != lightIndex)
+			continue;
+		
+		// The cube face the point is in
+		vec3 lightToPosition = position_worldspace - lightPosition_worldspace;
+		vec3 distances = abs(lightToPosition);
+		int face;
+		
+		if(distances.x >= distances.y && distances.x >= distances.z)
+			face = lightToPosition.x > 0.0 ? 0 : 1;
+		else if(distances.y >= distances.z)
+			face = lightToPosition.y > 0.0 ? 2 : 3;
+		else
+			face = lightToPosition.z > 0.0 ? 4 : 5;
+		
+		// Moved towards the light by about a texel (a texel covers 2 * distance / size), so surfaces don't shadow themselves
+		float faceSize = float(textureSize(shadowMap, 0).x) / 6.0;
+		vec3 shadowPosition_worldspace = position_worldspace - lightToPosition * (2.0 / faceSize);
+		
+		vec4 shadowCoord = shadowMatrices[slot * 6 + face] * vec4(shadowPosition_worldspace, 1);
+		return texture(shadowMap, shadowCoord.xyz / shadowCoord.w); // Filtered, 0 in shadow and 1 in light
+	}
+	
+	return 1.0;
+}
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(depthSampler, pixel, 0).r;
+	
+	if(depth == 1.0) // Nothing lit here, keep the background
+		discard;
+	
+	gl_FragDepth = depth; // For what is drawn after
+	
+	vec4 position = inverseProjectionMatrix * vec4(UV * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+	vec3 vertexPosition_cameraspace = position.xyz / position.w;
+	vec3 vertexPosition_worldspace = cameraPosition.xyz + transpose(mat3(viewMatrix)) * vertexPosition_cameraspace; // Views don't scale
+	
+	vec3 materialDiffuseColor = texelFetch(albedoSampler, pixel, 0).rgb;
+	vec3 materialAmbientColor = vec3(0.5, 0.5, 0.5) * materialDiffuseColor;
+	vec3 materialSpecularColor = vec3(1.0, 1.0, 1.0);
+	
+	vec3 n = normalize(texelFetch(normalSampler, pixel, 0).xyz * 2.0 - 1.0); // Normal of the pixel
+	// From the pixel towards the camera
+	vec3 E = normalize(-vertexPosition_cameraspace);
+	
+	// Ambient : simulates indirect lighting
+	color = materialAmbientColor;
+	
+	// Only the lights of our cluster
+	uvec2 cluster = findLightCluster(vertexPosition_cameraspace);
+	
+	for(uint i = 0u; i < cluster.y; i++)
+	{
+		int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).x);
+		int light = lightIndex * 3;
+		vec4 lightPosition = texelFetch(lightData, light); // Power in w
+		vec4 lightDiffuseColor = texelFetch(lightData, light + 1); // On state in w
+		vec4 lightSpecularColor = texelFetch(lightData, light + 2); // Range in w
+		
+		vec3 lightPosition_cameraspace = (viewMatrix * vec4(lightPosition.xyz, 1)).xyz;
+		
+		vec3 lightToVertex = lightPosition_cameraspace - vertexPosition_cameraspace;
+		float squareDistance = dot(lightToVertex, lightToVertex);
+		
+		// Fades out before the light's range, so it doesn't pop at the edge of its clusters
+		float rangeRatio = squareDistance / (lightSpecularColor.w * lightSpecularColor.w);
+		float fade = clamp(1.0 - rangeRatio * rangeRatio, 0.0, 1.0);
+		float lightPower = lightPosition.w * lightDiffuseColor.w * fade * fade; // Lights that are off have no power
+		lightPower *= getShadow(lightIndex, lightPosition.xyz, vertexPosition_worldspace);
+		
+		vec3 ld = normalize(lightToVertex); // Direction of the light (from the pixel to the light)
+		
+		float cosTheta = clamp(dot(n, ld), 0, 1);
+		
+		// Direction in which the surface reflects the light
+		vec3 R = reflect(-ld, n);
+		float cosAlpha = clamp(dot(E, R), 0, 1);
+		
+		color +=
+		// Diffuse
+		materialDiffuseColor * lightDiffuseColor.rgb * lightPower * cosTheta / squareDistance +
+		// Specular, multiplying by cos theta removes artefacts (see shaded.f.glsl)
+		materialSpecularColor * lightSpecularColor.rgb * lightPower * pow(cosAlpha, 5) / squareDistance * cosTheta;
+	}
+}
@@ -19,57 +19,137 @@
 
 // This file is heavily based off http://www.opengl-tutorial.org/, see SpecialThanks.txt
 
-// Per vertex lighting
+// Per fragment lighting, with the lights of the fragment's cluster
 
 #version 330 core
 
 // Interpolated values from the vertex shader
 in vec2 UV;
 in vec3 normal_cameraspace;
-in vec3 lightDirection_cameraspace;
 in vec3 vertexPosition_worldspace;
 in vec3 eyeDirection_cameraspace;
 
 out vec3 color;
 
+// Filled once per frame, must match FrameData in RenderSnapshot.hpp
+layout(std140) uniform FrameData
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition; // World space
+	vec4 clusterDepthScale; // The light cluster slice of a depth is log(depth) * x + y
+	ivec4 clusterGridSize; // Light clusters on x, y and z
+	int lightCount;
+	ivec4 shadowLights; // The light using each shadow map slot, -1 for unused slots
+	mat4 shadowMatrices[24]; // SHADOW_MAP_MAX_LIGHTS * 6 cube faces, from world space to the shadow map atlas
+};
+
+// Lights of the frame, 3 texels each: position and power, diffuse color and on state, specular color and range
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightClusters; // Offset and count in lightIndices for each cluster
+uniform usamplerBuffer lightIndices;
+uniform sampler2DShadow shadowMap; // Cube faces of the shadow casting lights, in one atlas
+
 // Values that stay constant for the whole mesh
 uniform sampler2D textureSampler;
-//uniform vec3 lightColor;
-//uniform float lightPower
 
-void main()
+// The lights reaching this fragment are lightIndices[x] to lightIndices[x + y - 1], see LightClusterGrid
+uvec2 findLightCluster()
+{
+	vec3 vertexPosition_cameraspace = -eyeDirection_cameraspace;
+	vec4 vertexPosition_clipspace = projectionMatrix * vec4(vertexPosition_cameraspace, 1);
+	
+	vec2 tile = floor((vertexPosition_clipspace.xy / vertexPosition_clipspace.w * 0.5 + 0.5) * vec2(clusterGridSize.xy));
+	float slice = floor(log(-vertexPosition_cameraspace.z) * clusterDepthScale.x + clusterDepthScale.y);
+	ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), clusterGridSize.xyz - 1);
+	
+	return texelFetch(lightClusters, (cluster.z * clusterGridSize.y + cluster.y) * clusterGridSize.x + cluster.x).xy;
+}
+
+// How much of the light gets to a point, from the light's shadow map if it has one (see ShadowMapCache)
+float getShadow(int lightIndex, vec3 lightPosition_worldspace, vec3 position_worldspace)
 {
-	//DEBUG
-	vec3 lightPosition_worldspace = vec3(400, 400, 400);
-	vec3 lightColor = vec3(1.0, 1.0, 1.0);
-	float lightPower = 300000.0;
+	for(int slot = 0; slot < 4; slot++)
+	{
+		if(shadowLights[slot] != lightIndex)
+			continue;
+		
+		// The cube face the point is in
+		vec3 lightToPosition = position_worldspace - lightPosition_worldspace;
+		vec3 distances = abs(lightToPosition);
+		int face;
+		
+		if(distances.x >= distances.y && distances.x >= distances.z)
+			face = lightToPosition.x > 0.0 ? 0 : 1;
+		else if(distances.y >= distances.z)
+			face = lightToPosition.y > 0.0 ? 2 : 3;
+		else
+			face = lightToPosition.z > 0.0 ? 4 : 5;
+		
+		// Moved towards the light by about a texel (a texel covers 2 * distance / size), so surfaces don't shadow themselves
+		float faceSize = float(textureSize(shadowMap, 0).x) / 6.0;
+		vec3 shadowPosition_worldspace = position_worldspace - lightToPosition * (2.0 / faceSize);
+		
+		vec4 shadowCoord = shadowMatrices[slot * 6 + face] * vec4(shadowPosition_worldspace, 1);
+		return texture(shadowMap, shadowCoord.xyz / shadowCoord.w); // Filtered, 0 in shadow and 1 in light
+	}
 	
+	return 1.0;
+}
+
+void main()
+{
 	vec3 textureColor = texture(textureSampler, UV).rgb;
 
 	vec3 materialDiffuseColor = textureColor;
 	vec3 materialAmbientColor = vec3(0.5, 0.5, 0.5) * materialDiffuseColor;
 	vec3 materialSpecularColor = vec3(1.0, 1.0, 1.0);
 	
-	float squareDistance = pow(length(lightPosition_worldspace - vertexPosition_worldspace), 2);
-	
 	vec3 n = normalize(normal_cameraspace); // Normal of fragment
-	vec3 ld = normalize(lightDirection_cameraspace); // Direction of the light (from the fragment to the light)
-	
-	float cosTheta = clamp(dot(n, ld), 0, 1); // Always positive! Otherwise we have a negative color.
-	
 	// From vertex towards the camera
 	vec3 E = normalize(eyeDirection_cameraspace);
-	// Direction in which the triangle reflects the light
-	vec3 R = reflect(-ld, n);
-	float cosAlpha = clamp(dot(E, R), 0, 1);
 	
-	color = 
 	// Ambient : simulates indirect lighting
-	materialAmbientColor +
-	// Diffuse : "color" of the object
-	// In GLSL, multiplications are just the multiplications of the vector's components
-	materialDiffuseColor * lightColor * lightPower * cosTheta / squareDistance +
-	// Specular " reflective highlight, like a mirror
-	// Multiplying by cos theta removes annoying artefacts http://www.gamedev.net/topic/672374-blinn-phong-artifact-in-shader/
-	materialSpecularColor * lightColor * lightPower * pow(cosAlpha, 5) / squareDistance * cosTheta;
-}
\ No newline at end of file
+	color = materialAmbientColor;
+	
+	// Only the lights of our cluster
+	uvec2 cluster = findLightCluster();
+	
+	for(uint i = 0u; i < cluster.y; i++)
+	{
+		int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).x);
+		int light = lightIndex * 3;
+		vec4 lightPosition = texelFetch(lightData, light); // Power in w
+		vec4 lightDiffuseColor = texelFetch(lightData, light + 1); // On state in w
+		vec4 lightSpecularColor = texelFetch(lightData, light + 2); // Range in w
+		
+		vec3 lightPosition_worldspace = lightPosition.xyz;
+		
+		vec3 lightToVertex = lightPosition_worldspace - vertexPosition_worldspace;
+		float squareDistance = dot(lightToVertex, lightToVertex);
+		
+		// Fades out before the light's range, so it doesn't pop at the edge of its clusters
+		float rangeRatio = squareDistance / (lightSpecularColor.w * lightSpecularColor.w);
+		float fade = clamp(1.0 - rangeRatio * rangeRatio, 0.0, 1.0);
+		float lightPower = lightPosition.w * lightDiffuseColor.w * fade * fade; // Lights that are off have no power
+		lightPower *= getShadow(lightIndex, lightPosition.xyz, vertexPosition_worldspace);
+		
+		vec3 lightPosition_cameraspace = (viewMatrix * vec4(lightPosition_worldspace, 1)).xyz;
+		vec3 ld = normalize(lightPosition_cameraspace + eyeDirection_cameraspace); // Direction of the light (from the fragment to the light)
+		
+		float cosTheta = clamp(dot(n, ld), 0, 1); // Always positive! Otherwise we have a negative color.
+		
+		// Direction in which the triangle reflects the light
+		vec3 R = reflect(-ld, n);
+		float cosAlpha = clamp(dot(E, R), 0, 1);
+		
+		color +=
+		// Diffuse : "color" of the object
+		// In GLSL, multiplications are just the multiplications of the vector's components
+		materialDiffuseColor * lightDiffuseColor.rgb * lightPower * cosTheta / squareDistance +
+		// Specular " reflective highlight, like a mirror
+		// Multiplying by cos theta removes annoying artefacts http://www.gamedev.net/topic/672374-blinn-phong-artifact-in-shader/
+		materialSpecularColor * lightSpecularColor.rgb * lightPower * pow(cosAlpha, 5) / squareDistance * cosTheta;
+	}
+}
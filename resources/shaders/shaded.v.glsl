@@ -22,43 +22,50 @@
 #version 330 core
 
 // Input vertex data, different for all executions
+// These might be packed in the vertex buffer (see ObjectGeometry::chooseVertexFormat()), OpenGL unpacks them to floats.
+// Quantized positions are decoded by the model matrix.
 layout(location = 0) in vec3 vertexPosition_modelspace;
 layout(location = 1) in vec2 vertexUV;
-layout(location = 2) in vec3 vertexNormal_modelspace;
+layout(location = 2) in vec3 vertexNormal_modelspace; // 10-bit, not quite unit length. The fragment shader normalizes it.
+
+// Filled once per frame, must match FrameData in RenderSnapshot.hpp
+layout(std140) uniform FrameData
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition; // World space
+	vec4 clusterDepthScale; // The light cluster slice of a depth is log(depth) * x + y
+	ivec4 clusterGridSize; // Light clusters on x, y and z
+	int lightCount;
+	ivec4 shadowLights; // The light using each shadow map slot, -1 for unused slots
+	mat4 shadowMatrices[24]; // SHADOW_MAP_MAX_LIGHTS * 6 cube faces, from world space to the shadow map atlas
+};
 
 // Values that stay constant for the whole mesh
 uniform mat4 MVP;
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
-uniform mat4 normalMatrix;
+uniform mat4 normalMatrix; // In camera space
 
 // Output data
 out vec2 UV; // Proxy, sends UV coord to fragment shader
 out vec3 normal_cameraspace;
-out vec3 lightDirection_cameraspace;
 out vec3 vertexPosition_worldspace;
 out vec3 eyeDirection_cameraspace;
 
 void main()
 {
-	//DEBUG
-	vec3 lightPosition_worldspace = vec3(400, 400, 400);
-	
 	// UV of the vertex
 	UV = vertexUV;
 	
 	vertexPosition_worldspace = (modelMatrix * vec4(vertexPosition_modelspace, 1)).xyz;
 	
-	vec3 vertexPosition_cameraspace = (viewMatrix * modelMatrix * vec4(vertexPosition_modelspace, 1)).xyz;
+	vec3 vertexPosition_cameraspace = (viewMatrix * vec4(vertexPosition_worldspace, 1)).xyz;
 	// Vector from vertex to camera
 	eyeDirection_cameraspace = vec3(0, 0, 0) - vertexPosition_cameraspace;
 	
-	vec3 lightPosition_cameraspace = (viewMatrix * vec4(lightPosition_worldspace, 1)).xyz;
-	lightDirection_cameraspace = lightPosition_cameraspace + eyeDirection_cameraspace; // Vector from vertex to light
-	
 	normal_cameraspace = (normalMatrix * vec4(vertexNormal_modelspace, 0.0)).xyz;
 	
 	// Output position of the vertex
 	gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
-}
\ No newline at end of file
+}
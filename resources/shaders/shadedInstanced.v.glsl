@@ -0,0 +1,72 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// shaded.v.glsl for many objects at once, see ShadedObject::renderInstanced()
+
+#version 330 core
+
+// Input vertex data, different for all executions
+// These might be packed in the vertex buffer (see ObjectGeometry::chooseVertexFormat()), OpenGL unpacks them to floats.
+// Quantized positions are decoded by the model matrix.
+layout(location = 0) in vec3 vertexPosition_modelspace;
+layout(location = 1) in vec2 vertexUV;
+layout(location = 2) in vec3 vertexNormal_modelspace; // 10-bit, not quite unit length. The fragment shader normalizes it.
+
+// Different for each instance
+layout(location = 3) in mat4 instanceModelMatrix; // Takes locations 3 to 6
+layout(location = 7) in mat3 instanceNormalMatrix; // World space, takes locations 7 to 9
+
+// Filled once per frame, must match FrameData in RenderSnapshot.hpp
+layout(std140) uniform FrameData
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition; // World space
+	vec4 clusterDepthScale; // The light cluster slice of a depth is log(depth) * x + y
+	ivec4 clusterGridSize; // Light clusters on x, y and z
+	int lightCount;
+	ivec4 shadowLights; // The light using each shadow map slot, -1 for unused slots
+	mat4 shadowMatrices[24]; // SHADOW_MAP_MAX_LIGHTS * 6 cube faces, from world space to the shadow map atlas
+};
+
+// Output data
+out vec2 UV; // Proxy, sends UV coord to fragment shader
+out vec3 normal_cameraspace;
+out vec3 vertexPosition_worldspace;
+out vec3 eyeDirection_cameraspace;
+
+void main()
+{
+	// UV of the vertex
+	UV = vertexUV;
+	
+	vec4 vertexPosition_worldspace4 = instanceModelMatrix * vec4(vertexPosition_modelspace, 1);
+	vertexPosition_worldspace = vertexPosition_worldspace4.xyz;
+	
+	vec3 vertexPosition_cameraspace = (viewMatrix * vertexPosition_worldspace4).xyz;
+	// Vector from vertex to camera
+	eyeDirection_cameraspace = vec3(0, 0, 0) - vertexPosition_cameraspace;
+	
+	normal_cameraspace = (viewMatrix * vec4(instanceNormalMatrix * vertexNormal_modelspace, 0.0)).xyz;
+	
+	// Output position of the vertex
+	gl_Position = viewProjectionMatrix * vertexPosition_worldspace4;
+}
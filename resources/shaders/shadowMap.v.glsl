@@ -0,0 +1,32 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// Depth of shadow casters, for one face of a light's shadow map (see ShadowMapCache)
+
+#version 330 core
+
+// Might be quantized, the MVP decodes it (see ObjectGeometry::chooseVertexFormat())
+layout(location = 0) in vec3 vertexPosition_modelspace;
+
+uniform mat4 MVP; // With the face's view-projection
+
+void main()
+{
+	gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
+}
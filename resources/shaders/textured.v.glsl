@@ -22,6 +22,8 @@
 #version 330 core
 
 // Input vertex data, different for all executions
+// These might be packed in the vertex buffer (see ObjectGeometry::chooseVertexFormat()), OpenGL unpacks them to floats.
+// Quantized positions are decoded by the model matrix.
 layout(location = 0) in vec3 vertexPosition_modelspace;
 layout(location = 1) in vec2 vertexUV;
 
@@ -104,7 +104,7 @@ glm::mat4 Camera::getViewMatrix() const
 {
 	const PhysicsBody& physicsBody = getPhysicsBody();
 
-	glm::vec3 position = physicsBody.getPosition() * PHYSICS_PIXELS_PER_METER;
+	glm::vec3 position = physicsBody.getInterpolatedPosition() * PHYSICS_PIXELS_PER_METER; // Render between steps
 	glm::vec3 vec3Direction;
 
 	if(mDirection.w==1) // Is a position
@@ -0,0 +1,171 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <DeferredRenderer.hpp>
+#include <Graphics.hpp>
+#include <GLState.hpp>
+#include <Profiler.hpp>
+#include <Utils.hpp>
+#include <Definitions.hpp>
+
+// Give it engine shaders (see DEFERRED_*_SHADER_*), the geometry shader with its instanced version
+DeferredRenderer::DeferredRenderer(constShaderPointer geometryShader, constShaderPointer lightingShader)
+{
+	mGeometryShader = geometryShader;
+	mLightingShader = lightingShader;
+	mInverseProjectionUniform = Shader::getUniformID("inverseProjectionMatrix");
+
+	mSize = glm::ivec2(0, 0);
+	mFramebuffer = 0;
+	mAlbedoTexture = 0;
+	mNormalTexture = 0;
+	mDepthTexture = 0;
+	mTargetFramebuffer = 0;
+
+	// The G-buffer is always on the same units
+	GLuint lastProgram = GLState::getProgram();
+	GLState::useProgram(mLightingShader->getID());
+
+	GLState::setUniform(mLightingShader->findUniform("albedoSampler"), DEFERRED_UNIT_ALBEDO);
+	GLState::setUniform(mLightingShader->findUniform("normalSampler"), DEFERRED_UNIT_NORMAL);
+	GLState::setUniform(mLightingShader->findUniform("depthSampler"), DEFERRED_UNIT_DEPTH);
+
+	if(lastProgram != GL_STATE_UNKNOWN)
+		GLState::useProgram(lastProgram);
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+	deleteFramebuffer();
+}
+
+// PRIVATE
+
+bool DeferredRenderer::createFramebuffer(glm::ivec2 size)
+{
+	mSize = size;
+
+	glGenTextures(1, &mAlbedoTexture);
+	GLState::bindTexture(0, GL_TEXTURE_2D, mAlbedoTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	glGenTextures(1, &mNormalTexture);
+	GLState::bindTexture(0, GL_TEXTURE_2D, mNormalTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB10_A2, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, nullptr);
+
+	glGenTextures(1, &mDepthTexture);
+	GLState::bindTexture(0, GL_TEXTURE_2D, mDepthTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+
+	// Read with texelFetch(), one texel per pixel
+	GLuint textures[] = {mAlbedoTexture, mNormalTexture, mDepthTexture};
+	for(GLuint texture : textures)
+	{
+		GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+
+	GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &mFramebuffer);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mAlbedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, mNormalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, mDepthTexture, 0);
+
+	GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	glDrawBuffers(2, drawBuffers);
+
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		Utils::CRASH("G-buffer framebuffer is incomplete!");
+		return false;
+	}
+
+	return true;
+}
+
+void DeferredRenderer::deleteFramebuffer()
+{
+	if(mFramebuffer == 0)
+		return;
+
+	GLState::deleteFramebuffer(mFramebuffer);
+	GLState::deleteTexture(mAlbedoTexture);
+	GLState::deleteTexture(mNormalTexture);
+	GLState::deleteTexture(mDepthTexture);
+
+	mFramebuffer = 0;
+	mAlbedoTexture = 0;
+	mNormalTexture = 0;
+	mDepthTexture = 0;
+}
+
+// PUBLIC
+
+DeferredRenderer::constShaderPointer DeferredRenderer::getGeometryShader() const
+{
+	return mGeometryShader;
+}
+
+// Binds and clears the G-buffer, draw lit objects with the geometry shader after this.
+// Remembers the bound framebuffer to light into it (the window's, or the headless one).
+void DeferredRenderer::beginGeometryPass()
+{
+	mTargetFramebuffer = GLState::getFramebuffer(GL_DRAW_FRAMEBUFFER);
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glm::ivec2 size(viewport[2], viewport[3]);
+
+	if(size != mSize)
+	{
+		deleteFramebuffer();
+		createFramebuffer(size); // Binds it
+	} else
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+// Lights the G-buffer into the target framebuffer with FrameData's lights, and writes its depth there.
+// Pixels without lit objects keep what the target had (the background color).
+void DeferredRenderer::renderLightingPass(const glm::mat4& projectionMatrix, RenderState& renderState)
+{
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, mTargetFramebuffer);
+
+	glm::mat4 inverseProjectionMatrix = glm::inverse(projectionMatrix);
+
+	renderState.useProgram(mLightingShader->getID());
+	GLState::setUniform(mLightingShader->getUniform(mInverseProjectionUniform), inverseProjectionMatrix);
+
+	GLState::bindTexture(DEFERRED_UNIT_ALBEDO, GL_TEXTURE_2D, mAlbedoTexture);
+	GLState::bindTexture(DEFERRED_UNIT_NORMAL, GL_TEXTURE_2D, mNormalTexture);
+	GLState::bindTexture(DEFERRED_UNIT_DEPTH, GL_TEXTURE_2D, mDepthTexture);
+
+	// One triangle covering the screen, made from gl_VertexID
+	renderState.useVertexArray(Graphics::getDefaultVertexArray());
+
+	glDepthFunc(GL_ALWAYS); // The shader writes the G-buffer's depth
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glDepthFunc(GL_LESS); // Like Game::resetGraphics()
+	Profiler::countDrawCall();
+}
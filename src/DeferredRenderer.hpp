@@ -0,0 +1,67 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// Deferred shading. Lit objects (see Object::canRenderDeferred()) are drawn in a G-buffer first: albedo, normal
+// and depth textures the size of the viewport. Then one fullscreen pass lights every pixel with the lights of its
+// cluster (see LightClusterGrid) and writes the depth back, so what is drawn after (unlit objects, debug shapes) is hidden right.
+// Lighting costs pixels times lights, instead of objects times lights.
+// RenderQueue drives it when the rendering path is RENDERING_PATH_DEFERRED. Only needs OpenGL 3.3, so it works headless too.
+
+#ifndef DEFERRED_RENDERER_HPP
+#define DEFERRED_RENDERER_HPP
+
+#include <Shader.hpp>
+#include <RenderState.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <memory> // For std::shared_ptr
+
+class DeferredRenderer
+{
+public:
+	using constShaderPointer = std::shared_ptr<const Shader>;
+
+private:
+	constShaderPointer mGeometryShader; // Draws lit objects in the G-buffer instead of their own shader, has an instanced version
+	constShaderPointer mLightingShader;
+	int mInverseProjectionUniform; // Uniform ID
+
+	glm::ivec2 mSize; // Follows the viewport
+	GLuint mFramebuffer; // 0 until the first frame
+	GLuint mAlbedoTexture;
+	GLuint mNormalTexture; // Camera space, from 0 to 1
+	GLuint mDepthTexture;
+	GLuint mTargetFramebuffer; // What was bound before the geometry pass, the lighting pass draws there
+
+	bool createFramebuffer(glm::ivec2 size);
+	void deleteFramebuffer();
+
+public:
+	DeferredRenderer(constShaderPointer geometryShader, constShaderPointer lightingShader);
+	~DeferredRenderer();
+
+	constShaderPointer getGeometryShader() const;
+
+	void beginGeometryPass();
+	void renderLightingPass(const glm::mat4& projectionMatrix, RenderState& renderState);
+};
+
+#endif /* DEFERRED_RENDERER_HPP */
@@ -43,14 +43,140 @@
 #define DEFAULT_GAME_NAME "SDL3D Game"
 #define DEFAULT_GAME_WINDOW_WIDTH 800
 #define DEFAULT_GAME_WINDOW_HEIGHT 600
-#define DEFAULT_GAME_MAX_FRAMES_PER_SECOND 60
+#define DEFAULT_GAME_MAX_FRAMES_PER_SECOND 60 // 0 for no limit
+
+// Length of a simulation step, in miliseconds. 8 ms makes 125 steps per second.
+// The loop works in nanoseconds, so fractions (like 1000.0 / 60) work too.
+#define DEFAULT_GAME_STEP_LENGTH 8
+// The most steps we will do in one frame to catch up. Past this, the lost time is dropped (the game slows down)
+// instead of doing even more steps next frame and never catching up.
+#define DEFAULT_GAME_MAX_STEPS_PER_FRAME 5
+// Simulate the next frame on another thread while rendering, see Game::setPipelinedRendering()
+#define DEFAULT_GAME_PIPELINED_RENDERING false
+#define DEFAULT_GAME_RENDERING_PATH RENDERING_PATH_FORWARD
+
+// Jobs
+#define DEFAULT_JOB_SYSTEM_WORKER_COUNT -1 // Under 0 makes one worker per core, minus one for the main thread
+#define JOB_SYSTEM_SCRATCH_BLOCK_SIZE 262144 // In bytes, 256 KB per block
+
+// Profiler stages, see Profiler
+#define PROFILER_STAGE_EVENTS 0
+#define PROFILER_STAGE_PHYSICS_BODIES 1 // PhysicsBody::step() of all entities
+#define PROFILER_STAGE_PHYSICS_WORLD 2 // Box2D
+#define PROFILER_STAGE_SCRIPT 3 // Lua's gameStep()
+#define PROFILER_STAGE_RENDER 4
+#define PROFILER_STAGE_ERROR_CHECK 5
+#define PROFILER_STAGE_SWAP 6
+#define PROFILER_STAGE_SLEEP 7 // Frame limiting
+#define PROFILER_STAGE_FRAME 8 // From the start of a frame to the start of the next one
+// Counters are recorded like stages, but count things instead of microseconds
+#define PROFILER_COUNTER_DRAW_CALLS 9
+#define PROFILER_COUNTER_VISIBLE_OBJECTS 10 // Went through frustum culling
+#define PROFILER_COUNTER_CULLED_OBJECTS 11
+#define PROFILER_COUNTER_GL_CALLS 12 // State changes that went through GLState to OpenGL
+#define PROFILER_COUNTER_SKIPPED_GL_CALLS 13 // State changes GLState skipped, they changed nothing
+#define PROFILER_STAGE_COUNT 14
+
+#define PROFILER_HISTORY_LENGTH 1024 // In frames
+
+// OpenGL state cache, see GLState
+#define GL_STATE_UNKNOWN 0xFFFFFFFFu // A binding we don't know, the next bind always goes through
+#define GL_STATE_TEXTURE_UNITS 16 // Units after these aren't cached
+#define GL_STATE_UNIFORM_BUFFER_BINDINGS 8 // Same for uniform buffer binding points
+
+// Streaming buffer, see StreamBuffer
+#define STREAM_BUFFER_FRAMES 3 // Regions, the GPU reads the last ones while we write the next
+#define STREAM_BUFFER_FRAME_SIZE 1048576 // First size of a region in bytes, doubles when a frame needs more
+#define STREAM_BUFFER_WAIT_TIMEOUT 1000000 // In nanoseconds, for each try when waiting on the GPU
+
+// Render queue. Sort keys are 64 bits, from the most significant: pass, shader, texture, geometry, depth.
+// IDs that don't fit are wrapped; items still render right, they just batch a little less.
+#define RENDER_QUEUE_PASS_BITS 2
+#define RENDER_QUEUE_SHADER_BITS 14
+#define RENDER_QUEUE_TEXTURE_BITS 14
+#define RENDER_QUEUE_GEOMETRY_BITS 14
+#define RENDER_QUEUE_DEPTH_BITS 20
+#define RENDER_QUEUE_MAX_DEPTH 1000.0f // Anything further sorts as if it was here
+
+#define RENDER_PASS_DEFERRED_GEOMETRY 0 // Lit objects filling the G-buffer, only with the deferred rendering path
+#define RENDER_PASS_OPAQUE 1 // Sorted by state, then front to back
+
+#define DEFAULT_RENDER_QUEUE_FRUSTUM_CULLING true
+#define DEFAULT_RENDER_QUEUE_STATIC_BATCHING false // See StaticBatcher
+#define DEFAULT_RENDER_QUEUE_LOD_SELECTION true // Only matters for geometries with levels of detail
+
+// Static batching, see StaticBatcher
+#define STATIC_BATCH_CHUNK_SIZE 32.0f // In meters (world space is in pixels, see PHYSICS_PIXELS_PER_METER), static objects are merged with the others in the same cube this big
+#define STATIC_BATCH_MAX_VERTICES 65536 // Per batch, so most batches keep 16-bit indices
+
+// Rendering paths, see Game::setRenderingPath()
+#define RENDERING_PATH_FORWARD 0 // Every lit object loops over its lights
+#define RENDERING_PATH_DEFERRED 1 // Lit objects fill a G-buffer, then every pixel is lit once (see DeferredRenderer)
+
+// Deferred shading, engine shaders in SHADER_PATH_PREFIX
+#define DEFERRED_GEOMETRY_SHADER_VERTEX "deferredGeometry.v.glsl"
+#define DEFERRED_GEOMETRY_SHADER_INSTANCED_VERTEX "deferredGeometryInstanced.v.glsl"
+#define DEFERRED_GEOMETRY_SHADER_FRAGMENT "deferredGeometry.f.glsl"
+#define DEFERRED_LIGHTING_SHADER_VERTEX "deferredLighting.v.glsl"
+#define DEFERRED_LIGHTING_SHADER_FRAGMENT "deferredLighting.f.glsl"
+#define DEFERRED_UNIT_ALBEDO 4 // Texture units of the G-buffer in the lighting pass, after the lighting texture buffers
+#define DEFERRED_UNIT_NORMAL 5
+#define DEFERRED_UNIT_DEPTH 6
+
+// Frustum tests, see Frustum
+#define FRUSTUM_PLANE_COUNT 6 // Left, right, bottom, top, near, far
+#define FRUSTUM_OUTSIDE 0
+#define FRUSTUM_INTERSECTING 1
+#define FRUSTUM_INSIDE 2
+
+// Vertex attributes, they are also the attribute locations in shaders
+#define OBJECT_GEOMETRY_ATTRIBUTE_POSITION 0
+#define OBJECT_GEOMETRY_ATTRIBUTE_UV 1
+#define OBJECT_GEOMETRY_ATTRIBUTE_NORMAL 2
+#define OBJECT_GEOMETRY_ATTRIBUTE_COUNT 3
+
+// Vertex layouts, every ObjectGeometry has a vertex array object for each (and an instanced version of each)
+#define OBJECT_GEOMETRY_LAYOUT_POSITION 0 // Attribute 0
+#define OBJECT_GEOMETRY_LAYOUT_POSITION_UV 1 // Attributes 0 and 1
+#define OBJECT_GEOMETRY_LAYOUT_POSITION_UV_NORMAL 2 // Attributes 0 to 2
+#define OBJECT_GEOMETRY_LAYOUT_COUNT 3
+
+// GPU vertex formats, picked per geometry
+#define OBJECT_GEOMETRY_HALF_UV_LIMIT 2.0f // UVs further from 0 than this stay as floats, halfs get too imprecise
+#define OBJECT_GEOMETRY_SHORT_INDEX_MAX 65535 // Largest index that fits in 16-bit indices
+
+// Levels of detail, see MeshSimplifier and ResourceManager::setLODGeneration()
+#define DEFAULT_RESOURCE_MANAGER_LOD_GENERATION false
+#define OBJECT_GEOMETRY_LOD_MAX_LEVELS 4 // Simplified levels made for each geometry, on top of the original
+#define OBJECT_GEOMETRY_LOD_REDUCTION 0.5f // Each level aims for this much of the previous level's triangles
+#define OBJECT_GEOMETRY_LOD_MIN_TRIANGLES 32 // Geometries this small aren't worth simplifying
+#define OBJECT_GEOMETRY_LOD_MIN_GAIN 0.8f // A level keeping more than this much of the previous level's triangles is dropped (mostly seams)
+#define OBJECT_GEOMETRY_LOD_MIN_NORMAL_DOT 0.5f // Vertex normals further apart than this (cosine) are never merged, triangles never turn more
+#define OBJECT_GEOMETRY_LOD_MAX_ERROR 0.02f // Of the geometry's size (box diagonal), levels stop before moving the surface more
+#define OBJECT_GEOMETRY_LOD_MAX_SCREEN_ERROR 0.001f // A level is picked when its error covers less of the screen's height than this, about a pixel at 1080p
+
+// Instancing. Instanced shaders get these per instance, see shadedInstanced.v.glsl.
+#define RENDER_INSTANCE_ATTRIBUTE_MODEL_MATRIX 3 // mat4, takes locations 3 to 6
+#define RENDER_INSTANCE_ATTRIBUTE_NORMAL_MATRIX 7 // mat3, takes locations 7 to 9
+#define RENDER_INSTANCING_MIN_COUNT 2 // Smaller groups are drawn one by one
 
 // Files and paths
 #define LOG_FILE "Log.txt"
+#define PROFILER_CSV_FILE "Profile.csv" // Written when quitting
+
+#define HEADLESS_FRAME_DUMP_PREFIX "Frame" // --dump-frames writes Frame<n>.bmp
+
 #define RESOURCE_PATH_PREFIX "resources/" // Added before all resources
 #define SHADER_PATH_PREFIX "shaders/"
 #define SCRIPT_PATH_PREFIX "scripts/"
 
+// Replays (--record and --replay), see Replay
+#define REPLAY_MODE_OFF 0
+#define REPLAY_MODE_RECORDING 1
+#define REPLAY_MODE_REPLAYING 2
+#define REPLAY_FILE_MAGIC "S3DR" // 4 chars
+#define REPLAY_FILE_VERSION 1 // Change this when the file layout changes
+
 // Scripts
 #define MAIN_SCRIPT_NAME "main"
 #define MAIN_SCRIPT_FILE MAIN_SCRIPT_NAME ".lua" // Concatenates both literals
@@ -58,6 +184,52 @@
 #define MAIN_SCRIPT_FUNCTION_INIT "gameInit"
 #define MAIN_SCRIPT_FUNCTION_STEP "gameStep"
 
+// Uniforms every engine shader might use. They are the first uniform IDs (see Shader::getUniformID()),
+// so their locations are found once when linking and drawing only indexes an array.
+#define SHADER_UNIFORM_MVP 0
+#define SHADER_UNIFORM_MODEL_MATRIX 1
+#define SHADER_UNIFORM_VIEW_MATRIX 2
+#define SHADER_UNIFORM_PROJECTION_MATRIX 3
+#define SHADER_UNIFORM_NORMAL_MATRIX 4
+#define SHADER_UNIFORM_TEXTURE_SAMPLER 5
+#define SHADER_UNIFORM_COLOR 6
+#define SHADER_UNIFORM_COUNT 7
+
+// Per frame uniform block ("FrameData" in shaders, see FrameData in RenderSnapshot.hpp)
+#define FRAME_DATA_BLOCK_NAME "FrameData"
+#define FRAME_DATA_BINDING 0 // Uniform buffer binding point
+
+// Clustered lighting, see LightClusterGrid. Shaders read the grid's size from FrameData.
+#define LIGHT_CLUSTER_GRID_X 16 // Tiles across the screen
+#define LIGHT_CLUSTER_GRID_Y 9
+#define LIGHT_CLUSTER_GRID_Z 24 // Depth slices
+#define LIGHT_CLUSTER_MAX_LIGHTS 4096 // Lights that are on, extra lights are ignored (indices are 16-bit)
+// Crowded clusters past this lose lights. Bright lights easily reach every cluster, and drivers (even llvmpipe)
+// take texture buffers of millions of texels, but RenderQueue lowers it to GL_MAX_TEXTURE_BUFFER_SIZE if needed.
+#define LIGHT_CLUSTER_MAX_LIGHT_INDICES 1048576
+#define LIGHT_CLUSTER_MIN_TEXTURE_BUFFER_SIZE 65536 // What OpenGL 3.3 promises, used until the real limit is known
+#define LIGHT_CLUSTER_MIN_INTENSITY 0.004f // A light's range ends where it adds less than this (about 1/255) to a color
+
+// Texture units of the lighting texture buffers, objects use unit 0
+#define LIGHT_CLUSTER_UNIT_LIGHTS 1
+#define LIGHT_CLUSTER_UNIT_CLUSTERS 2
+#define LIGHT_CLUSTER_UNIT_LIGHT_INDICES 3
+#define LIGHT_CLUSTER_SAMPLER_LIGHTS "lightData" // Sampler names in shaders
+#define LIGHT_CLUSTER_SAMPLER_CLUSTERS "lightClusters"
+#define LIGHT_CLUSTER_SAMPLER_LIGHT_INDICES "lightIndices"
+
+// Shadow maps, see ShadowMapCache. Each shadow casting light has a cube of depth maps, in one atlas texture.
+#define SHADOW_MAP_MAX_LIGHTS 4 // Shadow casting lights after these have no shadows (FrameData::shadowLights holds 4)
+#define SHADOW_MAP_FACE_COUNT 6 // Cube faces: +x, -x, +y, -y, +z, -z
+#define SHADOW_MAP_SIZE 512 // Of a face, in texels
+#define SHADOW_MAP_NEAR_RATIO 0.001f // The near plane of the faces, times the light's range
+#define SHADOW_MAP_OFFSET_FACTOR 2.0f // Polygon offset of casters, so surfaces don't shadow themselves
+#define SHADOW_MAP_OFFSET_UNITS 4.0f
+#define SHADOW_MAP_UNIT 7 // Texture unit, after the G-buffer's
+#define SHADOW_MAP_SAMPLER "shadowMap" // sampler2DShadow in shaders
+#define SHADOW_MAP_SHADER_VERTEX "shadowMap.v.glsl" // Engine shaders in SHADER_PATH_PREFIX
+#define SHADOW_MAP_SHADER_FRAGMENT "shadowMap.f.glsl"
+
 // Texture types
 #define TEXTURE_BMP 0
 #define TEXTURE_DDS 1
@@ -20,6 +20,7 @@
 // This class will hold onto all entities, but it will NOT take ownership!
 
 #include <EntityManager.hpp>
+#include <ShadedObject.hpp>
 #include <Utils.hpp>
 #include <Definitions.hpp>
 
@@ -35,6 +36,7 @@ EntityManager::EntityManager(glm::vec2 gravity, float physicsTimePerStep)
 	mPhysicsTimePerStep = physicsTimePerStep;
 	mPhysicsVelocityIterations = 6;
 	mPhysicsPositionIterations = 2;
+	mJobSystem = nullptr;
 
 	mGameCamera.getPhysicsBody().addToWorld(&mPhysicsWorld); // Add it to the world
 }
@@ -49,6 +51,12 @@ Camera& EntityManager::getGameCamera()
 	return mGameCamera;
 }
 
+// Without a job system, everything runs on the calling thread
+void EntityManager::setJobSystem(JobSystem* jobSystem)
+{
+	mJobSystem = jobSystem;
+}
+
 // Returns false on failure
 bool EntityManager::addObject(objectPointer object) // Give it a shared pointer
 {
@@ -66,6 +74,44 @@ bool EntityManager::addObject(objectPointer object) // Give it a shared pointer
 	}
 }
 
+// Private
+// Makes one object per position, all sharing the same resources so they can be drawn instanced
+template<typename objectType>
+EntityManager::objectVector EntityManager::addObjectBatch(Object::constObjectGeometryPointer objectGeometry, Object::constShaderPointer shader,
+	TexturedObject::constTexturePointer texture, const std::vector<glm::vec3>& positions, int physicsType)
+{
+	objectVector batch;
+	batch.reserve(positions.size());
+	mObjects.reserve(mObjects.size() + positions.size());
+
+	for(const auto &position : positions)
+	{
+		objectPointer object(new objectType(objectGeometry, shader, texture, false, physicsType));
+		object->getPhysicsBody().setPosition(position);
+
+		// They are new, no need to check if they were already added
+		mObjects.push_back(object);
+		object->getPhysicsBody().addToWorld(&mPhysicsWorld);
+		batch.push_back(object);
+	}
+
+	return batch;
+}
+
+// Returns the new objects
+EntityManager::objectVector EntityManager::addTexturedObjectBatch(Object::constObjectGeometryPointer objectGeometry, Object::constShaderPointer shader,
+	TexturedObject::constTexturePointer texture, const std::vector<glm::vec3>& positions, int physicsType)
+{
+	return addObjectBatch<TexturedObject>(objectGeometry, shader, texture, positions, physicsType);
+}
+
+// Returns the new objects
+EntityManager::objectVector EntityManager::addShadedObjectBatch(Object::constObjectGeometryPointer objectGeometry, Object::constShaderPointer shader,
+	TexturedObject::constTexturePointer texture, const std::vector<glm::vec3>& positions, int physicsType)
+{
+	return addObjectBatch<ShadedObject>(objectGeometry, shader, texture, positions, physicsType);
+}
+
 // Removes an object from the manager. Does not delete them if they are still referenced somewhere, logically (shared pointers).
 // Returns the removed object, or an empty pointer on error.
 EntityManager::objectPointer EntityManager::removeObject(std::size_t index)
@@ -109,6 +155,28 @@ EntityManager::objectVector& EntityManager::getObjects()
 	return mObjects;
 }
 
+// Recalculates the physics shapes of these objects, in parallel if we have a job system
+// Returns false on failure
+bool EntityManager::calculateShapes(const objectVector& objects)
+{
+	if(!mJobSystem)
+	{
+		for(auto &object : objects)
+		{
+			if(!object->getPhysicsBody().calculateShapes())
+				return false;
+		}
+
+		return true;
+	}
+
+	std::vector<PhysicsBody*> bodies;
+	for(auto &object : objects)
+		bodies.push_back(&object->getPhysicsBody());
+
+	return PhysicsBody::calculateShapes(bodies, *mJobSystem);
+}
+
 
 bool EntityManager::addLight(lightPointer light) // Give it an actual object
 {
@@ -166,7 +234,7 @@ EntityManager::lightVector& EntityManager::getLights()
 	return mLights;
 }
 
-// Set the number of seconds elapsed per frame (will be under 0 most of the time)
+// Set the number of seconds simulated per step (will be under 1 most of the time)
 // Allows us to do slow motion!
 void EntityManager::setPhysicsTimePerStep(float time)
 {
@@ -178,11 +246,29 @@ float EntityManager::getPhysicsTimePerStep()
 	return mPhysicsTimePerStep;
 }
 
-// Steps all entities
-// Divider will divide the step time, useful for calling this function multiple times per frame
-void EntityManager::step(float divider)
+// Sets where rendering is between the previous step (0.0) and the last step (1.0)
+void EntityManager::setInterpolationFactor(float factor)
+{
+	for(auto &object : mObjects)
+		object->getPhysicsBody().setInterpolationFactor(factor);
+
+	for(auto &light : mLights)
+		light->getPhysicsBody().setInterpolationFactor(factor);
+
+	mGameCamera.getPhysicsBody().setInterpolationFactor(factor);
+}
+
+// Steps all entities by one fixed step
+void EntityManager::step()
+{
+	stepBodies();
+	stepPhysicsWorld();
+}
+
+// First half of step(), split so we can time them
+void EntityManager::stepBodies()
 {
-	float time = mPhysicsTimePerStep / divider;
+	float time = mPhysicsTimePerStep;
 
 	for(auto &object : mObjects)
 		object->getPhysicsBody().step(time);
@@ -191,14 +277,38 @@ void EntityManager::step(float divider)
 		light->getPhysicsBody().step(time);
 
 	mGameCamera.getPhysicsBody().step(time);
+}
+
+void EntityManager::stepPhysicsWorld()
+{
+	mPhysicsWorld.Step(mPhysicsTimePerStep, mPhysicsVelocityIterations, mPhysicsPositionIterations);
+}
 
-	mPhysicsWorld.Step(time, mPhysicsVelocityIterations, mPhysicsPositionIterations);
+// Renders all entities that can be rendered, sorted to change OpenGL state as little as possible
+void EntityManager::render(RenderQueue& renderQueue)
+{
+	fillRenderSnapshot(mRenderSnapshot, renderQueue.getMaxLightIndices());
+	mRenderSnapshot.render(renderQueue);
+	mRenderSnapshot.clear();
 }
 
-void EntityManager::render() // Renders all entities that can be rendered
+// Copies everything render() would draw, so another thread can draw it while we keep stepping
+// Also takes the debug shapes queued since the last snapshot
+// maxLightIndices is RenderQueue::getMaxLightIndices() of the queue that will draw it
+void EntityManager::fillRenderSnapshot(RenderSnapshot& renderSnapshot, std::size_t maxLightIndices)
 {
-	for(objectVector::iterator it = mObjects.begin(); it != mObjects.end(); ++it)
+	renderSnapshot.setCameraMatrices(mGameCamera.getViewMatrix(), mGameCamera.getProjectionMatrix());
+
+	for(auto &object : mObjects)
 	{
-		(*it)->render(mGameCamera);
+		RenderItem& renderItem = renderSnapshot.addRenderItem();
+		renderItem.object = object;
+		object->fillRenderItem(renderItem);
 	}
+
+	for(auto &light : mLights)
+		renderSnapshot.addLight(*light);
+	renderSnapshot.buildLightClusters(maxLightIndices, mJobSystem);
+
+	PhysicsBody::takeDeferredDebugShapes(renderSnapshot.getDebugShapes());
 }
\ No newline at end of file
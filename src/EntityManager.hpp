@@ -21,8 +21,12 @@
 #define ENTITY_MANAGER_HPP
 
 #include <Object.hpp>
+#include <TexturedObject.hpp>
 #include <Light.hpp>
 #include <Camera.hpp>
+#include <RenderSnapshot.hpp>
+#include <RenderQueue.hpp>
+#include <JobSystem.hpp>
 
 #include <Box2D.h>
 #include <glm/glm.hpp>
@@ -51,16 +55,30 @@ private:
 	int mPhysicsVelocityIterations;
 	int mPhysicsPositionIterations;
 
+	JobSystem* mJobSystem; // Can be null. Don't destroy this!
+
+	RenderSnapshot mRenderSnapshot; // Filled and drawn by render(), kept around for its memory
+
+	template<typename objectType>
+	objectVector addObjectBatch(Object::constObjectGeometryPointer objectGeometry, Object::constShaderPointer shader,
+		TexturedObject::constTexturePointer texture, const std::vector<glm::vec3>& positions, int physicsType);
+
 public:
 	EntityManager(glm::vec2 gravity, float physicsTimePerStep);
 	~EntityManager();
 
 	Camera& getGameCamera();
+	void setJobSystem(JobSystem* jobSystem);
 
 	bool addObject(objectPointer object);
+	objectVector addTexturedObjectBatch(Object::constObjectGeometryPointer objectGeometry, Object::constShaderPointer shader,
+		TexturedObject::constTexturePointer texture, const std::vector<glm::vec3>& positions, int physicsType);
+	objectVector addShadedObjectBatch(Object::constObjectGeometryPointer objectGeometry, Object::constShaderPointer shader,
+		TexturedObject::constTexturePointer texture, const std::vector<glm::vec3>& positions, int physicsType);
 	objectPointer removeObject(std::size_t index);
 	bool removeObject(objectPointer object);
 	objectVector& getObjects();
+	bool calculateShapes(const objectVector& objects);
 
 	bool addLight(lightPointer light);
 	lightPointer removeLight(std::size_t index);
@@ -70,8 +88,13 @@ public:
 	void setPhysicsTimePerStep(float time);
 	float getPhysicsTimePerStep();
 
-	void step(float divider);
-	void render();
+	void setInterpolationFactor(float factor);
+
+	void step();
+	void stepBodies();
+	void stepPhysicsWorld();
+	void render(RenderQueue& renderQueue);
+	void fillRenderSnapshot(RenderSnapshot& renderSnapshot, std::size_t maxLightIndices);
 };
 
 #endif /* ENTITY_MANAGER_HPP */
\ No newline at end of file
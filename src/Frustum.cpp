@@ -0,0 +1,177 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <Frustum.hpp>
+
+#include <algorithm> // For std::min
+
+// SSE is always there on x86-64, and most 32-bit compilers target it too
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// Everything is visible
+Frustum::Frustum()
+{
+	setMatrix(glm::mat4(1.0f)); // A cube from -1 to 1
+}
+
+Frustum::Frustum(const glm::mat4& viewProjectionMatrix)
+{
+	setMatrix(viewProjectionMatrix);
+}
+
+Frustum::~Frustum()
+{
+	// Do nothing
+}
+
+// Gribb and Hartmann's method: each plane is the last row of the matrix plus or minus another row.
+// Works with any matrix, so a model-view-projection matrix gives planes in model space.
+void Frustum::setMatrix(const glm::mat4& viewProjectionMatrix)
+{
+	const glm::mat4& m = viewProjectionMatrix; // m[column][row]
+
+	glm::vec4 rows[4];
+	for(int row = 0; row < 4; row++)
+		rows[row] = glm::vec4(m[0][row], m[1][row], m[2][row], m[3][row]);
+
+	mPlanes[0] = rows[3] + rows[0]; // Left
+	mPlanes[1] = rows[3] - rows[0]; // Right
+	mPlanes[2] = rows[3] + rows[1]; // Bottom
+	mPlanes[3] = rows[3] - rows[1]; // Top
+	mPlanes[4] = rows[3] + rows[2]; // Near
+	mPlanes[5] = rows[3] - rows[2]; // Far
+
+	// So distances are in world units, sphere radii need it
+	for(auto &plane : mPlanes)
+		plane /= glm::length(glm::vec3(plane));
+}
+
+const glm::vec4& Frustum::getPlane(int plane) const
+{
+	return mPlanes[plane];
+}
+
+// Sphere is the center in xyz and the radius in w
+// Returns FRUSTUM_OUTSIDE, FRUSTUM_INTERSECTING or FRUSTUM_INSIDE
+int Frustum::testSphere(const glm::vec4& sphere) const
+{
+	// The sphere is outside if it is behind any plane, and inside if it is in front of all of them
+	float minDistance = dot(glm::vec3(mPlanes[0]), glm::vec3(sphere)) + mPlanes[0].w;
+
+	for(int i = 1; i < FRUSTUM_PLANE_COUNT; i++)
+		minDistance = std::min(minDistance, dot(glm::vec3(mPlanes[i]), glm::vec3(sphere)) + mPlanes[i].w);
+
+	if(minDistance < -sphere.w)
+		return FRUSTUM_OUTSIDE;
+	else if(minDistance >= sphere.w)
+		return FRUSTUM_INSIDE;
+
+	return FRUSTUM_INTERSECTING;
+}
+
+// testSphere() for many spheres at once, results must have room for count values.
+// With SSE, spheres are tested 4 at a time.
+void Frustum::testSpheres(const glm::vec4* spheres, std::size_t count, unsigned char* results) const
+{
+	std::size_t first = 0;
+
+#ifdef FRUSTUM_USE_SSE
+	__m128 planeX[FRUSTUM_PLANE_COUNT];
+	__m128 planeY[FRUSTUM_PLANE_COUNT];
+	__m128 planeZ[FRUSTUM_PLANE_COUNT];
+	__m128 planeW[FRUSTUM_PLANE_COUNT];
+
+	for(int i = 0; i < FRUSTUM_PLANE_COUNT; i++)
+	{
+		planeX[i] = _mm_set1_ps(mPlanes[i].x);
+		planeY[i] = _mm_set1_ps(mPlanes[i].y);
+		planeZ[i] = _mm_set1_ps(mPlanes[i].z);
+		planeW[i] = _mm_set1_ps(mPlanes[i].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for(; first + 4 <= count; first += 4)
+	{
+		// Load 4 spheres and turn them around, so each register holds one component of all 4
+		const float* sphereData = &spheres[first].x;
+		__m128 x = _mm_loadu_ps(sphereData);
+		__m128 y = _mm_loadu_ps(sphereData + 4);
+		__m128 z = _mm_loadu_ps(sphereData + 8);
+		__m128 radius = _mm_loadu_ps(sphereData + 12);
+		_MM_TRANSPOSE4_PS(x, y, z, radius);
+
+		__m128 minDistance = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(planeX[0], x), _mm_mul_ps(planeY[0], y)),
+			_mm_add_ps(_mm_mul_ps(planeZ[0], z), planeW[0]));
+
+		for(int i = 1; i < FRUSTUM_PLANE_COUNT; i++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[i], x), _mm_mul_ps(planeY[i], y)),
+				_mm_add_ps(_mm_mul_ps(planeZ[i], z), planeW[i]));
+
+			minDistance = _mm_min_ps(minDistance, distance);
+		}
+
+		int outside = _mm_movemask_ps(_mm_cmplt_ps(minDistance, _mm_sub_ps(zero, radius)));
+		int inside = _mm_movemask_ps(_mm_cmpge_ps(minDistance, radius));
+
+		for(int i = 0; i < 4; i++)
+		{
+			if(outside & (1 << i))
+				results[first + i] = FRUSTUM_OUTSIDE;
+			else if(inside & (1 << i))
+				results[first + i] = FRUSTUM_INSIDE;
+			else
+				results[first + i] = FRUSTUM_INTERSECTING;
+		}
+	}
+#endif
+
+	// The rest (or everything without SSE)
+	for(; first < count; first++)
+		results[first] = static_cast<unsigned char>(testSphere(spheres[first]));
+}
+
+// Box is in model space. Only false if the box is completely behind a plane;
+// boxes near corners of the frustum can still pass.
+bool Frustum::isBoxVisible(const glm::mat4& modelMatrix, const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	for(const auto &worldPlane : mPlanes)
+	{
+		// The plane in model space, so the box doesn't need to be transformed
+		glm::vec4 plane(glm::dot(worldPlane, modelMatrix[0]), glm::dot(worldPlane, modelMatrix[1]),
+			glm::dot(worldPlane, modelMatrix[2]), glm::dot(worldPlane, modelMatrix[3]));
+
+		// The corner furthest along the plane's normal
+		glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x,
+			plane.y >= 0.0f ? boxMax.y : boxMin.y,
+			plane.z >= 0.0f ? boxMax.z : boxMin.z);
+
+		if(glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
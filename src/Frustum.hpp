@@ -0,0 +1,52 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// The six planes of a camera's view volume, taken from its view-projection matrix.
+// Tests bounding volumes against them so we don't draw what can't be seen.
+// Planes point inside; a point is in front of a plane if dot(plane.xyz, point) + plane.w >= 0.
+
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <Definitions.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef> // For std::size_t
+
+class Frustum
+{
+private:
+	glm::vec4 mPlanes[FRUSTUM_PLANE_COUNT]; // Normalized
+
+public:
+	Frustum();
+	Frustum(const glm::mat4& viewProjectionMatrix);
+	~Frustum();
+
+	void setMatrix(const glm::mat4& viewProjectionMatrix);
+	const glm::vec4& getPlane(int plane) const;
+
+	int testSphere(const glm::vec4& sphere) const;
+	void testSpheres(const glm::vec4* spheres, std::size_t count, unsigned char* results) const;
+	bool isBoxVisible(const glm::mat4& modelMatrix, const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+};
+
+#endif /* FRUSTUM_HPP */
@@ -0,0 +1,462 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <GLState.hpp>
+
+#include <algorithm> // For std::fill
+#include <cstring> // For std::memcmp() and std::memcpy()
+
+// Zeroes are what a fresh context has bound and enabled
+GLuint GLState::mProgram = 0;
+GLState::UniformValues* GLState::mProgramUniforms = nullptr;
+std::unordered_map<GLuint, GLState::UniformValues> GLState::mUniformValues;
+
+GLuint GLState::mActiveTextureUnit = 0;
+GLuint GLState::mTextures[GL_STATE_TEXTURE_UNITS][3] = {};
+GLuint GLState::mBuffers[8] = {};
+GLuint GLState::mUniformBufferBindings[GL_STATE_UNIFORM_BUFFER_BINDINGS] = {};
+GLuint GLState::mVertexArray = 0;
+GLuint GLState::mDrawFramebuffer = 0;
+GLuint GLState::mReadFramebuffer = 0;
+signed char GLState::mCapabilities[5] = {};
+
+std::size_t GLState::mCallCount = 0;
+std::size_t GLState::mSkippedCallCount = 0;
+
+// -1 if we don't cache the target
+int GLState::getTextureTargetIndex(GLenum target)
+{
+	switch(target)
+	{
+	case GL_TEXTURE_2D:
+		return 0;
+	case GL_TEXTURE_BUFFER:
+		return 1;
+	case GL_TEXTURE_CUBE_MAP:
+		return 2;
+	default:
+		return -1;
+	}
+}
+
+int GLState::getBufferTargetIndex(GLenum target)
+{
+	switch(target)
+	{
+	case GL_ARRAY_BUFFER:
+		return 0;
+	case GL_ELEMENT_ARRAY_BUFFER:
+		return 1;
+	case GL_UNIFORM_BUFFER:
+		return 2;
+	case GL_TEXTURE_BUFFER:
+		return 3;
+	case GL_COPY_READ_BUFFER:
+		return 4;
+	case GL_COPY_WRITE_BUFFER:
+		return 5;
+	case GL_PIXEL_PACK_BUFFER:
+		return 6;
+	case GL_PIXEL_UNPACK_BUFFER:
+		return 7;
+	default:
+		return -1;
+	}
+}
+
+int GLState::getCapabilityIndex(GLenum capability)
+{
+	switch(capability)
+	{
+	case GL_DEPTH_TEST:
+		return 0;
+	case GL_CULL_FACE:
+		return 1;
+	case GL_BLEND:
+		return 2;
+	case GL_SCISSOR_TEST:
+		return 3;
+	case GL_POLYGON_OFFSET_FILL:
+		return 4;
+	default:
+		return -1;
+	}
+}
+
+void GLState::setActiveTextureUnit(GLuint unit)
+{
+	if(unit == mActiveTextureUnit)
+	{
+		mSkippedCallCount++;
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+	mActiveTextureUnit = unit;
+	mCallCount++;
+}
+
+// Returns true if the uniform has to be uploaded, remembers the new value
+bool GLState::setUniformValue(GLint location, const void* data, std::size_t size)
+{
+	if(location < 0) // OpenGL ignores these anyway
+	{
+		mSkippedCallCount++;
+		return false;
+	}
+
+	if(!mProgramUniforms) // Don't know which program is in use
+	{
+		mCallCount++;
+		return true;
+	}
+
+	UniformValues& values = *mProgramUniforms;
+	std::size_t index = static_cast<std::size_t>(location);
+
+	if(index >= values.size())
+	{
+		UniformValue unknown;
+		unknown.size = 0;
+		values.resize(index + 1, unknown);
+	}
+
+	UniformValue& value = values[index];
+
+	if(value.size == size && std::memcmp(value.data, data, size) == 0)
+	{
+		mSkippedCallCount++;
+		return false;
+	}
+
+	value.size = static_cast<unsigned char>(size);
+	std::memcpy(value.data, data, size);
+	mCallCount++;
+	return true;
+}
+
+// Forgets everything, call after something else changed OpenGL's state (or on a new context)
+void GLState::reset()
+{
+	mProgram = GL_STATE_UNKNOWN;
+	mProgramUniforms = nullptr;
+	mUniformValues.clear();
+
+	mActiveTextureUnit = GL_STATE_UNKNOWN;
+	std::fill(&mTextures[0][0], &mTextures[0][0] + GL_STATE_TEXTURE_UNITS * 3, GL_STATE_UNKNOWN);
+	std::fill(mBuffers, mBuffers + 8, GL_STATE_UNKNOWN);
+	std::fill(mUniformBufferBindings, mUniformBufferBindings + GL_STATE_UNIFORM_BUFFER_BINDINGS, GL_STATE_UNKNOWN);
+	mVertexArray = GL_STATE_UNKNOWN;
+	mDrawFramebuffer = GL_STATE_UNKNOWN;
+	mReadFramebuffer = GL_STATE_UNKNOWN;
+	std::fill(mCapabilities, mCapabilities + 5, -1);
+}
+
+// Returns true if the program changed, so the caller can set uniforms that stay the same for the whole program
+bool GLState::useProgram(GLuint program)
+{
+	if(program == mProgram)
+	{
+		mSkippedCallCount++;
+		return false;
+	}
+
+	glUseProgram(program);
+	mProgram = program;
+	mProgramUniforms = &mUniformValues[program]; // Stays valid, unordered_map never moves its values
+	mCallCount++;
+	return true;
+}
+
+// Returns GL_STATE_UNKNOWN if we don't know
+GLuint GLState::getProgram()
+{
+	return mProgram;
+}
+
+void GLState::deleteProgram(GLuint program)
+{
+	if(program == mProgram) // Stays in use until something else is, but its name can be reused
+	{
+		mProgram = GL_STATE_UNKNOWN;
+		mProgramUniforms = nullptr;
+	}
+
+	mUniformValues.erase(program);
+	glDeleteProgram(program);
+}
+
+// Uniforms of the program in use. Programs keep their uniform values, so switching back and forth doesn't
+// make them upload again.
+void GLState::setUniform(GLint location, int value)
+{
+	if(setUniformValue(location, &value, sizeof(value)))
+		glUniform1i(location, value);
+}
+
+void GLState::setUniform(GLint location, const glm::vec3& value)
+{
+	if(setUniformValue(location, &value[0], sizeof(value)))
+		glUniform3fv(location, 1, &value[0]);
+}
+
+void GLState::setUniform(GLint location, const glm::mat4& value)
+{
+	if(setUniformValue(location, &value[0][0], sizeof(value)))
+		glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+// Only changes the active texture unit if it has to bind something
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+	int targetIndex = getTextureTargetIndex(target);
+
+	if(unit < GL_STATE_TEXTURE_UNITS && targetIndex >= 0)
+	{
+		GLuint& bound = mTextures[unit][targetIndex];
+
+		if(texture == bound)
+		{
+			mSkippedCallCount++;
+			return;
+		}
+
+		bound = texture;
+	}
+
+	setActiveTextureUnit(unit);
+	glBindTexture(target, texture);
+	mCallCount++;
+}
+
+// Deleting a bound texture binds 0 in its place
+void GLState::deleteTexture(GLuint texture)
+{
+	for(GLuint* bound = &mTextures[0][0]; bound != &mTextures[0][0] + GL_STATE_TEXTURE_UNITS * 3; bound++)
+	{
+		if(*bound == texture)
+			*bound = 0;
+	}
+
+	glDeleteTextures(1, &texture);
+}
+
+// The element array binding belongs to the vertex array, binding one there changes the bound vertex array
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+	int targetIndex = getBufferTargetIndex(target);
+
+	if(targetIndex >= 0)
+	{
+		if(buffer == mBuffers[targetIndex])
+		{
+			mSkippedCallCount++;
+			return;
+		}
+
+		mBuffers[targetIndex] = buffer;
+	}
+
+	glBindBuffer(target, buffer);
+	mCallCount++;
+}
+
+// Binds the buffer to the generic binding point too, like OpenGL does
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	if(target == GL_UNIFORM_BUFFER && index < GL_STATE_UNIFORM_BUFFER_BINDINGS)
+	{
+		if(buffer == mUniformBufferBindings[index])
+		{
+			mSkippedCallCount++;
+			return;
+		}
+
+		mUniformBufferBindings[index] = buffer;
+	}
+
+	int targetIndex = getBufferTargetIndex(target);
+	if(targetIndex >= 0)
+		mBuffers[targetIndex] = buffer;
+
+	glBindBufferBase(target, index, buffer);
+	mCallCount++;
+}
+
+// Ranges aren't cached, they usually move every frame (see StreamBuffer)
+void GLState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	if(target == GL_UNIFORM_BUFFER && index < GL_STATE_UNIFORM_BUFFER_BINDINGS)
+		mUniformBufferBindings[index] = GL_STATE_UNKNOWN; // A whole buffer bound after isn't the same binding
+
+	int targetIndex = getBufferTargetIndex(target);
+	if(targetIndex >= 0)
+		mBuffers[targetIndex] = buffer;
+
+	glBindBufferRange(target, index, buffer, offset, size);
+	mCallCount++;
+}
+
+void GLState::deleteBuffer(GLuint buffer)
+{
+	for(GLuint& bound : mBuffers)
+	{
+		if(bound == buffer)
+			bound = 0;
+	}
+
+	for(GLuint& bound : mUniformBufferBindings)
+	{
+		if(bound == buffer)
+			bound = 0;
+	}
+
+	glDeleteBuffers(1, &buffer);
+}
+
+void GLState::bindVertexArray(GLuint vertexArray)
+{
+	if(vertexArray == mVertexArray)
+	{
+		mSkippedCallCount++;
+		return;
+	}
+
+	glBindVertexArray(vertexArray);
+	mVertexArray = vertexArray;
+	mBuffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = GL_STATE_UNKNOWN; // Whatever the new one had
+	mCallCount++;
+}
+
+void GLState::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+{
+	for(GLsizei i = 0; i < count; i++)
+	{
+		if(vertexArrays[i] == mVertexArray) // Reverts to 0
+		{
+			mVertexArray = 0;
+			mBuffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = GL_STATE_UNKNOWN;
+		}
+	}
+
+	glDeleteVertexArrays(count, vertexArrays);
+}
+
+// GL_FRAMEBUFFER binds both the draw and the read framebuffer
+void GLState::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	bool draw = target != GL_READ_FRAMEBUFFER;
+	bool read = target != GL_DRAW_FRAMEBUFFER;
+
+	if((!draw || framebuffer == mDrawFramebuffer) && (!read || framebuffer == mReadFramebuffer))
+	{
+		mSkippedCallCount++;
+		return;
+	}
+
+	glBindFramebuffer(target, framebuffer);
+
+	if(draw)
+		mDrawFramebuffer = framebuffer;
+	if(read)
+		mReadFramebuffer = framebuffer;
+
+	mCallCount++;
+}
+
+// Asks OpenGL if we don't know. GL_FRAMEBUFFER means the draw framebuffer.
+GLuint GLState::getFramebuffer(GLenum target)
+{
+	bool read = target == GL_READ_FRAMEBUFFER;
+	GLuint& framebuffer = read ? mReadFramebuffer : mDrawFramebuffer;
+
+	if(framebuffer == GL_STATE_UNKNOWN)
+	{
+		GLint bound;
+		glGetIntegerv(read ? GL_READ_FRAMEBUFFER_BINDING : GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+		framebuffer = static_cast<GLuint>(bound);
+	}
+
+	return framebuffer;
+}
+
+void GLState::deleteFramebuffer(GLuint framebuffer)
+{
+	if(framebuffer == mDrawFramebuffer)
+		mDrawFramebuffer = 0;
+	if(framebuffer == mReadFramebuffer)
+		mReadFramebuffer = 0;
+
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+void GLState::setCapability(GLenum capability, bool enabled)
+{
+	int index = getCapabilityIndex(capability);
+	signed char value = enabled ? 1 : 0;
+
+	if(index >= 0)
+	{
+		if(mCapabilities[index] == value)
+		{
+			mSkippedCallCount++;
+			return;
+		}
+
+		mCapabilities[index] = value;
+	}
+
+	if(enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+
+	mCallCount++;
+}
+
+// Asks OpenGL if we don't know
+bool GLState::isCapabilityEnabled(GLenum capability)
+{
+	int index = getCapabilityIndex(capability);
+
+	if(index < 0)
+		return glIsEnabled(capability) == GL_TRUE;
+
+	if(mCapabilities[index] < 0)
+		mCapabilities[index] = glIsEnabled(capability) == GL_TRUE ? 1 : 0;
+
+	return mCapabilities[index] == 1;
+}
+
+// Calls that went to OpenGL since the last take
+std::size_t GLState::takeCallCount()
+{
+	std::size_t count = mCallCount;
+	mCallCount = 0;
+	return count;
+}
+
+// Calls we skipped since the last take
+std::size_t GLState::takeSkippedCallCount()
+{
+	std::size_t count = mSkippedCallCount;
+	mSkippedCallCount = 0;
+	return count;
+}
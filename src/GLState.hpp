@@ -0,0 +1,106 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Shadows the OpenGL state the engine changes (program, buffers, textures, vertex arrays, framebuffers, a few
+// capabilities and uniform values per program) and skips calls that wouldn't change anything.
+// Every engine GL call that binds or enables something should go through here, or the cache lies.
+// If something else touched OpenGL, call reset() and the next calls go through again.
+// Starts out as the state of a fresh context. OpenGL thread only.
+
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <Definitions.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <cstddef> // For std::size_t
+
+class GLState
+{
+private:
+	struct UniformValue
+	{
+		unsigned char size; // 0 when unknown
+		unsigned char data[sizeof(glm::mat4)];
+	};
+
+	typedef std::vector<UniformValue> UniformValues; // Indexed by location
+
+	static GLuint mProgram;
+	static UniformValues* mProgramUniforms; // Of mProgram, nullptr when unknown
+	static std::unordered_map<GLuint, UniformValues> mUniformValues;
+
+	static GLuint mActiveTextureUnit;
+	static GLuint mTextures[GL_STATE_TEXTURE_UNITS][3]; // 2D, buffer and cube map textures per unit
+	static GLuint mBuffers[8]; // See getBufferTargetIndex()
+	static GLuint mUniformBufferBindings[GL_STATE_UNIFORM_BUFFER_BINDINGS];
+	static GLuint mVertexArray;
+	static GLuint mDrawFramebuffer;
+	static GLuint mReadFramebuffer;
+	static signed char mCapabilities[5]; // 1 enabled, 0 disabled, -1 unknown. See getCapabilityIndex()
+
+	static std::size_t mCallCount;
+	static std::size_t mSkippedCallCount;
+
+	static int getTextureTargetIndex(GLenum target);
+	static int getBufferTargetIndex(GLenum target);
+	static int getCapabilityIndex(GLenum capability);
+
+	static void setActiveTextureUnit(GLuint unit);
+	static bool setUniformValue(GLint location, const void* data, std::size_t size);
+
+public:
+	static void reset();
+
+	static bool useProgram(GLuint program);
+	static GLuint getProgram();
+	static void deleteProgram(GLuint program);
+
+	static void setUniform(GLint location, int value);
+	static void setUniform(GLint location, const glm::vec3& value);
+	static void setUniform(GLint location, const glm::mat4& value);
+
+	static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+	static void deleteTexture(GLuint texture);
+
+	static void bindBuffer(GLenum target, GLuint buffer);
+	static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	static void deleteBuffer(GLuint buffer);
+
+	static void bindVertexArray(GLuint vertexArray);
+	static void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+
+	static void bindFramebuffer(GLenum target, GLuint framebuffer);
+	static GLuint getFramebuffer(GLenum target);
+	static void deleteFramebuffer(GLuint framebuffer);
+
+	static void setCapability(GLenum capability, bool enabled);
+	static bool isCapabilityEnabled(GLenum capability);
+
+	static std::size_t takeCallCount();
+	static std::size_t takeSkippedCallCount();
+};
+
+#endif /* GL_STATE_HPP */
@@ -18,16 +18,21 @@
 ///////////////////////////////////////////////////////////////////////
 
 // A simple general auto-binding OpenGL buffer wrapper
-// I am pretty sure constantly rebinding a buffer isn't too bad
+// Constantly rebinding a buffer is fine, GLState skips binds that change nothing
 // Useful for using as an interface for other classes (retun this instead of writing an interface)
 
 // Every function that calls OpenGL stuff must call bind() first
+// When graphics are disabled, the data is kept in a vector instead and no OpenGL is called at all
 
 #ifndef GPU_BUFFER_HPP
 #define GPU_BUFFER_HPP
 
 #include <glad/glad.h> // glad.h is compatible with C++
+#include <Graphics.hpp>
+#include <GLState.hpp>
+
 #include <vector>
+#include <cstring> // For memcpy
 #include <cstddef> // For std::size_t
 
 template<typename bufferDataType>
@@ -37,6 +42,10 @@ private:
 	GLuint mID; // OpenGL handle
 	bool mAutoBind;
 	GLenum mTarget; // The target to bind to
+	std::size_t mSize; // In bytes, kept here so asking for it doesn't go through OpenGL
+
+	bool mOnGPU; // False when graphics were disabled when creating this
+	std::vector<bufferDataType> mCPUData; // Only used when not on the GPU
 
 public:
 	// Even if auto binding is not on, calling bind() will still bind to the default target
@@ -44,13 +53,18 @@ public:
 	{
 		setTarget(target);
 		mAutoBind = autoBind;
+		mOnGPU = Graphics::isEnabled();
+		mID = 0;
+		mSize = 0;
 
-		glGenBuffers(1, &mID); // 1 for 1 buffer
+		if(mOnGPU)
+			glGenBuffers(1, &mID); // 1 for 1 buffer
 	}
 
 	~GPUBuffer()
 	{
-		glDeleteBuffers(1, &mID);
+		if(mOnGPU)
+			GLState::deleteBuffer(mID);
 	}
 
 	// Copy constructor, makes a new OpenGL buffer. Unbinds copy buffers!
@@ -61,6 +75,15 @@ public:
 
 		mAutoBind = other.mAutoBind;
 		setTarget(other.mTarget);
+		mOnGPU = other.mOnGPU;
+		mID = 0;
+		mSize = other.mSize;
+
+		if(!mOnGPU)
+		{
+			mCPUData = other.mCPUData;
+			return;
+		}
 		
 		glGenBuffers(1, &mID);
 
@@ -86,7 +109,7 @@ public:
 		}
 	}
 
-	const GLuint getID()
+	GLuint getID() const
 	{
 		return mID;
 	}
@@ -98,8 +121,8 @@ public:
 
 	void bind(GLenum target) const
 	{
-		if(mAutoBind)
-			glBindBuffer(target, mID);
+		if(mAutoBind && mOnGPU)
+			GLState::bindBuffer(target, mID);
 	}
 
 	void bind() const // Bind to the stored target
@@ -109,12 +132,7 @@ public:
 
 	std::size_t getSize() const // Returns the buffer's size, in bytes
 	{
-		GLint GLintBufferSize;
-
-		bind();
-		glGetBufferParameteriv(mTarget, GL_BUFFER_SIZE, &GLintBufferSize);
-
-		return GLintBufferSize; // Implicit conversion to std::size_t
+		return mSize;
 	}
 
 	int getLength() const // Get the amount of elements in the buffer
@@ -126,6 +144,14 @@ public:
 
 	void setMutableData(const std::vector<bufferDataType>& data, GLenum usage)
 	{
+		mSize = sizeof(bufferDataType) * data.size();
+
+		if(!mOnGPU)
+		{
+			mCPUData = data;
+			return;
+		}
+
 		bind();
 
 		// Vector.size() returns the amount of elements
@@ -141,6 +167,14 @@ public:
 
 	void setImmutableData(const std::vector<bufferDataType>& data, GLenum immutableFlags) // immutableFlags being a bitwise operation
 	{
+		mSize = sizeof(bufferDataType) * data.size();
+
+		if(!mOnGPU)
+		{
+			mCPUData = data;
+			return;
+		}
+
 		bind();
 		glBufferStorage(mTarget, sizeof(bufferDataType) * data.size(), data.data(), immutableFlags);
 	}
@@ -154,8 +188,15 @@ public:
 
 	std::vector<bufferDataType> read(GLintptr offset, GLsizeiptr size) const
 	{
-		bind();
 		std::vector<bufferDataType> data(size / sizeof(bufferDataType)); // Allocate
+
+		if(!mOnGPU)
+		{
+			std::memcpy(static_cast<void*>(data.data()), reinterpret_cast<const char*>(mCPUData.data()) + offset, size);
+			return data;
+		}
+
+		bind();
 		glGetBufferSubData(mTarget, offset, size, data.data());
 
 		return data;
@@ -171,6 +212,12 @@ public:
 	// Will replace the bytes starting at offset
 	void modify(GLintptr offset, const std::vector<bufferDataType>& data)
 	{
+		if(!mOnGPU)
+		{
+			std::memcpy(reinterpret_cast<char*>(mCPUData.data()) + offset, data.data(), sizeof(bufferDataType) * data.size());
+			return;
+		}
+
 		bind();
 		glBufferSubData(mTarget, offset, sizeof(bufferDataType) * data.size(), data.data());
 	}
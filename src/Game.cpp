@@ -27,7 +27,10 @@
 
 #include <Definitions.hpp> 
 #include <Utils.hpp>
-#include <SimpleTimer.hpp> // For game loop
+#include <HighResolutionClock.hpp> // For game loop
+#include <Graphics.hpp>
+#include <GLState.hpp>
+#include <Sound.hpp>
 
 #include <LuaRef.h> // For getting references from scripts
 #include <SDL_mixer.h>
@@ -45,30 +48,46 @@
 // http://glew.sourceforge.net/basic.html
 
 Game::Game()
-	: mEntityManager(glm::vec2(0.0f),  1 / static_cast<float>(DEFAULT_GAME_MAX_FRAMES_PER_SECOND))
+	: mJobSystem(DEFAULT_JOB_SYSTEM_WORKER_COUNT),
+	mEntityManager(glm::vec2(0.0f), DEFAULT_GAME_STEP_LENGTH / 1000.0f) // One step simulates its length, in seconds
 {
 	mName = DEFAULT_GAME_NAME; // Copy string
+	mMainScriptFile = MAIN_SCRIPT_FILE;
 
 	mSize.x = DEFAULT_GAME_WINDOW_WIDTH;
 	mSize.y = DEFAULT_GAME_WINDOW_HEIGHT;
 
 	// Limits the frames per second
-	// Time in miliseconds
-	mMaxFramesPerSecond = DEFAULT_GAME_MAX_FRAMES_PER_SECOND; // Truncation
+	mMaxFramesPerSecond = DEFAULT_GAME_MAX_FRAMES_PER_SECOND;
+	mFrameLimit = 0;
+	mFrameCount = 0;
 	mLastFrameTime = 0;
+	mNextFrameDeadline = 0;
 
-	// This is the length of a step, used for movement and everything, in ms. 8 ms makes 120 steps per second.
-	// If the time of one frame is smaller than this value (ex: faster screens in the future), the game will slow down.
-	mStepLength = 8;
+	// This is the length of a step, used for movement and everything, in ns.
+	// Steps are fixed: leftover time is kept for the next frame and used to interpolate what we render.
+	mStepLength = static_cast<std::int64_t>(DEFAULT_GAME_STEP_LENGTH * 1000000);
+	mAccumulatedStepTime = 0;
+	mMaxStepsPerFrame = DEFAULT_GAME_MAX_STEPS_PER_FRAME;
 
 	mGraphicsBackgroundColor = glm::vec3(0.0f, 0.0f, 1.0f);
 
 	mInitialized = false;
 	mQuitting = false;
 
+	mPipelinedRendering = DEFAULT_GAME_PIPELINED_RENDERING;
+	mFrontRenderSnapshot = 0;
+	mRenderingPath = DEFAULT_GAME_RENDERING_PATH;
+
 	// These will be set later
 	mMainWindow = nullptr;
 	mMainContext = nullptr;
+	mHeadless = false;
+	mSimulationOnly = false;
+	mSimulationSpeed = 0.0f;
+
+	mResourceManager.setJobSystem(&mJobSystem);
+	mEntityManager.setJobSystem(&mJobSystem);
 }
 
 Game::~Game() // Deconstructor
@@ -162,23 +181,50 @@ bool Game::checkCompability()
 
 void Game::setupGraphics() // VAO and OpenGL options
 {
+	GLState::reset(); // New context, and the window or headless context might have bound things already
+
 	// Make sure the OpenGL context extends over the whole screen
 	glViewport(0, 0, mSize.x, mSize.y);
 
-	GLuint vertexArrayID; // VAO - vertex array object
+	// VAO - vertex array object. Used for everything that isn't an object geometry (ex: debug shapes).
+	GLuint vertexArrayID;
 	glGenVertexArrays(1, &vertexArrayID);
-	glBindVertexArray(vertexArrayID);
+	GLState::bindVertexArray(vertexArrayID);
+	Graphics::setDefaultVertexArray(vertexArrayID);
+
+	Graphics::setStreamBuffer(&mStreamBuffer);
 }
 
 void Game::initMainLoop() // Initialize a few things before the main loop
 {
 	mResourceManager.setBasePath(getBasePath());
 
+	// The deferred path's shaders are resources like any other
+	if(mRenderingPath == RENDERING_PATH_DEFERRED && !mSimulationOnly)
+	{
+		ResourceManager::shaderPointer geometryShader =
+			mResourceManager.addShader(DEFERRED_GEOMETRY_SHADER_VERTEX, DEFERRED_GEOMETRY_SHADER_FRAGMENT);
+		geometryShader->setInstancedShader(
+			mResourceManager.addShader(DEFERRED_GEOMETRY_SHADER_INSTANCED_VERTEX, DEFERRED_GEOMETRY_SHADER_FRAGMENT));
+
+		mRenderQueue.setDeferredShading(geometryShader,
+			mResourceManager.addShader(DEFERRED_LIGHTING_SHADER_VERTEX, DEFERRED_LIGHTING_SHADER_FRAGMENT));
+	}
+
+	// Shadow casting lights need a depth shader, lights without shadows cost nothing
+	if(!mSimulationOnly)
+		mRenderQueue.setShadowMapping(mResourceManager.addShader(SHADOW_MAP_SHADER_VERTEX, SHADOW_MAP_SHADER_FRAGMENT));
+
 	// Scripts
 	// Only one script for now
-	ResourceManager::scriptPointer mainScript = mResourceManager.addScript(MAIN_SCRIPT_NAME, MAIN_SCRIPT_FILE);
+	ResourceManager::scriptPointer mainScript = mResourceManager.addScript(MAIN_SCRIPT_NAME, mMainScriptFile);
 
 	mainScript->bindInterface(*this);
+
+	// Scripts must get the same random numbers when replaying
+	if(mReplay.isRecording() || mReplay.isReplaying())
+		mainScript->runString("math.randomseed(" + std::to_string(mReplay.getSeed()) + ")");
+
 	// Run the script to get all of the definitions and all
 	mainScript->run();
 	// Run the script's init function
@@ -191,6 +237,20 @@ void Game::initMainLoop() // Initialize a few things before the main loop
 }
 
 void Game::cleanUp() // Cleans up everything. Call before quitting
+{
+	mProfiler.writeCSV(PROFILER_CSV_FILE);
+	mReplay.stop();
+
+	if(!mSimulationOnly)
+		cleanUpAudioAndGraphics();
+
+	SDL_Quit();
+
+	Utils::LOGPRINT("Game quit successfully.");
+	Utils::closeLogFile();
+}
+
+void Game::cleanUpAudioAndGraphics()
 {
 	// Quit
 	// From https://www.libsdl.org/projects/SDL_mixer/docs/SDL_mixer_10.html#SEC10
@@ -204,28 +264,53 @@ void Game::cleanUp() // Cleans up everything. Call before quitting
 
 	Mix_CloseAudio();
 
-	SDL_GL_DeleteContext(mMainContext);
-	SDL_DestroyWindow(mMainWindow);
-	SDL_Quit();
-
-	Utils::LOGPRINT("Game quit successfully.");
-	Utils::closeLogFile();
+	if(mHeadless)
+		mHeadlessContext.destroy();
+	else
+	{
+		SDL_GL_DeleteContext(mMainContext);
+		SDL_DestroyWindow(mMainWindow);
+	}
 }
 
 void Game::doEvents()
 {
+	Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_EVENTS);
+
 	SDL_Event event;
 	while(SDL_PollEvent(&event))
 	{
+		if(mReplay.isReplaying()) // Input comes from the replay, but we can still close the window
+		{
+			if(event.type == SDL_QUIT)
+				quit();
+
+			continue;
+		}
+
+		mReplay.recordEvent(event);
 		mInputManager.updateKeyByEvent(event);
 
 		if(event.type == SDL_QUIT)
 			quit();
 	}
+
+	if(mReplay.isReplaying())
+	{
+		for(const SDL_Event& recordedEvent : mReplay.getFrameEvents())
+		{
+			mInputManager.updateKeyByEvent(recordedEvent);
+
+			if(recordedEvent.type == SDL_QUIT)
+				quit();
+		}
+	}
 }
 
 void Game::checkForErrors() // Call each frame for safety. Do not call after deleting the OpenGL context.
 {
+	Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_ERROR_CHECK);
+
 	const int maxGLErrors = 1000;
 	bool finishedGLErrors = false;
 
@@ -274,15 +359,66 @@ float Game::calculateAspectRatio()
 	return (  static_cast<float>(mSize.x) / static_cast<float>(mSize.y)  );
 }
 
-void Game::step(float divider) // Movement and all
+void Game::step() // Movement and all
 {
-	mEntityManager.step(divider);
+	{
+		Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_PHYSICS_BODIES);
+		mEntityManager.stepBodies();
+	}
+
+	{
+		Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_PHYSICS_WORLD);
+		mEntityManager.stepPhysicsWorld();
+	}
 
 	// Run the script's step()
+	Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_SCRIPT);
 	ResourceManager::scriptPointer mainScript = mResourceManager.findScript(MAIN_SCRIPT_NAME);
 	mainScript->runFunction(MAIN_SCRIPT_FUNCTION_STEP);
 }
 
+// Does as many fixed steps as needed to simulate elapsedTime (in ns) more
+// Can run on the simulation thread when pipelined, so no OpenGL here!
+void Game::simulate(std::int64_t elapsedTime)
+{
+	mAccumulatedStepTime += elapsedTime;
+
+	// Do as many fixed steps as needed to be where we want to be, the leftover time stays accumulated
+	int stepCount = static_cast<int>(mAccumulatedStepTime / mStepLength);
+	if(stepCount > mMaxStepsPerFrame)
+		stepCount = mMaxStepsPerFrame;
+
+	if(mReplay.isReplaying())
+		stepCount = mReplay.getFrameStepCount(); // Do exactly what was done, even if the max changed since
+
+	for(int i = 0; i < stepCount; i++)
+		step();
+
+	mAccumulatedStepTime -= stepCount * mStepLength;
+	mReplay.endFrame(stepCount);
+
+	// We could not catch up. Drop the late steps instead of trying to do even more of them next frame,
+	// which would only make the next frame slower (spiral of death).
+	if(mAccumulatedStepTime >= mStepLength)
+		mAccumulatedStepTime %= mStepLength;
+	else if(mAccumulatedStepTime < 0) // Only if a replay did more steps than we had time for
+		mAccumulatedStepTime = 0;
+
+	// Render in between the last two steps, so movement stays smooth even if steps and frames don't line up
+	mEntityManager.setInterpolationFactor(static_cast<float>(mAccumulatedStepTime) / static_cast<float>(mStepLength));
+}
+
+// Waits for the simulation thread to be done
+// Returns true if a simulation was running
+bool Game::finishSimulation()
+{
+	if(!mSimulation.valid())
+		return false;
+
+	mSimulation.get(); // Blocks until it is done
+	return true;
+}
+
 void Game::resetGraphics()
 {
 	// Set clear color
@@ -290,70 +426,192 @@ void Game::resetGraphics()
 		1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear both color buffers and depth (z-indexes) buffers to push a clean buffer when done
 
-	// It looks like it's better to call these each frame
-	glEnable(GL_DEPTH_TEST);// Enable depth test (check if z is closer to the screen than last fragement's z)
+	// It looks like it's better to call these each frame. GLState skips them when nothing changed them.
+	GLState::setCapability(GL_DEPTH_TEST, true);// Enable depth test (check if z is closer to the screen than last fragement's z)
 	glDepthFunc(GL_LESS); // Accept the fragment closer to the camera
 
 	// Cull triangles which normal is not towards the camera
 	// If there are holes in the model because of this, click the "invert normals" button in your 3D modeler.
-	glEnable(GL_CULL_FACE);
+	GLState::setCapability(GL_CULL_FACE, true);
 	glCullFace(GL_BACK);
 	glPolygonMode(GRAPHICS_RASTERIZE_FACE, GRAPHICS_RASTERIZE_MODE);
+
+	mStreamBuffer.beginFrame(); // Waits if the GPU is still reading the region from STREAM_BUFFER_FRAMES frames ago
 }
 
 void Game::render()
 {
-	mEntityManager.render();
-	SDL_GL_SwapWindow(mMainWindow);
+	{
+		Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_RENDER);
+		mEntityManager.render(mRenderQueue);
+	}
+
+	swapWindow();
 }
 
-void Game::doMainLoop()
+void Game::swapWindow()
 {
-	SimpleTimer fpsTimer; // For calculating update delay and all
-	int currentTime = fpsTimer.start();
+	Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_SWAP);
 
-	// Number of steps we need to do to be where we want to be
-	int numberOfStepsToDo = (currentTime - mLastFrameTime)/mStepLength;
+	mStreamBuffer.endFrame();
+
+	if(mHeadless)
+		mHeadlessContext.swap();
+	else
+		SDL_GL_SwapWindow(mMainWindow);
+}
+
+// Everything on this thread, one after the other
+void Game::doSerialFrame(std::int64_t elapsedTime)
+{
+	PhysicsBody::setDebugShapeDeferring(false);
 
 	doEvents();
 	resetGraphics(); // Call before step if we want to do stuff in there
-
-	if(mLastFrameTime != 0) // Make sure everything is good before moving stuff!
-	{
-		for(int i = 0; i < numberOfStepsToDo; i++)
-			step(static_cast<float>(numberOfStepsToDo));
-	}
+	simulate(elapsedTime);
 
 	render();
 	checkForErrors();
+}
 
-	mLastFrameTime = currentTime;
+// Simulates the next frame on another thread while we render what the last simulation saw.
+// Everything the simulation touches (entities, input, Lua) is only touched here while it is not running.
+void Game::doPipelinedFrame(std::int64_t elapsedTime, bool simulated)
+{
+	if(simulated)
+		mFrontRenderSnapshot = 1 - mFrontRenderSnapshot; // The simulation is done with it, swap!
+
+	RenderSnapshot& frontSnapshot = mRenderSnapshots[mFrontRenderSnapshot];
+	RenderSnapshot& backSnapshot = mRenderSnapshots[1 - mFrontRenderSnapshot];
 
-	int minTimePerFrame = 1000 / mMaxFramesPerSecond; // In miliseconds
+	backSnapshot.clear(); // Here, since this can release OpenGL resources
+	doEvents();
+
+	// Lua can't draw debug shapes from the other thread, queue them in the snapshot instead
+	PhysicsBody::setDebugShapeDeferring(true);
+
+	mSimulation = std::async(std::launch::async, [this, elapsedTime, &backSnapshot]()
+	{
+		simulate(elapsedTime);
+		mEntityManager.fillRenderSnapshot(backSnapshot, mRenderQueue.getMaxLightIndices());
+	});
 
-	// If the frame took les ticks than the minimum, delay the next frame, virtually always does this.
-	if(fpsTimer.getTicks() < minTimePerFrame)
 	{
-		SDL_Delay(minTimePerFrame - fpsTimer.getTicks()); // Delay the remaining time for the ticks per frame wanted
+		Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_RENDER);
+		resetGraphics();
+		frontSnapshot.render(mRenderQueue);
 	}
+
+	swapWindow();
+	checkForErrors();
 }
 
-// Public Interface //
+// In nanoseconds, 0 for no limit
+std::int64_t Game::getFrameLength()
+{
+	if(mSimulationOnly) // One step per frame
+		return (mSimulationSpeed > 0.0f) ? static_cast<std::int64_t>(mStepLength / mSimulationSpeed) : 0;
 
-// Initializes the game
-// Returns false if it failed
-bool Game::init()
-{	
-	Utils::LOGPRINT(std::string() + "Starting " + ENGINE_NAME + " v" + ENGINE_VERSION + "!");
+	return (mMaxFramesPerSecond > 0) ? 1000000000 / mMaxFramesPerSecond : 0;
+}
+
+// Sleeps until it is time for the next frame
+// Frames are kept on a fixed rhythm, so a frame that wakes up a bit late doesn't push all of the next ones
+void Game::waitForNextFrame(std::int64_t frameStartTime)
+{
+	std::int64_t frameLength = getFrameLength();
+
+	if(frameLength == 0) // No limit
+		return;
+
+	Profiler::StageTimer timer(mProfiler, PROFILER_STAGE_SLEEP);
+
+	if(mNextFrameDeadline == 0)
+		mNextFrameDeadline = frameStartTime;
+
+	mNextFrameDeadline += frameLength;
+
+	std::int64_t now = HighResolutionClock::getNanoseconds();
+
+	// This frame was too long. Start the rhythm again from now instead of rushing the next frames to catch up.
+	if(now >= mNextFrameDeadline)
+		mNextFrameDeadline = now;
+	else
+		HighResolutionClock::sleepUntil(mNextFrameDeadline);
+}
+
+// Gives the profiler the length and counters of the last frame, and starts a new one
+void Game::recordFrame(std::int64_t frameTime)
+{
+	mProfiler.addStageTime(PROFILER_STAGE_FRAME, frameTime);
+	mProfiler.addCount(PROFILER_COUNTER_DRAW_CALLS, Profiler::takeDrawCallCount());
+	mProfiler.addCount(PROFILER_COUNTER_VISIBLE_OBJECTS, Profiler::takeVisibleObjectCount());
+	mProfiler.addCount(PROFILER_COUNTER_CULLED_OBJECTS, Profiler::takeCulledObjectCount());
+	mProfiler.addCount(PROFILER_COUNTER_GL_CALLS, GLState::takeCallCount());
+	mProfiler.addCount(PROFILER_COUNTER_SKIPPED_GL_CALLS, GLState::takeSkippedCallCount());
+	mProfiler.endFrame();
+}
 
-	// SDL_INIT_AUDIO for SDL_mixer
-	if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_AUDIO) < 0)
+void Game::doMainLoop()
+{
+	std::int64_t currentTime = HighResolutionClock::getNanoseconds();
+
+	std::int64_t elapsedTime = 0;
+	if(mLastFrameTime != 0) // Make sure everything is good before moving stuff!
+		elapsedTime = currentTime - mLastFrameTime;
+
+	// Always wait for the last simulation, even if we stopped pipelining since
+	bool simulated = finishSimulation();
+	mJobSystem.resetScratchAllocators(); // No jobs are running between frames
+
+	// Nothing is recording now. When pipelined, this frame's simulation times end up with the next frame's.
+	if(mLastFrameTime != 0)
+		recordFrame(elapsedTime);
+
+	// Without graphics, every frame is exactly one step. The simulation speed decides how often they come.
+	if(mSimulationOnly)
+		elapsedTime = mStepLength;
+
+	// When replaying, the recorded time is simulated instead of the real one
+	if(!mReplay.beginFrame(elapsedTime))
 	{
-		// Failed
-		Utils::CRASH_FROM_SDL("Unable to initialize SDL!");
-		return false;
+		Utils::LOGPRINT("Replay is over, quitting.");
+		quit();
+		mLastFrameTime = 0; // This frame did nothing, don't record it
+		return;
+	}
+
+	if(mSimulationOnly)
+	{
+		doEvents();
+		simulate(elapsedTime);
+	} else if(mPipelinedRendering)
+		doPipelinedFrame(elapsedTime, simulated);
+	else
+	{
+		if(simulated)
+		{
+			// Release what the snapshots were holding on to
+			mRenderSnapshots[0].clear();
+			mRenderSnapshots[1].clear();
+		}
+
+		doSerialFrame(elapsedTime);
 	}
 
+	mLastFrameTime = currentTime;
+
+	mFrameCount++;
+	if(mFrameLimit > 0 && mFrameCount >= mFrameLimit)
+		quit();
+
+	if(!mReplay.isReplaying()) // Replays run as fast as they can, their times are recorded
+		waitForNextFrame(currentTime);
+}
+
+// Returns false if it failed
+bool Game::initAudio()
+{
 	if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) // 2 for stereo
 	{
 		Utils::CRASH_FROM_SDL("Unable to open SDL_mixer!");
@@ -372,36 +630,50 @@ bool Game::init()
 		return false;
 	}
 
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, GRAPHICS_OPENGL_MAJOR_VERSION);
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, GRAPHICS_OPENGL_MINOR_VERSION);
-
-	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+	return true;
+}
 
-	mMainWindow = SDL_CreateWindow(mName.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, mSize.x, mSize.y, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
-	
-	if(!mMainWindow) // If the window failed to create, crash
+// Window (unless headless), OpenGL context and OpenGL state
+// Returns false if it failed
+bool Game::initGraphics()
+{
+	if(mHeadless)
 	{
-		Utils::CRASH_FROM_SDL("Unable to create window!");
-		return false;
-	}
+		if(!mHeadlessContext.create(mSize)) // Loads OpenGL too
+			return false;
+	} else
+	{
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, GRAPHICS_OPENGL_MAJOR_VERSION);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, GRAPHICS_OPENGL_MINOR_VERSION);
 
-	mMainContext = SDL_GL_CreateContext(mMainWindow); // Create OpenGL context!
+		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+		SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 
-	if(!mMainContext)
-	{
-		Utils::CRASH_FROM_SDL("Unable to create OpenGL context! This game requries OpenGL " +
-			std::to_string(GRAPHICS_OPENGL_MAJOR_VERSION) + "." + std::to_string(GRAPHICS_OPENGL_MINOR_VERSION) +
-			". Does your system support it? Try updating your graphics drivers!");
-		return false;
-	}
+		mMainWindow = SDL_CreateWindow(mName.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, mSize.x, mSize.y, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+		
+		if(!mMainWindow) // If the window failed to create, crash
+		{
+			Utils::CRASH_FROM_SDL("Unable to create window!");
+			return false;
+		}
 
-	SDL_GL_SetSwapInterval(1); // Kind of VSync?
+		mMainContext = SDL_GL_CreateContext(mMainWindow); // Create OpenGL context!
 
-	if(!gladLoadGL()) // Load OpenGL at runtime. I don't use SDL's loader, so no need to use gladLoadGLLoader().
-	{
-		Utils::CRASH("GLAD failed to load OpenGL!");
-		return false;
+		if(!mMainContext)
+		{
+			Utils::CRASH_FROM_SDL("Unable to create OpenGL context! This game requries OpenGL " +
+				std::to_string(GRAPHICS_OPENGL_MAJOR_VERSION) + "." + std::to_string(GRAPHICS_OPENGL_MINOR_VERSION) +
+				". Does your system support it? Try updating your graphics drivers!");
+			return false;
+		}
+
+		SDL_GL_SetSwapInterval(1); // Kind of VSync?
+
+		if(!gladLoadGL()) // Load OpenGL at runtime. I don't use SDL's loader, so no need to use gladLoadGLLoader().
+		{
+			Utils::CRASH("GLAD failed to load OpenGL!");
+			return false;
+		}
 	}
 
 	// Output OpenGL version
@@ -419,6 +691,43 @@ bool Game::init()
 	setupGraphics();
 	checkForErrors();
 
+	return true;
+}
+
+// Public Interface //
+
+// Initializes the game
+// Returns false if it failed
+bool Game::init()
+{	
+	Utils::LOGPRINT(std::string() + "Starting " + ENGINE_NAME + " v" + ENGINE_VERSION + "!");
+
+	Uint32 subsystems = SDL_INIT_EVENTS;
+
+	if(!mSimulationOnly)
+	{
+		subsystems |= SDL_INIT_AUDIO; // For SDL_mixer
+
+		if(mHeadless)
+			SDL_setenv("SDL_AUDIODRIVER", "dummy", 0); // Build machines rarely have sound cards. Doesn't replace what the user set.
+		else
+			subsystems |= SDL_INIT_VIDEO;
+	}
+
+	if(SDL_Init(subsystems) < 0)
+	{
+		// Failed
+		Utils::CRASH_FROM_SDL("Unable to initialize SDL!");
+		return false;
+	}
+
+	if(!mSimulationOnly)
+	{
+		if(!initAudio() || !initGraphics())
+			return false;
+	}
+
+	Utils::LOGPRINT("Job system: " + std::to_string(mJobSystem.getWorkerCount()) + " worker threads");
 	Utils::LOGPRINT("Initialization finished!");
 	mInitialized = true;
 
@@ -436,6 +745,12 @@ void Game::startMainLoop() // Starts the main loop
 			doMainLoop();
 		}
 
+		finishSimulation(); // Don't pull the context from under it
+
+		// The last frame is only over now, record it before the profiler is written
+		if(mLastFrameTime != 0)
+			recordFrame(HighResolutionClock::getNanoseconds() - mLastFrameTime);
+
 		cleanUp();
 	} else
 		Utils::CRASH("Game was not initialized before launching the main loop!");
@@ -448,9 +763,124 @@ void Game::quit() // Call this when you want to quit to be clean
 	mQuitting = true;
 }
 
+// Records input and frame times to a file, to be played back with playReplay()
+// Call before starting the main loop. Returns false on failure.
+bool Game::recordReplay(const std::string& path)
+{
+	std::uint32_t seed = static_cast<std::uint32_t>(HighResolutionClock::getNanoseconds());
+	return mReplay.startRecording(path, mStepLength, seed);
+}
+
+// Plays back a recorded session instead of reading input; the game quits when it is over
+// Call before starting the main loop. Returns false on failure.
+bool Game::playReplay(const std::string& path)
+{
+	return mReplay.startReplaying(path, mStepLength);
+}
+
+// Renders offscreen without a window, for machines without a display. Needs a build with SDL3D_HEADLESS_EGL.
+// Every dumpInterval frames, the frame is written to <dumpPrefix><frame>.bmp (0 to never dump).
+// Call before init().
+void Game::setHeadless(bool headless, const std::string& dumpPrefix, int dumpInterval)
+{
+	mHeadless = headless;
+	mHeadlessContext.setFrameDumping(dumpPrefix, dumpInterval);
+}
+
+bool Game::isHeadless()
+{
+	return mHeadless;
+}
+
+// No window, OpenGL or audio: only the simulation (physics and gameStep()) runs.
+// Resources can still be created, they just aren't sent to the GPU or the sound card. Call before init().
+void Game::setSimulationOnly(bool simulationOnly)
+{
+	mSimulationOnly = simulationOnly;
+
+	Graphics::setEnabled(!simulationOnly);
+	Sound::setAudioEnabled(!simulationOnly);
+}
+
+bool Game::isSimulationOnly()
+{
+	return mSimulationOnly;
+}
+
+// RENDERING_PATH_FORWARD or RENDERING_PATH_DEFERRED (see DeferredRenderer). Call before init().
+void Game::setRenderingPath(int renderingPath)
+{
+	if(mInitialized)
+	{
+		Utils::WARN("The rendering path can only be chosen before initializing the game!");
+		return;
+	}
+
+	mRenderingPath = renderingPath;
+}
+
+int Game::getRenderingPath()
+{
+	return mRenderingPath;
+}
+
+// When simulating only, how fast compared to real time. 0 to go as fast as possible.
+void Game::setSimulationSpeed(float speed)
+{
+	if(speed < 0.0f)
+	{
+		Utils::WARN("Simulation speed can't be negative! Using 0 (as fast as possible).");
+		speed = 0.0f;
+	}
+
+	mSimulationSpeed = speed;
+}
+
+float Game::getSimulationSpeed()
+{
+	return mSimulationSpeed;
+}
+
+// In the scripts directory. Call before starting the main loop.
+void Game::setMainScriptFile(const std::string& file)
+{
+	mMainScriptFile = file;
+}
+
+// Lets whoever launched the game pass settings to the scripts
+void Game::setLaunchParameter(const std::string& name, const std::string& value)
+{
+	mLaunchParameters[name] = value;
+}
+
+std::string Game::getLaunchParameter(const std::string& name, const std::string& defaultValue)
+{
+	auto it = mLaunchParameters.find(name);
+
+	if(it == mLaunchParameters.end())
+		return defaultValue;
+
+	return it->second;
+}
+
+// The game quits by itself after this many frames, 0 for no limit
+void Game::setFrameLimit(int frames)
+{
+	mFrameLimit = frames;
+}
+
+int Game::getFrameCount()
+{
+	return mFrameCount;
+}
+
 void Game::setName(const std::string& name)
 {
 	mName = name;
+
+	if(mHeadless || mSimulationOnly) // No window to name
+		return;
+
 	SDL_SetWindowTitle(mMainWindow, name.c_str());
 }
 
@@ -463,10 +893,15 @@ std::string Game::getName()
 void Game::setSize(glm::ivec2 size)
 {
 	mSize = size;
-	SDL_SetWindowSize(mMainWindow, size.x, size.y);
+
+	if(mHeadless)
+		mHeadlessContext.resize(size);
+	else if(!mSimulationOnly) // No window to resize
+		SDL_SetWindowSize(mMainWindow, size.x, size.y);
 	
 	// Resize the OpenGL viewport
-	glViewport(0, 0, size.x, size.y);
+	if(Graphics::isEnabled() && mInitialized)
+		glViewport(0, 0, size.x, size.y);
 
 	// Update camera
 	mEntityManager.getGameCamera().setAspectRatio(calculateAspectRatio());
@@ -479,18 +914,94 @@ glm::vec2 Game::getSize()
 
 void Game::setMaxFramesPerSecond(int maxFPS)
 {
+	if(maxFPS < 0)
+	{
+		Utils::WARN("Max frames per second can't be negative! Using 0 (no limit).");
+		maxFPS = 0;
+	}
+
 	mMaxFramesPerSecond = maxFPS;
 }
 
+// The most steps done in one frame when the game is late
+void Game::setMaxStepsPerFrame(int maxSteps)
+{
+	if(maxSteps < 1)
+	{
+		Utils::WARN("Max steps per frame must be at least 1! Using 1.");
+		maxSteps = 1;
+	}
+
+	mMaxStepsPerFrame = maxSteps;
+}
+
+int Game::getMaxStepsPerFrame()
+{
+	return mMaxStepsPerFrame;
+}
+
+// Simulates the next frame on another thread while rendering the current one. Takes effect next frame.
+// While pipelined, gameStep() runs on the other thread: don't load resources or touch OpenGL from it!
+void Game::setPipelinedRendering(bool pipelined)
+{
+	mPipelinedRendering = pipelined;
+}
+
+bool Game::isPipelinedRendering()
+{
+	return mPipelinedRendering;
+}
+
+// Merges static objects sharing a shader and texture, see StaticBatcher
+void Game::setStaticBatching(bool batching)
+{
+	mRenderQueue.setStaticBatching(batching);
+}
+
+bool Game::isStaticBatching()
+{
+	return mRenderQueue.isStaticBatching();
+}
+
+// Draws far geometries with their simpler levels of detail, see RenderQueue
+void Game::setLODSelection(bool selection)
+{
+	mRenderQueue.setLODSelection(selection);
+}
+
+bool Game::isLODSelection()
+{
+	return mRenderQueue.isLODSelection();
+}
+
+// Skips objects the camera can't see, see RenderQueue
+void Game::setFrustumCulling(bool culling)
+{
+	mRenderQueue.setFrustumCulling(culling);
+}
+
+bool Game::isFrustumCulling()
+{
+	return mRenderQueue.isFrustumCulling();
+}
+
 // Sets the game's main window position
 // The coords are the top left corner
+// Does nothing without a window (headless or simulation only)
 void Game::setMainWindowPosition(glm::ivec2 position)
 {
+	if(mHeadless || mSimulationOnly)
+		return;
+
 	SDL_SetWindowPosition(mMainWindow, position.x, position.y);
 }
 
+// 0, 0 without a window
 glm::ivec2 Game::getMainWindowPosition()
 {
+	if(mHeadless || mSimulationOnly)
+		return glm::ivec2(0);
+
 	int x = 0;
 	int y = 0;
 	SDL_GetWindowPosition(mMainWindow, &x, &y);
@@ -501,6 +1012,9 @@ glm::ivec2 Game::getMainWindowPosition()
 // Re-centers the game's main window on the first display
 void Game::reCenterMainWindow()
 {
+	if(mHeadless || mSimulationOnly)
+		return;
+
 	setMainWindowPosition(glm::vec2(SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED));
 }
 
@@ -527,4 +1041,14 @@ InputManager& Game::getInputManager()
 EntityManager& Game::getEntityManager()
 {
 	return mEntityManager;
+}
+
+JobSystem& Game::getJobSystem()
+{
+	return mJobSystem;
+}
+
+Profiler& Game::getProfiler()
+{
+	return mProfiler;
 }
\ No newline at end of file
@@ -26,30 +26,69 @@
 #include <ResourceManager.hpp>
 #include <InputManager.hpp>
 #include <EntityManager.hpp>
+#include <RenderSnapshot.hpp>
+#include <RenderQueue.hpp>
+#include <StreamBuffer.hpp>
+#include <JobSystem.hpp>
+#include <Profiler.hpp>
+#include <Replay.hpp>
+#include <HeadlessContext.hpp>
 
 #include <glm/glm.hpp>
 
+#include <map>
+#include <string>
+#include <atomic>
+#include <future>
+#include <cstdint>
+
 class Game
 {
 private:
 	std::string mName;
 	std::string mLogFile;
+	std::string mMainScriptFile;
+	std::map<std::string, std::string> mLaunchParameters; // Given by the command line, for scripts
 
 	glm::ivec2 mSize;
-	int mMaxFramesPerSecond;
+	int mMaxFramesPerSecond; // 0 for no limit
+	int mFrameLimit; // The game quits after this many frames, 0 for no limit
+	int mFrameCount;
 	
-	int mLastFrameTime; // Time at last frame
-	int mStepLength;
+	// All loop times are in nanoseconds
+	std::int64_t mLastFrameTime; // Clock time at the start of the last frame
+	std::int64_t mNextFrameDeadline; // When the next frame should start, for frame limiting
+	std::int64_t mStepLength; // The amount of time each step simulates
+	std::int64_t mAccumulatedStepTime; // Time we still need to simulate. Always under mStepLength after a frame.
+	int mMaxStepsPerFrame;
 
 	glm::vec3 mGraphicsBackgroundColor;
 
 	bool mInitialized; // Set to true after initializing
-	bool mQuitting; // If set to true, the game will quit at the end of the frame
+	std::atomic<bool> mQuitting; // If set to true, the game will quit at the end of the frame. Can be set from the simulation thread.
+
+	// When pipelined, the next frame is simulated on another thread while this thread renders the last one
+	std::atomic<bool> mPipelinedRendering;
+	RenderSnapshot mRenderSnapshots[2]; // One is filled by the simulation, the other is rendered
+	int mFrontRenderSnapshot; // Index of the snapshot being rendered
+	RenderQueue mRenderQueue; // Only used on the rendering thread
+	StreamBuffer mStreamBuffer; // Same, see Graphics::getStreamBuffer()
+	int mRenderingPath; // RENDERING_PATH_*, set up when the main loop starts
+	std::future<void> mSimulation; // Valid while a simulation is running on the other thread
 
 	// Pointers for SDL stuff needed
-	SDL_Window* mMainWindow; // We might have multiple windows one day
+	SDL_Window* mMainWindow; // We might have multiple windows one day. Null when headless.
 	SDL_GLContext mMainContext; // OpenGl context
 
+	bool mHeadless; // No window, render offscreen
+	bool mSimulationOnly; // No window, OpenGL or audio at all
+	float mSimulationSpeed; // When simulating only, multiple of real time. 0 for as fast as possible.
+	HeadlessContext mHeadlessContext;
+
+	JobSystem mJobSystem; // Before the managers, they use it
+	Profiler mProfiler;
+	Replay mReplay;
+
 	ResourceManager mResourceManager; // On stack, calls its constructor by itself and cleans (deconstructs) itself like magic.
 									  // But in this case, we need data from the user to create the resource manager, so we
 									  // need a list initialization. See the Game constructor in Game.cpp
@@ -62,16 +101,27 @@ private:
 	bool checkCompability();
 	void setupGraphics();
 	void initMainLoop();
+	bool initAudio();
+	bool initGraphics();
 	void cleanUp();
+	void cleanUpAudioAndGraphics();
 
 	void doEvents();
 	void checkForErrors();
 
 	float calculateAspectRatio();
 
-	void step(float divider);
+	void step();
+	void simulate(std::int64_t elapsedTime);
+	bool finishSimulation();
 	void resetGraphics();
 	void render();
+	void swapWindow();
+	void doSerialFrame(std::int64_t elapsedTime);
+	void doPipelinedFrame(std::int64_t elapsedTime, bool simulated);
+	std::int64_t getFrameLength();
+	void waitForNextFrame(std::int64_t frameStartTime);
+	void recordFrame(std::int64_t frameTime);
 	void doMainLoop();
 
 public:
@@ -83,6 +133,23 @@ public:
 	void startMainLoop();
 	void quit();
 
+	bool recordReplay(const std::string& path);
+	bool playReplay(const std::string& path);
+
+	void setHeadless(bool headless, const std::string& dumpPrefix, int dumpInterval);
+	bool isHeadless();
+	void setSimulationOnly(bool simulationOnly);
+	bool isSimulationOnly();
+	void setRenderingPath(int renderingPath);
+	int getRenderingPath();
+	void setSimulationSpeed(float speed);
+	float getSimulationSpeed();
+	void setMainScriptFile(const std::string& file);
+	void setLaunchParameter(const std::string& name, const std::string& value);
+	std::string getLaunchParameter(const std::string& name, const std::string& defaultValue);
+	void setFrameLimit(int frames);
+	int getFrameCount();
+
 	// Useful for scripting and other things
 	void setName(const std::string& name);
 	std::string getName();
@@ -90,6 +157,16 @@ public:
 	glm::vec2 getSize();
 
 	void setMaxFramesPerSecond(int maxFPS);
+	void setMaxStepsPerFrame(int maxSteps);
+	int getMaxStepsPerFrame();
+	void setPipelinedRendering(bool pipelined);
+	bool isPipelinedRendering();
+	void setStaticBatching(bool batching);
+	bool isStaticBatching();
+	void setLODSelection(bool selection);
+	bool isLODSelection();
+	void setFrustumCulling(bool culling);
+	bool isFrustumCulling();
 	void setMainWindowPosition(glm::ivec2 position);
 	glm::ivec2 getMainWindowPosition();
 	void reCenterMainWindow();
@@ -100,6 +177,8 @@ public:
 	ResourceManager& getResourceManager();
 	InputManager& getInputManager();
 	EntityManager& getEntityManager();
+	JobSystem& getJobSystem();
+	Profiler& getProfiler();
 };
 
 #endif /* GAME_HPP */
\ No newline at end of file
@@ -0,0 +1,58 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <Graphics.hpp>
+
+bool Graphics::mEnabled = true;
+GLuint Graphics::mDefaultVertexArray = 0;
+StreamBuffer* Graphics::mStreamBuffer = nullptr;
+
+void Graphics::setEnabled(bool enabled)
+{
+	mEnabled = enabled;
+}
+
+bool Graphics::isEnabled()
+{
+	return mEnabled;
+}
+
+// The vertex array object bound when nothing in particular is being drawn.
+// Geometries have their own, whoever binds one must put this one back after.
+void Graphics::setDefaultVertexArray(GLuint vertexArray)
+{
+	mDefaultVertexArray = vertexArray;
+}
+
+GLuint Graphics::getDefaultVertexArray()
+{
+	return mDefaultVertexArray;
+}
+
+// Where per frame data is streamed to the GPU, owned by Game. Null until graphics are set up.
+void Graphics::setStreamBuffer(StreamBuffer* streamBuffer)
+{
+	mStreamBuffer = streamBuffer;
+}
+
+StreamBuffer* Graphics::getStreamBuffer()
+{
+	return mStreamBuffer;
+}
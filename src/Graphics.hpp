@@ -0,0 +1,51 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Global graphics switch. When graphics are disabled (simulation-only mode), nothing touches OpenGL:
+// resources keep their data on the CPU and everything that draws does nothing.
+// Set it before creating any resource!
+// It also knows the engine-wide OpenGL objects everything shares.
+
+#ifndef GRAPHICS_HPP
+#define GRAPHICS_HPP
+
+#include <glad/glad.h>
+
+class StreamBuffer;
+
+class Graphics
+{
+private:
+	static bool mEnabled;
+	static GLuint mDefaultVertexArray;
+	static StreamBuffer* mStreamBuffer;
+
+public:
+	static void setEnabled(bool enabled);
+	static bool isEnabled();
+
+	static void setDefaultVertexArray(GLuint vertexArray);
+	static GLuint getDefaultVertexArray();
+
+	static void setStreamBuffer(StreamBuffer* streamBuffer);
+	static StreamBuffer* getStreamBuffer();
+};
+
+#endif /* GRAPHICS_HPP */
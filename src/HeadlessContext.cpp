@@ -0,0 +1,277 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <HeadlessContext.hpp>
+#include <Definitions.hpp>
+#include <Utils.hpp>
+#include <GLState.hpp>
+
+#include <SDL.h> // For writing BMPs
+
+#include <vector>
+#include <cstring> // For memcpy
+
+#ifdef SDL3D_HEADLESS_EGL
+#define EGL_NO_X11 // We don't want X11's macros in here
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext()
+{
+	mDisplay = nullptr;
+	mContext = nullptr;
+	mSurface = nullptr;
+
+	mFramebuffer = 0;
+	mColorRenderbuffer = 0;
+	mDepthRenderbuffer = 0;
+
+	mDumpInterval = 0;
+	mFrameCount = 0;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	destroy();
+}
+
+// Renders everything in here instead of the default framebuffer, which we don't have
+bool HeadlessContext::createFramebuffer()
+{
+	glGenRenderbuffers(1, &mColorRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, mColorRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, mSize.x, mSize.y);
+
+	glGenRenderbuffers(1, &mDepthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, mDepthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mSize.x, mSize.y);
+
+	glGenFramebuffers(1, &mFramebuffer);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mColorRenderbuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mDepthRenderbuffer);
+
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		Utils::CRASH("Headless framebuffer is incomplete!");
+		return false;
+	}
+
+	return true;
+}
+
+void HeadlessContext::deleteFramebuffer()
+{
+	if(mFramebuffer == 0)
+		return;
+
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::deleteFramebuffer(mFramebuffer);
+	glDeleteRenderbuffers(1, &mColorRenderbuffer);
+	glDeleteRenderbuffers(1, &mDepthRenderbuffer);
+
+	mFramebuffer = 0;
+	mColorRenderbuffer = 0;
+	mDepthRenderbuffer = 0;
+}
+
+// Creates the context, makes it current, loads OpenGL and binds a framebuffer of this size
+// Returns false on failure
+bool HeadlessContext::create(glm::ivec2 size)
+{
+#ifdef SDL3D_HEADLESS_EGL
+	mSize = size;
+
+	// Mesa can give us a display without any window system
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+	if(getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+	if(display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	if(display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+	{
+		Utils::CRASH("Unable to initialize EGL for the headless context!");
+		return false;
+	}
+
+	mDisplay = display;
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	if(!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0 || !eglBindAPI(EGL_OPENGL_API))
+	{
+		destroy();
+		Utils::CRASH("No EGL config supports desktop OpenGL for the headless context!");
+		return false;
+	}
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, GRAPHICS_OPENGL_MAJOR_VERSION,
+		EGL_CONTEXT_MINOR_VERSION, GRAPHICS_OPENGL_MINOR_VERSION,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if(context == EGL_NO_CONTEXT)
+	{
+		destroy();
+		Utils::CRASH("Unable to create the headless OpenGL " + std::to_string(GRAPHICS_OPENGL_MAJOR_VERSION) + "." +
+			std::to_string(GRAPHICS_OPENGL_MINOR_VERSION) + " context!");
+		return false;
+	}
+
+	mContext = context;
+
+	// Surfaceless if we can, we render in our framebuffer anyways
+	if(!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		const EGLint surfaceAttributes[] = {EGL_WIDTH, size.x, EGL_HEIGHT, size.y, EGL_NONE};
+		EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+
+		if(surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context))
+		{
+			destroy();
+			Utils::CRASH("Unable to make the headless context current!");
+			return false;
+		}
+
+		mSurface = surface;
+	}
+
+	if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)))
+	{
+		destroy();
+		Utils::CRASH("GLAD failed to load OpenGL for the headless context!");
+		return false;
+	}
+
+	return createFramebuffer();
+#else
+	Utils::CRASH("This build has no headless support! Build with SDL3D_HEADLESS_EGL.");
+	return false;
+#endif
+}
+
+void HeadlessContext::destroy()
+{
+#ifdef SDL3D_HEADLESS_EGL
+	if(!mDisplay)
+		return;
+
+	if(mContext)
+		deleteFramebuffer();
+
+	eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+	if(mSurface)
+		eglDestroySurface(mDisplay, mSurface);
+
+	if(mContext)
+		eglDestroyContext(mDisplay, mContext);
+
+	eglTerminate(mDisplay);
+#endif
+
+	mDisplay = nullptr;
+	mContext = nullptr;
+	mSurface = nullptr;
+}
+
+bool HeadlessContext::isCreated() const
+{
+	return mContext != nullptr;
+}
+
+// Recreates the framebuffer, if we have one
+bool HeadlessContext::resize(glm::ivec2 size)
+{
+	mSize = size;
+
+	if(!isCreated())
+		return true; // Will be this size when created
+
+	deleteFramebuffer();
+	return createFramebuffer();
+}
+
+// Every interval frames, the frame is written to <prefix><frame number>.bmp. 0 to never dump.
+void HeadlessContext::setFrameDumping(const std::string& prefix, int interval)
+{
+	mDumpPrefix = prefix;
+	mDumpInterval = interval;
+}
+
+// Writes what's in the framebuffer to a BMP file
+// Returns false on failure
+bool HeadlessContext::dumpFrame(const std::string& path)
+{
+	std::size_t rowSize = mSize.x * 4;
+	std::vector<unsigned char> pixels(rowSize * mSize.y);
+	std::vector<unsigned char> flippedPixels(pixels.size());
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, mSize.x, mSize.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	// OpenGL starts at the bottom, BMPs at the top
+	for(int y = 0; y < mSize.y; y++)
+		std::memcpy(&flippedPixels[y * rowSize], &pixels[(mSize.y - 1 - y) * rowSize], rowSize);
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(flippedPixels.data(), mSize.x, mSize.y, 32, static_cast<int>(rowSize),
+		0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000); // Byte order of GL_RGBA, on little endian
+
+	if(!surface || SDL_SaveBMP(surface, path.c_str()) != 0)
+	{
+		Utils::WARN("Could not dump the frame to '" + path + "'! SDL error: " + SDL_GetError());
+		SDL_FreeSurface(surface);
+		return false;
+	}
+
+	SDL_FreeSurface(surface);
+	return true;
+}
+
+// There's nothing to show, but we wait for the frame to be done like a real swap would
+void HeadlessContext::swap()
+{
+	glFinish();
+
+	if(mDumpInterval > 0 && mFrameCount % mDumpInterval == 0)
+		dumpFrame(mDumpPrefix + std::to_string(mFrameCount) + ".bmp");
+
+	mFrameCount++;
+}
@@ -0,0 +1,68 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// An OpenGL context without a window, for machines without a display (build farms, CI).
+// Uses EGL (ex: Mesa's llvmpipe) with a surfaceless context, or a pbuffer if surfaceless isn't supported.
+// Frames are rendered in a framebuffer object of the game's size, and can be dumped to BMP files.
+// Only works if built with SDL3D_HEADLESS_EGL, otherwise create() fails.
+
+#ifndef HEADLESS_CONTEXT_HPP
+#define HEADLESS_CONTEXT_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+
+class HeadlessContext
+{
+private:
+	// EGL handles, as void* so EGL's headers stay out of here
+	void* mDisplay;
+	void* mContext;
+	void* mSurface; // Null when surfaceless
+
+	glm::ivec2 mSize;
+	GLuint mFramebuffer;
+	GLuint mColorRenderbuffer;
+	GLuint mDepthRenderbuffer;
+
+	std::string mDumpPrefix; // Frames are dumped to <prefix><frame>.bmp
+	int mDumpInterval; // Every this many frames, 0 to never dump
+	int mFrameCount;
+
+	bool createFramebuffer();
+	void deleteFramebuffer();
+
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	bool create(glm::ivec2 size);
+	void destroy();
+	bool isCreated() const;
+
+	bool resize(glm::ivec2 size);
+	void setFrameDumping(const std::string& prefix, int interval);
+	bool dumpFrame(const std::string& path);
+	void swap();
+};
+
+#endif /* HEADLESS_CONTEXT_HPP */
@@ -0,0 +1,94 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <HighResolutionClock.hpp>
+
+#include <SDL.h>
+
+#include <cmath>
+
+// Start pessimistic, this goes down quickly on good schedulers
+double HighResolutionClock::mSleepMean = 5000000.0;
+double HighResolutionClock::mSleepM2 = 0.0;
+std::int64_t HighResolutionClock::mSleepCount = 1;
+double HighResolutionClock::mSleepEstimate = 5000000.0;
+
+// Static
+// Welford's running variance
+void HighResolutionClock::recordSleep(std::int64_t duration)
+{
+	// Forget old samples eventually, so we adapt if the system load changes
+	if(mSleepCount >= 1000)
+	{
+		mSleepCount = 1;
+		mSleepM2 = 0.0;
+	}
+
+	mSleepCount++;
+
+	double delta = duration - mSleepMean;
+	mSleepMean += delta / mSleepCount;
+	mSleepM2 += delta * (duration - mSleepMean);
+
+	double standardDeviation = std::sqrt(mSleepM2 / (mSleepCount - 1));
+	mSleepEstimate = mSleepMean + standardDeviation;
+}
+
+// Static
+// Nanoseconds since some point in the past, never goes back
+std::int64_t HighResolutionClock::getNanoseconds()
+{
+	static const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+	Uint64 counter = SDL_GetPerformanceCounter();
+
+	// Split so we don't overflow when multiplying
+	Uint64 seconds = counter / frequency;
+	Uint64 remainder = counter % frequency;
+
+	return static_cast<std::int64_t>(seconds * 1000000000 + (remainder * 1000000000) / frequency);
+}
+
+// Static
+void HighResolutionClock::sleepFor(std::int64_t nanoseconds)
+{
+	sleepUntil(getNanoseconds() + nanoseconds);
+}
+
+// Static
+// Sleeps until the clock reaches the deadline, in nanoseconds
+// Only call from one thread, the sleep statistics are shared
+void HighResolutionClock::sleepUntil(std::int64_t deadline)
+{
+	std::int64_t now = getNanoseconds();
+
+	// Sleep in small steps while even a bad sleep would wake us up in time
+	while(deadline - now > mSleepEstimate)
+	{
+		SDL_Delay(1);
+
+		std::int64_t afterSleep = getNanoseconds();
+		recordSleep(afterSleep - now);
+		now = afterSleep;
+	}
+
+	// Spin for the rest
+	while(now < deadline)
+		now = getNanoseconds();
+}
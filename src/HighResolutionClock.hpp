@@ -0,0 +1,47 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// A monotonic nanosecond clock, and sleeping that doesn't overshoot.
+// The OS can oversleep by a millisecond or more, so we only sleep while we are sure to wake up in time
+// (from measuring our past sleeps), and spin for the rest.
+
+#ifndef HIGH_RESOLUTION_CLOCK_HPP
+#define HIGH_RESOLUTION_CLOCK_HPP
+
+#include <cstdint>
+
+class HighResolutionClock
+{
+private:
+	// How long SDL_Delay(1) really takes, in nanoseconds. Updated with each sleep.
+	static double mSleepMean;
+	static double mSleepM2; // For the variance
+	static std::int64_t mSleepCount;
+	static double mSleepEstimate; // Mean plus one standard deviation
+
+	static void recordSleep(std::int64_t duration);
+
+public:
+	static std::int64_t getNanoseconds();
+
+	static void sleepFor(std::int64_t nanoseconds);
+	static void sleepUntil(std::int64_t deadline);
+};
+
+#endif /* HIGH_RESOLUTION_CLOCK_HPP */
@@ -0,0 +1,319 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <JobSystem.hpp>
+#include <Definitions.hpp>
+#include <Utils.hpp>
+
+thread_local const JobSystem* JobSystem::mCurrentJobSystem = nullptr;
+thread_local int JobSystem::mCurrentQueueIndex = -1;
+
+JobSystem::Job::Job(jobFunction function)
+	: mFunction(function),
+	mPendingCount(1), // Released by submit()
+	mSubmitted(false),
+	mFinished(false)
+{
+	// Do nothing
+}
+
+JobSystem::Job::~Job()
+{
+	// Do nothing
+}
+
+bool JobSystem::Job::isFinished() const
+{
+	return mFinished;
+}
+
+// A worker count under 0 uses getDefaultWorkerCount()
+// With 0 workers, jobs run on the threads that wait for them
+JobSystem::JobSystem(int workerCount)
+	: mQueuedJobCount(0),
+	mStopping(false)
+{
+	if(workerCount < 0)
+		workerCount = getDefaultWorkerCount();
+
+	// The extra queue/allocator is for non-worker threads
+	for(int i = 0; i < workerCount + 1; i++)
+	{
+		mQueues.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+		mScratchAllocators.push_back(std::unique_ptr<ScratchAllocator>(new ScratchAllocator(JOB_SYSTEM_SCRATCH_BLOCK_SIZE)));
+	}
+
+	for(int i = 0; i < workerCount; i++)
+		mWorkers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+	mStopping = true;
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+	mSleepCondition.notify_all();
+
+	for(auto &worker : mWorkers)
+		worker.join();
+}
+
+// Static
+// One worker per core, minus one for the main thread, which helps when it waits
+int JobSystem::getDefaultWorkerCount()
+{
+	int cores = static_cast<int>(std::thread::hardware_concurrency()); // 0 if unknown
+
+	if(cores <= 1)
+		return 0;
+
+	return cores - 1;
+}
+
+int JobSystem::getCurrentQueueIndex() const
+{
+	if(mCurrentJobSystem == this)
+		return mCurrentQueueIndex;
+
+	return static_cast<int>(mQueues.size()) - 1; // Not one of our workers, use the shared queue
+}
+
+void JobSystem::workerLoop(int queueIndex)
+{
+	mCurrentJobSystem = this;
+	mCurrentQueueIndex = queueIndex;
+
+	while(!mStopping)
+	{
+		jobPointer job = popJob(queueIndex);
+
+		if(job)
+		{
+			runJob(job);
+			continue;
+		}
+
+		// Nothing to do, sleep until something is pushed
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mSleepCondition.wait(lock, [this]() {return mStopping || mQueuedJobCount > 0;});
+	}
+}
+
+void JobSystem::pushJob(const jobPointer& job)
+{
+	JobQueue& queue = *mQueues[getCurrentQueueIndex()];
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+
+	mQueuedJobCount++;
+
+	// Lock so a worker can't miss this between checking the count and sleeping
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+	mSleepCondition.notify_one();
+}
+
+// Takes our newest job, or steals the oldest job of someone else
+// Returns an empty pointer if there is nothing to do
+JobSystem::jobPointer JobSystem::popJob(int queueIndex)
+{
+	int queueCount = static_cast<int>(mQueues.size());
+
+	{
+		JobQueue& queue = *mQueues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if(!queue.jobs.empty())
+		{
+			jobPointer job = queue.jobs.back();
+			queue.jobs.pop_back();
+			mQueuedJobCount--;
+			return job;
+		}
+	}
+
+	for(int i = 1; i < queueCount; i++)
+	{
+		JobQueue& victim = *mQueues[(queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if(!victim.jobs.empty())
+		{
+			jobPointer job = victim.jobs.front();
+			victim.jobs.pop_front();
+			mQueuedJobCount--;
+			return job;
+		}
+	}
+
+	return jobPointer();
+}
+
+void JobSystem::runJob(const jobPointer& job)
+{
+	if(job->mFunction)
+		job->mFunction();
+
+	std::vector<jobPointer> dependents;
+
+	{
+		std::lock_guard<std::mutex> lock(job->mDependentsMutex);
+		job->mFinished = true;
+		dependents.swap(job->mDependents);
+	}
+
+	// Start whatever was only waiting on us
+	for(auto &dependent : dependents)
+	{
+		if(--dependent->mPendingCount == 0)
+			pushJob(dependent);
+	}
+}
+
+int JobSystem::getWorkerCount() const
+{
+	return static_cast<int>(mWorkers.size());
+}
+
+// Workers and the thread waiting on them
+int JobSystem::getThreadCount() const
+{
+	return getWorkerCount() + 1;
+}
+
+// The job will not run until it is submitted
+JobSystem::jobPointer JobSystem::createJob(jobFunction function)
+{
+	return jobPointer(new Job(function));
+}
+
+// The job will only start after the dependency is finished. Call before submitting the job!
+// Returns false on error
+bool JobSystem::addDependency(jobPointer job, jobPointer dependency)
+{
+	if(job->mSubmitted)
+	{
+		Utils::CRASH("Cannot add a dependency to a job that was already submitted!");
+		return false;
+	}
+
+	job->mPendingCount++;
+
+	std::lock_guard<std::mutex> lock(dependency->mDependentsMutex);
+
+	if(dependency->mFinished)
+		job->mPendingCount--; // Nothing to wait for. Can't reach 0, we aren't submitted yet.
+	else
+		dependency->mDependents.push_back(job);
+
+	return true;
+}
+
+// Queues the job, or lets its dependencies queue it when they are done
+void JobSystem::submit(jobPointer job)
+{
+	if(job->mSubmitted.exchange(true))
+	{
+		Utils::CRASH("Cannot submit a job twice!");
+		return;
+	}
+
+	if(--job->mPendingCount == 0)
+		pushJob(job);
+}
+
+// Creates and submits a job
+JobSystem::jobPointer JobSystem::run(jobFunction function)
+{
+	jobPointer job = createJob(function);
+	submit(job);
+
+	return job;
+}
+
+// Runs other jobs until this one is finished, so waiting never wastes a thread
+void JobSystem::wait(jobPointer job)
+{
+	int queueIndex = getCurrentQueueIndex();
+
+	while(!job->isFinished())
+	{
+		jobPointer otherJob = popJob(queueIndex);
+
+		if(otherJob)
+			runJob(otherJob);
+		else
+			std::this_thread::yield();
+	}
+}
+
+// Calls function on ranges of [0, count[ on all threads and returns when everything is done
+// A batch size of 0 picks one, big enough to not spend our time queuing but small enough to balance the work
+void JobSystem::parallelFor(std::size_t count, std::size_t batchSize, rangeFunction function)
+{
+	if(count == 0)
+		return;
+
+	if(batchSize == 0)
+		batchSize = count / (getThreadCount() * 4) + 1;
+
+	std::size_t batchCount = (count + batchSize - 1) / batchSize;
+
+	if(batchCount == 1 || mWorkers.empty())
+	{
+		function(0, count); // Not worth it
+		return;
+	}
+
+	jobPointer allDone = createJob(jobFunction());
+
+	for(std::size_t batch = 0; batch < batchCount; batch++)
+	{
+		std::size_t begin = batch * batchSize;
+		std::size_t end = (begin + batchSize < count) ? begin + batchSize : count;
+
+		// The function reference stays valid since we wait below
+		jobPointer job = createJob([&function, begin, end]() {function(begin, end);});
+		addDependency(allDone, job);
+		submit(job);
+	}
+
+	submit(allDone);
+	wait(allDone);
+}
+
+// The current thread's allocator, use it for temporary data inside jobs
+// Non-worker threads share one: only use it from one of them at a time (the game thread).
+ScratchAllocator& JobSystem::getScratchAllocator()
+{
+	return *mScratchAllocators[getCurrentQueueIndex()];
+}
+
+// Frees everything allocated with scratch allocators. Only call when no jobs are running!
+void JobSystem::resetScratchAllocators()
+{
+	for(auto &allocator : mScratchAllocators)
+		allocator->reset();
+}
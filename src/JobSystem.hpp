@@ -0,0 +1,120 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// A work-stealing thread pool. Each worker has its own queue: it takes its newest jobs first, and when
+// it runs out, it steals the oldest jobs of the others. Jobs can depend on other jobs, and a job only
+// starts when all of its dependencies are done.
+// Threads that are not workers (like the main thread) share one more queue, and help when waiting.
+
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <ScratchAllocator.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef> // For std::size_t
+
+class JobSystem
+{
+public:
+	class Job;
+
+	using jobPointer = std::shared_ptr<Job>;
+	using jobFunction = std::function<void()>;
+	using rangeFunction = std::function<void(std::size_t begin, std::size_t end)>; // [begin, end[
+
+	class Job
+	{
+		friend class JobSystem;
+
+	private:
+		jobFunction mFunction;
+
+		std::atomic<int> mPendingCount; // Unfinished dependencies, plus one until it is submitted
+		std::atomic<bool> mSubmitted;
+		std::atomic<bool> mFinished;
+
+		std::mutex mDependentsMutex;
+		std::vector<jobPointer> mDependents; // Jobs waiting on this one
+
+	public:
+		Job(jobFunction function);
+		~Job();
+
+		bool isFinished() const;
+	};
+
+private:
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<jobPointer> jobs;
+	};
+
+	std::vector<std::thread> mWorkers;
+
+	// One per worker, the last one is shared by every other thread
+	std::vector<std::unique_ptr<JobQueue>> mQueues;
+	std::vector<std::unique_ptr<ScratchAllocator>> mScratchAllocators;
+
+	std::atomic<int> mQueuedJobCount; // So sleeping workers know when to wake up
+	std::atomic<bool> mStopping;
+	std::mutex mSleepMutex;
+	std::condition_variable mSleepCondition;
+
+	// Which queue belongs to the current thread
+	static thread_local const JobSystem* mCurrentJobSystem;
+	static thread_local int mCurrentQueueIndex;
+
+	int getCurrentQueueIndex() const;
+
+	void workerLoop(int queueIndex);
+	void pushJob(const jobPointer& job);
+	jobPointer popJob(int queueIndex);
+	void runJob(const jobPointer& job);
+
+public:
+	JobSystem(int workerCount);
+	~JobSystem();
+
+	static int getDefaultWorkerCount();
+
+	int getWorkerCount() const;
+	int getThreadCount() const;
+
+	jobPointer createJob(jobFunction function);
+	bool addDependency(jobPointer job, jobPointer dependency);
+	void submit(jobPointer job);
+	jobPointer run(jobFunction function);
+	void wait(jobPointer job);
+
+	void parallelFor(std::size_t count, std::size_t batchSize, rangeFunction function);
+
+	ScratchAllocator& getScratchAllocator();
+	void resetScratchAllocators();
+};
+
+#endif /* JOB_SYSTEM_HPP */
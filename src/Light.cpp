@@ -25,6 +25,8 @@ Light::Light()
 	mSpecularColor = glm::vec3(0.0f, 0.0f, 0.0f);
 
 	mPower = 60.0f;
+	mOnState = true;
+	mShadowCasting = false;
 }
 
 Light::Light(glm::vec3 position, glm::vec3 diffuseColor, glm::vec3 specularColor, float power)
@@ -35,6 +37,8 @@ Light::Light(glm::vec3 position, glm::vec3 diffuseColor, glm::vec3 specularColor
 	mSpecularColor = specularColor;
 
 	mPower = power;
+	mOnState = true;
+	mShadowCasting = false;
 }
 
 Light::~Light()
@@ -80,4 +84,15 @@ void Light::setOnState(bool onState)
 bool Light::isOn()
 {
 	return mOnState;
+}
+
+// Shadows are off by default, they cost a lot more when the light or things around it move (see ShadowMapCache)
+void Light::setShadowCasting(bool shadowCasting)
+{
+	mShadowCasting = shadowCasting;
+}
+
+bool Light::isShadowCasting()
+{
+	return mShadowCasting;
 }
\ No newline at end of file
@@ -32,6 +32,7 @@ private:
 
 	float mPower;
 	bool mOnState; // Can turn the light on or off
+	bool mShadowCasting; // Only the first SHADOW_MAP_MAX_LIGHTS of the frame get shadows
 
 public:
 	Light();
@@ -49,6 +50,9 @@ public:
 
 	void setOnState(bool onState);
 	bool isOn();
+
+	void setShadowCasting(bool shadowCasting);
+	bool isShadowCasting();
 };
 
 #endif /* LIGHT_HPP */
\ No newline at end of file
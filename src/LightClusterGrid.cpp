@@ -0,0 +1,328 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <LightClusterGrid.hpp>
+#include <JobSystem.hpp>
+
+#include <algorithm> // For std::min and std::max
+#include <cmath> // For std::log, std::pow and std::floor
+#include <cfloat> // For FLT_MAX
+
+LightClusterGrid::LightClusterGrid()
+	: mClusterMins(LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y * LIGHT_CLUSTER_GRID_Z),
+	  mClusterMaxs(LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y * LIGHT_CLUSTER_GRID_Z),
+	  mSliceLightIndices(LIGHT_CLUSTER_GRID_Z),
+	  mClusters(LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y * LIGHT_CLUSTER_GRID_Z)
+{
+	mProjectionMatrix = glm::mat4(0.0f); // Not a projection, so the first build makes the cluster boxes
+	mNearDistance = 1.0f;
+	mFarDistance = 2.0f;
+
+	clear();
+}
+
+LightClusterGrid::~LightClusterGrid()
+{
+	// Do nothing
+}
+
+// PRIVATE
+
+// Static
+// Same order in the shaders: x, then y, then slices
+int LightClusterGrid::getClusterIndex(int x, int y, int z)
+{
+	return (z * LIGHT_CLUSTER_GRID_Y + y) * LIGHT_CLUSTER_GRID_X + x;
+}
+
+// Remakes the view space boxes of the clusters, only needed when the projection changes
+void LightClusterGrid::setProjectionMatrix(const glm::mat4& projectionMatrix)
+{
+	const glm::mat4& p = projectionMatrix; // p[column][row]
+	mProjectionMatrix = projectionMatrix;
+
+	// The depths where NDC z is -1 and 1
+	if(p[2][3] != 0.0f) // Perspective
+	{
+		mNearDistance = p[3][2] / (p[2][2] - 1.0f);
+		mFarDistance = p[3][2] / (p[2][2] + 1.0f);
+	} else
+	{
+		mNearDistance = (p[3][2] + 1.0f) / p[2][2];
+		mFarDistance = (p[3][2] - 1.0f) / p[2][2];
+	}
+
+	if(!(mNearDistance > 0.0f) || !(mFarDistance > mNearDistance)) // Also catches NaNs
+	{
+		mNearDistance = 1.0f;
+		mFarDistance = RENDER_QUEUE_MAX_DEPTH;
+	}
+
+	glm::mat4 inverseProjection = glm::inverse(projectionMatrix);
+
+	for(int z = 0; z < LIGHT_CLUSTER_GRID_Z; z++)
+	{
+		float sliceDepths[2];
+		float sliceNDCDepths[2];
+
+		for(int side = 0; side < 2; side++)
+		{
+			// Exponential slices: every slice is as thick compared to its depth
+			float t = static_cast<float>(z + side) / LIGHT_CLUSTER_GRID_Z;
+			sliceDepths[side] = mNearDistance * std::pow(mFarDistance / mNearDistance, t);
+
+			glm::vec4 clip = projectionMatrix * glm::vec4(0.0f, 0.0f, -sliceDepths[side], 1.0f);
+			sliceNDCDepths[side] = clip.z / clip.w;
+		}
+
+		for(int y = 0; y < LIGHT_CLUSTER_GRID_Y; y++)
+		{
+			for(int x = 0; x < LIGHT_CLUSTER_GRID_X; x++)
+			{
+				glm::vec3 clusterMin(FLT_MAX);
+				glm::vec3 clusterMax(-FLT_MAX);
+
+				// Bring the 8 corners back in view space, works for any projection
+				for(int corner = 0; corner < 8; corner++)
+				{
+					float ndcX = (static_cast<float>(x + (corner & 1)) / LIGHT_CLUSTER_GRID_X) * 2.0f - 1.0f;
+					float ndcY = (static_cast<float>(y + ((corner >> 1) & 1)) / LIGHT_CLUSTER_GRID_Y) * 2.0f - 1.0f;
+
+					glm::vec4 point = inverseProjection * glm::vec4(ndcX, ndcY, sliceNDCDepths[corner >> 2], 1.0f);
+					glm::vec3 viewPoint = glm::vec3(point) / point.w;
+
+					clusterMin = glm::min(clusterMin, viewPoint);
+					clusterMax = glm::max(clusterMax, viewPoint);
+				}
+
+				int index = getClusterIndex(x, y, z);
+				mClusterMins[index] = clusterMin;
+				mClusterMaxs[index] = clusterMax;
+			}
+		}
+	}
+}
+
+// Depth is the distance in front of the camera
+int LightClusterGrid::getSlice(float depth) const
+{
+	if(depth <= mNearDistance)
+		return 0;
+
+	glm::vec4 depthScale = getDepthScale();
+	int slice = static_cast<int>(std::floor(std::log(depth) * depthScale.x + depthScale.y));
+
+	return glm::clamp(slice, 0, LIGHT_CLUSTER_GRID_Z - 1);
+}
+
+// Finds which clusters the light's bounding box touches on screen and in depth
+void LightClusterGrid::findLightBounds(const FrameLight& light, const glm::mat4& viewMatrix, LightBounds& bounds) const
+{
+	glm::vec3 center = glm::vec3(viewMatrix * glm::vec4(glm::vec3(light.position), 1.0f));
+	float radius = light.specularColor.w;
+
+	bounds.sphere = glm::vec4(center, radius);
+	bounds.minX = 1; // Out of view until proven otherwise
+	bounds.maxX = 0;
+
+	// The camera looks down -z
+	float minDepth = -center.z - radius;
+	float maxDepth = -center.z + radius;
+
+	if(maxDepth < mNearDistance || minDepth > mFarDistance)
+		return;
+
+	minDepth = std::max(minDepth, mNearDistance); // So every corner is in front of the camera
+	maxDepth = std::min(maxDepth, mFarDistance);
+
+	// The projection of a box is inside of the projection of its corners
+	glm::vec2 ndcMin(FLT_MAX);
+	glm::vec2 ndcMax(-FLT_MAX);
+
+	for(int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 viewCorner(center.x + ((corner & 1) ? radius : -radius),
+			center.y + ((corner & 2) ? radius : -radius),
+			(corner & 4) ? -maxDepth : -minDepth,
+			1.0f);
+
+		glm::vec4 clip = mProjectionMatrix * viewCorner;
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+
+		ndcMin = glm::min(ndcMin, ndc);
+		ndcMax = glm::max(ndcMax, ndc);
+	}
+
+	if(ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+		return;
+
+	// NDC to tiles
+	glm::vec2 tileCount(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y);
+	glm::vec2 minTile = glm::floor((ndcMin * 0.5f + 0.5f) * tileCount);
+	glm::vec2 maxTile = glm::floor((ndcMax * 0.5f + 0.5f) * tileCount);
+
+	bounds.minX = glm::clamp(static_cast<int>(minTile.x), 0, LIGHT_CLUSTER_GRID_X - 1);
+	bounds.maxX = glm::clamp(static_cast<int>(maxTile.x), 0, LIGHT_CLUSTER_GRID_X - 1);
+	bounds.minY = glm::clamp(static_cast<int>(minTile.y), 0, LIGHT_CLUSTER_GRID_Y - 1);
+	bounds.maxY = glm::clamp(static_cast<int>(maxTile.y), 0, LIGHT_CLUSTER_GRID_Y - 1);
+	bounds.minZ = getSlice(minDepth);
+	bounds.maxZ = getSlice(maxDepth);
+}
+
+// Lists the lights of every cluster of a slice in mSliceLightIndices, with offsets from the start of the slice.
+// Slices don't share anything, so they can be filled at the same time.
+// candidates is temporary room for the lights reaching the slice, as many as there are lights.
+void LightClusterGrid::fillSlice(int z, GLushort* candidates)
+{
+	lightIndexVector& sliceLightIndices = mSliceLightIndices[z];
+	sliceLightIndices.clear();
+
+	std::size_t candidateCount = 0;
+
+	for(std::size_t i = 0; i < mLightBounds.size(); i++)
+	{
+		const LightBounds& bounds = mLightBounds[i];
+
+		if(bounds.minX <= bounds.maxX && bounds.minZ <= z && z <= bounds.maxZ)
+			candidates[candidateCount++] = static_cast<GLushort>(i);
+	}
+
+	for(int y = 0; y < LIGHT_CLUSTER_GRID_Y; y++)
+	{
+		for(int x = 0; x < LIGHT_CLUSTER_GRID_X; x++)
+		{
+			int index = getClusterIndex(x, y, z);
+			Cluster& cluster = mClusters[index];
+			cluster.offset = static_cast<GLuint>(sliceLightIndices.size());
+
+			for(std::size_t i = 0; i < candidateCount; i++)
+			{
+				GLushort lightIndex = candidates[i];
+				const LightBounds& bounds = mLightBounds[lightIndex];
+
+				if(x < bounds.minX || x > bounds.maxX || y < bounds.minY || y > bounds.maxY)
+					continue;
+
+				// Sphere against the cluster's box
+				glm::vec3 center = glm::vec3(bounds.sphere);
+				glm::vec3 closest = glm::clamp(center, mClusterMins[index], mClusterMaxs[index]);
+				glm::vec3 difference = closest - center;
+
+				if(glm::dot(difference, difference) <= bounds.sphere.w * bounds.sphere.w)
+					sliceLightIndices.push_back(lightIndex);
+			}
+
+			cluster.count = static_cast<GLuint>(sliceLightIndices.size()) - cluster.offset;
+		}
+	}
+}
+
+// PUBLIC
+
+// Lights past LIGHT_CLUSTER_MAX_LIGHTS are ignored, and crowded clusters lose lights past maxLightIndices
+// (see RenderQueue::getMaxLightIndices()). Without a job system, everything is done on this thread.
+void LightClusterGrid::build(const std::vector<FrameLight>& lights, const glm::mat4& viewMatrix,
+	const glm::mat4& projectionMatrix, std::size_t maxLightIndices, JobSystem* jobSystem)
+{
+	if(projectionMatrix != mProjectionMatrix)
+		setProjectionMatrix(projectionMatrix);
+
+	std::size_t lightCount = std::min(lights.size(), static_cast<std::size_t>(LIGHT_CLUSTER_MAX_LIGHTS));
+	mLightBounds.resize(lightCount);
+
+	auto boundsFunction = [&](std::size_t begin, std::size_t end)
+	{
+		for(std::size_t i = begin; i < end; i++)
+			findLightBounds(lights[i], viewMatrix, mLightBounds[i]);
+	};
+
+	// Jobs take their candidates from their thread's scratch allocator, freed at the end of the frame
+	auto sliceFunction = [this, jobSystem](std::size_t begin, std::size_t end)
+	{
+		GLushort* candidates = jobSystem
+			? jobSystem->getScratchAllocator().allocateArray<GLushort>(mLightBounds.size())
+			: mCandidates.data();
+
+		for(std::size_t z = begin; z < end; z++)
+			fillSlice(static_cast<int>(z), candidates);
+	};
+
+	if(!jobSystem)
+		mCandidates.resize(lightCount);
+
+	if(jobSystem)
+	{
+		jobSystem->parallelFor(lightCount, 0, boundsFunction);
+		jobSystem->parallelFor(LIGHT_CLUSTER_GRID_Z, 1, sliceFunction);
+	} else
+	{
+		boundsFunction(0, lightCount);
+		sliceFunction(0, LIGHT_CLUSTER_GRID_Z);
+	}
+
+	// Put the slices one after the other. Past maxLightIndices, the last clusters lose lights.
+	mLightIndices.clear();
+
+	for(int z = 0; z < LIGHT_CLUSTER_GRID_Z; z++)
+	{
+		const lightIndexVector& sliceLightIndices = mSliceLightIndices[z];
+
+		std::size_t sliceStart = mLightIndices.size();
+		std::size_t room = maxLightIndices - sliceStart;
+		std::size_t copied = std::min(sliceLightIndices.size(), room);
+
+		mLightIndices.insert(mLightIndices.end(), sliceLightIndices.begin(), sliceLightIndices.begin() + copied);
+
+		int firstCluster = getClusterIndex(0, 0, z);
+		for(int i = firstCluster; i < firstCluster + LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y; i++)
+		{
+			Cluster& cluster = mClusters[i];
+			GLuint end = std::min(cluster.offset + cluster.count, static_cast<GLuint>(copied));
+
+			cluster.offset = std::min(cluster.offset, end);
+			cluster.count = end - cluster.offset;
+			cluster.offset += static_cast<GLuint>(sliceStart);
+		}
+	}
+}
+
+// No lights anywhere
+void LightClusterGrid::clear()
+{
+	mLightIndices.clear();
+	std::fill(mClusters.begin(), mClusters.end(), Cluster{0, 0});
+}
+
+// The slice of a depth is log(depth) * x + y, shaders get this in FrameData.
+// z and w are unused.
+glm::vec4 LightClusterGrid::getDepthScale() const
+{
+	float scale = LIGHT_CLUSTER_GRID_Z / std::log(mFarDistance / mNearDistance);
+	return glm::vec4(scale, -std::log(mNearDistance) * scale, 0.0f, 0.0f);
+}
+
+const LightClusterGrid::clusterVector& LightClusterGrid::getClusters() const
+{
+	return mClusters;
+}
+
+const LightClusterGrid::lightIndexVector& LightClusterGrid::getLightIndices() const
+{
+	return mLightIndices;
+}
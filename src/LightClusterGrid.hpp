@@ -0,0 +1,101 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// Splits the camera's view volume in clusters (tiles on the screen, cut in slices getting exponentially
+// thicker with depth) and lists the lights reaching each of them. Fragment shaders find their cluster
+// and only loop over those lights, so shading costs depend on how many lights are around, not on how many there are.
+// Built on the CPU when filling a snapshot (with jobs, one slice per job), RenderQueue uploads it as texture buffers.
+// Cameras are always perspective, other projections get a made up depth range.
+
+#ifndef LIGHT_CLUSTER_GRID_HPP
+#define LIGHT_CLUSTER_GRID_HPP
+
+#include <Definitions.hpp>
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstddef> // For std::size_t
+
+class JobSystem;
+
+// A light of the frame, as shaders read it from the "lightData" texture buffer (3 texels per light)
+struct FrameLight
+{
+	glm::vec4 position; // World space (pixels), power in w (scaled for distances in pixels)
+	glm::vec4 diffuseColor; // On state in w, 1 or 0
+	glm::vec4 specularColor; // Range in w (pixels), past it the light is ignored
+};
+
+class LightClusterGrid
+{
+public:
+	// Where the lights of a cluster are in the light index list, 2 texels of "lightClusters"
+	struct Cluster
+	{
+		GLuint offset;
+		GLuint count;
+	};
+
+	using clusterVector = std::vector<Cluster>;
+	using lightIndexVector = std::vector<GLushort>;
+
+private:
+	// The clusters a light can reach, from its view space bounding box
+	struct LightBounds
+	{
+		glm::vec4 sphere; // View space
+		int minX, maxX, minY, maxY, minZ, maxZ; // Inclusive, minX > maxX if it's out of view
+	};
+
+	glm::mat4 mProjectionMatrix; // The cluster boxes were made for this one
+	float mNearDistance;
+	float mFarDistance;
+	std::vector<glm::vec3> mClusterMins; // View space box of each cluster
+	std::vector<glm::vec3> mClusterMaxs;
+
+	std::vector<LightBounds> mLightBounds;
+	std::vector<lightIndexVector> mSliceLightIndices; // Filled by each slice's job, then put together
+	lightIndexVector mCandidates; // Lights reaching the slice being filled, without a job system (jobs use scratch memory)
+
+	clusterVector mClusters;
+	lightIndexVector mLightIndices;
+
+	static int getClusterIndex(int x, int y, int z);
+
+	void setProjectionMatrix(const glm::mat4& projectionMatrix);
+	int getSlice(float depth) const;
+	void findLightBounds(const FrameLight& light, const glm::mat4& viewMatrix, LightBounds& bounds) const;
+	void fillSlice(int z, GLushort* candidates);
+
+public:
+	LightClusterGrid();
+	~LightClusterGrid();
+
+	void build(const std::vector<FrameLight>& lights, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		std::size_t maxLightIndices, JobSystem* jobSystem);
+	void clear();
+
+	glm::vec4 getDepthScale() const;
+	const clusterVector& getClusters() const;
+	const lightIndexVector& getLightIndices() const;
+};
+
+#endif /* LIGHT_CLUSTER_GRID_HPP */
@@ -0,0 +1,407 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <MeshSimplifier.hpp>
+
+#include <algorithm> // For std::sort and std::max
+#include <numeric> // For std::iota
+#include <cmath> // For std::sqrt
+#include <cstdint> // For std::uint64_t
+
+// Quadric
+
+void MeshSimplifier::Quadric::addPlane(const glm::dvec4& plane, double planeWeight)
+{
+	double a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+
+	matrix[0] += planeWeight * a * a;
+	matrix[1] += planeWeight * a * b;
+	matrix[2] += planeWeight * a * c;
+	matrix[3] += planeWeight * a * d;
+	matrix[4] += planeWeight * b * b;
+	matrix[5] += planeWeight * b * c;
+	matrix[6] += planeWeight * b * d;
+	matrix[7] += planeWeight * c * c;
+	matrix[8] += planeWeight * c * d;
+	matrix[9] += planeWeight * d * d;
+
+	weight += planeWeight;
+}
+
+void MeshSimplifier::Quadric::add(const Quadric& other)
+{
+	for(int i = 0; i < 10; i++)
+		matrix[i] += other.matrix[i];
+
+	weight += other.weight;
+}
+
+double MeshSimplifier::Quadric::evaluate(const glm::vec3& position) const
+{
+	if(weight <= 0.0)
+		return 0.0;
+
+	double x = position.x, y = position.y, z = position.z;
+
+	double error = matrix[0] * x * x + 2.0 * matrix[1] * x * y + 2.0 * matrix[2] * x * z + 2.0 * matrix[3] * x
+		+ matrix[4] * y * y + 2.0 * matrix[5] * y * z + 2.0 * matrix[6] * y
+		+ matrix[7] * z * z + 2.0 * matrix[8] * z
+		+ matrix[9];
+
+	return std::max(error, 0.0) / weight; // Rounding can make it a bit negative
+}
+
+// MeshSimplifier
+
+MeshSimplifier::MeshSimplifier(const ObjectGeometry::uintVector& indices, const ObjectGeometry::vertexVector& vertices)
+	: mIndices(indices), mVertices(vertices)
+{
+	mError = 0.0f;
+
+	computeQuadrics();
+	lockBorders();
+}
+
+MeshSimplifier::~MeshSimplifier()
+{
+	// Do nothing
+}
+
+// Private
+void MeshSimplifier::computeQuadrics()
+{
+	Quadric empty = {{0.0}, 0.0};
+	mQuadrics.assign(mVertices.size(), empty);
+
+	for(std::size_t i = 0; i + 2 < mIndices.size(); i += 3)
+	{
+		glm::dvec3 a(mVertices[mIndices[i]].position);
+		glm::dvec3 b(mVertices[mIndices[i + 1]].position);
+		glm::dvec3 c(mVertices[mIndices[i + 2]].position);
+
+		glm::dvec3 normal = glm::cross(b - a, c - a);
+		double length = glm::length(normal);
+
+		if(length <= 0.0) // Degenerate, no plane
+			continue;
+
+		normal /= length;
+		glm::dvec4 plane(normal, -glm::dot(normal, a));
+		double area = length * 0.5;
+
+		for(int corner = 0; corner < 3; corner++)
+			mQuadrics[mIndices[i + corner]].addPlane(plane, area);
+	}
+}
+
+// Private
+// Positions are compared exactly, welded meshes only share a position across seams
+void MeshSimplifier::lockBorders()
+{
+	// Number the positions
+	std::vector<unsigned int> order(mVertices.size());
+	std::iota(order.begin(), order.end(), 0u);
+
+	std::sort(order.begin(), order.end(), [this](unsigned int first, unsigned int other)
+	{
+		const glm::vec3& a = mVertices[first].position;
+		const glm::vec3& b = mVertices[other].position;
+
+		if(a.x != b.x)
+			return a.x < b.x;
+		if(a.y != b.y)
+			return a.y < b.y;
+		return a.z < b.z;
+	});
+
+	std::vector<unsigned int> positions(mVertices.size());
+	std::vector<unsigned char> lockedPositions;
+	unsigned int positionCount = 0;
+
+	for(std::size_t i = 0; i < order.size(); i++)
+	{
+		bool samePosition = i > 0 && mVertices[order[i]].position == mVertices[order[i - 1]].position;
+
+		if(samePosition) // Seam
+			lockedPositions.back() = 1;
+		else
+		{
+			positionCount++;
+			lockedPositions.push_back(0);
+		}
+
+		positions[order[i]] = positionCount - 1;
+	}
+
+	// Edges between positions, an edge of a closed surface has exactly 2 triangles
+	std::vector<std::uint64_t> edges;
+	edges.reserve(mIndices.size());
+
+	for(std::size_t i = 0; i + 2 < mIndices.size(); i += 3)
+	{
+		for(int corner = 0; corner < 3; corner++)
+		{
+			std::uint64_t first = positions[mIndices[i + corner]];
+			std::uint64_t other = positions[mIndices[i + (corner + 1) % 3]];
+
+			if(first != other)
+				edges.push_back(std::min(first, other) << 32 | std::max(first, other));
+		}
+	}
+
+	std::sort(edges.begin(), edges.end());
+
+	for(std::size_t i = 0; i < edges.size();)
+	{
+		std::size_t count = 1;
+
+		while(i + count < edges.size() && edges[i + count] == edges[i])
+			count++;
+
+		if(count != 2) // Border or non-manifold
+		{
+			lockedPositions[edges[i] >> 32] = 1;
+			lockedPositions[edges[i] & 0xFFFFFFFF] = 1;
+		}
+
+		i += count;
+	}
+
+	mLocked.resize(mVertices.size());
+
+	for(std::size_t i = 0; i < mVertices.size(); i++)
+		mLocked[i] = lockedPositions[positions[i]];
+}
+
+// Private
+void MeshSimplifier::buildAdjacency()
+{
+	mTriangleOffsets.assign(mVertices.size() + 1, 0);
+
+	for(unsigned int index : mIndices)
+		mTriangleOffsets[index + 1]++;
+
+	for(std::size_t i = 0; i < mVertices.size(); i++)
+		mTriangleOffsets[i + 1] += mTriangleOffsets[i];
+
+	mVertexTriangles.resize(mIndices.size());
+	std::vector<unsigned int> filled(mTriangleOffsets.begin(), mTriangleOffsets.end() - 1);
+
+	for(std::size_t i = 0; i < mIndices.size(); i++)
+		mVertexTriangles[filled[mIndices[i]]++] = static_cast<unsigned int>(i / 3);
+}
+
+// Private
+// Both must be untouched in this pass, so their adjacency is right
+bool MeshSimplifier::canCollapse(unsigned int from, unsigned int to) const
+{
+	if(glm::dot(mVertices[from].normal, mVertices[to].normal) < OBJECT_GEOMETRY_LOD_MIN_NORMAL_DOT)
+		return false;
+
+	const glm::vec3& target = mVertices[to].position;
+	std::vector<unsigned int> neighbours; // Of from, except to
+	int sharedTriangles = 0;
+
+	for(unsigned int i = mTriangleOffsets[from]; i < mTriangleOffsets[from + 1]; i++)
+	{
+		const unsigned int* triangle = &mIndices[mVertexTriangles[i] * 3];
+
+		for(int corner = 0; corner < 3; corner++)
+		{
+			if(triangle[corner] != from && triangle[corner] != to)
+				neighbours.push_back(triangle[corner]);
+		}
+
+		if(triangle[0] == to || triangle[1] == to || triangle[2] == to) // Goes away
+		{
+			sharedTriangles++;
+			continue;
+		}
+
+		glm::vec3 before[3], after[3];
+
+		for(int corner = 0; corner < 3; corner++)
+		{
+			before[corner] = after[corner] = mVertices[triangle[corner]].position;
+
+			if(triangle[corner] == from)
+				after[corner] = target;
+		}
+
+		glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+		glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+		// Turned too much (or flipped, or degenerate). Small turns add up over many collapses, so a quarter turn is too much.
+		if(glm::dot(normalBefore, normalAfter)
+			<= OBJECT_GEOMETRY_LOD_MIN_NORMAL_DOT * glm::length(normalBefore) * glm::length(normalAfter))
+			return false;
+	}
+
+	if(sharedTriangles != 2) // Not an edge inside the surface
+		return false;
+
+	// The edge's 2 opposite vertices must be the only neighbours from and to share, or the surface folds on itself
+	std::sort(neighbours.begin(), neighbours.end());
+	neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+	std::vector<unsigned int> sharedNeighbours;
+
+	for(unsigned int i = mTriangleOffsets[to]; i < mTriangleOffsets[to + 1]; i++)
+	{
+		const unsigned int* triangle = &mIndices[mVertexTriangles[i] * 3];
+
+		for(int corner = 0; corner < 3; corner++)
+		{
+			unsigned int vertex = triangle[corner];
+
+			if(vertex != to && vertex != from && std::binary_search(neighbours.begin(), neighbours.end(), vertex))
+				sharedNeighbours.push_back(vertex);
+		}
+	}
+
+	std::sort(sharedNeighbours.begin(), sharedNeighbours.end());
+	return std::unique(sharedNeighbours.begin(), sharedNeighbours.end()) - sharedNeighbours.begin() == 2;
+}
+
+// Private
+// Collapses the cheapest edges first, at most one per neighbourhood. Returns how many were collapsed.
+std::size_t MeshSimplifier::collapsePass(std::size_t targetIndexCount, float maxError)
+{
+	buildAdjacency();
+	mCollapses.clear();
+
+	for(std::size_t i = 0; i < mIndices.size(); i += 3)
+	{
+		for(int corner = 0; corner < 3; corner++)
+		{
+			unsigned int first = mIndices[i + corner];
+			unsigned int other = mIndices[i + (corner + 1) % 3];
+			unsigned int ends[2][2] = {{first, other}, {other, first}};
+
+			for(auto &end : ends)
+			{
+				if(mLocked[end[0]])
+					continue;
+
+				Quadric quadric = mQuadrics[end[0]];
+				quadric.add(mQuadrics[end[1]]);
+
+				Collapse collapse = {quadric.evaluate(mVertices[end[1]].position), end[0], end[1]};
+				mCollapses.push_back(collapse);
+			}
+		}
+	}
+
+	std::sort(mCollapses.begin(), mCollapses.end(), [](const Collapse& first, const Collapse& other)
+	{
+		return first.cost < other.cost;
+	});
+
+	mTouched.assign(mVertices.size(), 0);
+	mRemap.resize(mVertices.size());
+	std::iota(mRemap.begin(), mRemap.end(), 0u);
+
+	std::size_t indexCount = mIndices.size();
+	std::size_t collapseCount = 0;
+
+	double maxCost = static_cast<double>(maxError) * maxError;
+
+	for(const auto &collapse : mCollapses)
+	{
+		if(indexCount <= targetIndexCount || collapse.cost > maxCost) // Sorted, the rest costs more
+			break;
+
+		if(mTouched[collapse.from] || mTouched[collapse.to] || !canCollapse(collapse.from, collapse.to))
+			continue;
+
+		mRemap[collapse.from] = collapse.to;
+		mQuadrics[collapse.to].add(mQuadrics[collapse.from]);
+		mError = std::max(mError, static_cast<float>(std::sqrt(collapse.cost)));
+
+		for(unsigned int i = mTriangleOffsets[collapse.from]; i < mTriangleOffsets[collapse.from + 1]; i++)
+		{
+			const unsigned int* triangle = &mIndices[mVertexTriangles[i] * 3];
+			mTouched[triangle[0]] = mTouched[triangle[1]] = mTouched[triangle[2]] = 1;
+		}
+
+		indexCount -= 2 * 3; // The 2 triangles of the edge
+		collapseCount++;
+	}
+
+	// Point to where vertices went and drop the triangles that collapsed
+	std::size_t kept = 0;
+
+	for(std::size_t i = 0; i < mIndices.size(); i += 3)
+	{
+		unsigned int a = mRemap[mIndices[i]], b = mRemap[mIndices[i + 1]], c = mRemap[mIndices[i + 2]];
+
+		if(a == b || b == c || a == c)
+			continue;
+
+		mIndices[kept++] = a;
+		mIndices[kept++] = b;
+		mIndices[kept++] = c;
+	}
+
+	mIndices.resize(kept);
+	return collapseCount;
+}
+
+// Collapses edges until there are targetIndexCount indices or less, or nothing can be collapsed without
+// moving further than maxError from the surface (see getError()). Can be called again with a smaller target.
+// Returns the index count.
+std::size_t MeshSimplifier::simplify(std::size_t targetIndexCount, float maxError)
+{
+	while(mIndices.size() > targetIndexCount)
+	{
+		if(collapsePass(targetIndexCount, maxError) == 0)
+			break;
+	}
+
+	return mIndices.size();
+}
+
+// Worst collapse so far, as a distance in model space (the root of its mean squared distance to the original planes)
+float MeshSimplifier::getError() const
+{
+	return mError;
+}
+
+// Only the vertices still used, in the order triangles use them
+void MeshSimplifier::getResult(ObjectGeometry::uintVector& indices, ObjectGeometry::vertexVector& vertices) const
+{
+	const unsigned int unused = static_cast<unsigned int>(-1);
+	std::vector<unsigned int> newIndices(mVertices.size(), unused);
+
+	indices.clear();
+	vertices.clear();
+	indices.reserve(mIndices.size());
+
+	for(unsigned int index : mIndices)
+	{
+		if(newIndices[index] == unused)
+		{
+			newIndices[index] = static_cast<unsigned int>(vertices.size());
+			vertices.push_back(mVertices[index]);
+		}
+
+		indices.push_back(newIndices[index]);
+	}
+}
@@ -0,0 +1,92 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Simplifies triangle meshes by collapsing edges, cheapest first, following quadric error metrics
+// (Garland and Heckbert): every vertex sums the planes of its triangles, and moving it costs its squared distance to them.
+// A collapse moves a vertex onto a neighbour, so no vertex is ever made up and UVs and normals stay exact.
+// Vertices on borders and UV or normal seams (a position shared by vertices with other UVs or normals) never move,
+// so seams stay closed and textures don't slide. Collapses flipping a triangle or joining vertices with normals
+// too far apart (OBJECT_GEOMETRY_LOD_MIN_NORMAL_DOT) are skipped.
+// Doesn't touch OpenGL, safe to use from jobs. See ObjectGeometryGroup::generateLODs().
+
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include <ObjectGeometry.hpp>
+#include <Definitions.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstddef> // For std::size_t
+
+class MeshSimplifier
+{
+private:
+	// Sum of the squared distances to planes, weighted by the area of their triangles
+	struct Quadric
+	{
+		double matrix[10]; // Upper half of the symmetric 4x4 matrix: xx xy xz xw yy yz yw zz zw ww
+		double weight;
+
+		void addPlane(const glm::dvec4& plane, double planeWeight);
+		void add(const Quadric& other);
+		double evaluate(const glm::vec3& position) const; // Mean squared distance
+	};
+
+	// Moves "from" onto "to"
+	struct Collapse
+	{
+		double cost;
+		unsigned int from;
+		unsigned int to;
+	};
+
+	ObjectGeometry::uintVector mIndices; // Triangles left
+	ObjectGeometry::vertexVector mVertices; // Never change, collapsed vertices are just not used anymore
+	std::vector<Quadric> mQuadrics;
+	std::vector<unsigned char> mLocked; // Border and seam vertices
+
+	// Triangles using each vertex: the ones of vertex i are mVertexTriangles[mTriangleOffsets[i]] to [mTriangleOffsets[i + 1]]
+	std::vector<unsigned int> mTriangleOffsets;
+	std::vector<unsigned int> mVertexTriangles;
+
+	std::vector<Collapse> mCollapses;
+	std::vector<unsigned char> mTouched; // Vertices around a collapse of the current pass, their adjacency is outdated
+	std::vector<unsigned int> mRemap;
+
+	float mError;
+
+	void computeQuadrics();
+	void lockBorders();
+	void buildAdjacency();
+	bool canCollapse(unsigned int from, unsigned int to) const;
+	std::size_t collapsePass(std::size_t targetIndexCount, float maxError);
+
+public:
+	MeshSimplifier(const ObjectGeometry::uintVector& indices, const ObjectGeometry::vertexVector& vertices);
+	~MeshSimplifier();
+
+	std::size_t simplify(std::size_t targetIndexCount, float maxError);
+	float getError() const;
+	void getResult(ObjectGeometry::uintVector& indices, ObjectGeometry::vertexVector& vertices) const;
+};
+
+#endif /* MESH_SIMPLIFIER_HPP */
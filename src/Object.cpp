@@ -28,6 +28,9 @@
 // - vec3 color
 
 #include <Object.hpp>
+#include <Profiler.hpp>
+#include <GLState.hpp>
+#include <Utils.hpp>
 
 // Objects copy objectGeometry instead of pointing to them, allow you to modify them
 Object::Object(constObjectGeometryPointer objectGeometry, constShaderPointer shaderPointer,
@@ -63,42 +66,71 @@ Object::constShaderPointer Object::getShader() const
 	return mShaderPointer;
 }
 
-// Virtual
+// Renders right away with the current state. Shaders using FrameData get the last one uploaded.
 void Object::render(const Camera& camera)
+{
+	RenderItem renderItem;
+	fillRenderItem(renderItem);
+
+	RenderState renderState;
+	render(renderItem, camera.getViewMatrix(), camera.getProjectionMatrix(), renderState);
+	renderState.reset();
+}
+
+// Virtual
+// Copies what we need to render this object
+void Object::fillRenderItem(RenderItem& renderItem) const
+{
+	renderItem.shader = mShaderPointer;
+	renderItem.objectGeometry = mObjectGeometry;
+	renderItem.modelMatrix = getPhysicsBody().generateModelMatrix();
+	renderItem.staticBody = getPhysicsBody().getType() == PHYSICS_BODY_STATIC;
+}
+
+// Virtual
+void Object::render(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+	RenderState& renderState) const
 {
 	glm::vec3 color(0.5f, 0.5f, 0.5f);
 
-	const ObjectGeometry::uintBuffer& indexBuffer = mObjectGeometry->getIndexBuffer();
-	const ObjectGeometry::vec3Buffer& positionBuffer = mObjectGeometry->getPositionBuffer();
+	const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
 
-	glm::mat4 modelMatrix = getPhysicsBody().generateModelMatrix();
-	glm::mat4 MVP = camera.getProjectionMatrix() * camera.getViewMatrix() * modelMatrix;
+	glm::mat4 MVP = projectionMatrix * viewMatrix * renderItem.modelMatrix * objectGeometry.getPositionDecodeMatrix();
 
-	glUseProgram(mShaderPointer->getID());
-	glUniformMatrix4fv(mShaderPointer->findUniform("MVP"), 1, GL_FALSE, &MVP[0][0]);
-	glUniform3f(mShaderPointer->findUniform("color"), color.r, color.g, color.b);
+	if(renderState.useProgram(renderItem.shader->getID()))
+		GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_COLOR), color); // Same for every object
 
-	glEnableVertexAttribArray(0); // Number to give to OpenGL VertexAttribPointer
-	positionBuffer.bind(GL_ARRAY_BUFFER);
+	GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_MVP), MVP);
 
-	// Give it to the shader. Each time the vertex shader runs, it will get the next element of this buffer.
-	glVertexAttribPointer(
-		0,					// Attribute 0, no particular reason but same as the vertex shader's layout and glEnableVertexAttribArray
-		3,					// Size. Number of values per vertex, must be 1, 2, 3 or 4.
-		GL_FLOAT,			// Type of data (GLfloats)
-		GL_FALSE,			// Normalized?
-		0,					// Stride
-		(void*)0			// Array buffer offset
-	);
+	renderState.useVertexArray(objectGeometry.getVertexArray(OBJECT_GEOMETRY_LAYOUT_POSITION, false));
 
 	// Draw!
 	// Use the index buffer, more efficient!
 	glDrawElements(
 		GL_TRIANGLES,            // Mode
-		indexBuffer.getLength(), // Count
-		GL_UNSIGNED_INT,         // Type
-		(void*)0                 // Element array buffer offset
+		objectGeometry.getIndexCount(), // Count
+		objectGeometry.getIndexType(),  // Type
+		(void*)0                        // Element array buffer offset
 	);
+	Profiler::countDrawCall();
+}
+
+// Virtual
+bool Object::canRenderInstanced() const
+{
+	return false;
+}
 
-	glDisableVertexAttribArray(0);
+// Virtual
+// Only objects with textures and normals can fill the G-buffer
+bool Object::canRenderDeferred() const
+{
+	return false;
+}
+
+// Virtual
+void Object::renderInstanced(const InstanceBatch& instanceBatch, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+	RenderState& renderState) const
+{
+	Utils::WARN("This object type can't be rendered instanced!");
 }
@@ -23,6 +23,8 @@
 #include <Entity.hpp>
 #include <ObjectGeometry.hpp>
 #include <Camera.hpp>
+#include <RenderSnapshot.hpp>
+#include <RenderState.hpp>
 
 #include <glm/glm.hpp>
 #include <glad/glad.h> // OpenGL, rendering and all
@@ -48,7 +50,20 @@ public:
 	void setShader(constShaderPointer shaderPointer);
 	constShaderPointer getShader() const;
 
-	virtual void render(const Camera& camera); // Override this if you need to!
+	void render(const Camera& camera);
+
+	// Override these if you need to! Rendering only uses the item, so it can happen while the object is being stepped.
+	// Go through renderState for programs, textures and attributes, it skips what the last item already set.
+	virtual void fillRenderItem(RenderItem& renderItem) const;
+	virtual void render(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		RenderState& renderState) const;
+
+	// Override both to draw many objects of your type at once
+	virtual bool canRenderInstanced() const;
+	// With the deferred rendering path, these are drawn with the G-buffer shader instead of theirs (see DeferredRenderer)
+	virtual bool canRenderDeferred() const;
+	virtual void renderInstanced(const InstanceBatch& instanceBatch, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		RenderState& renderState) const;
 };
 
 #endif /* OBJECT_HPP */
\ No newline at end of file
@@ -17,27 +17,427 @@
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
+
 #include <ObjectGeometry.hpp>
 #include <Utils.hpp> // For vector stuff and error messages
+#include <Graphics.hpp>
+#include <GLState.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp> // For half floats and 10-bit normals
+
+#include <unordered_map>
+#include <algorithm> // For std::max and std::max_element
+#include <cmath> // For std::abs and std::sqrt
+#include <cstdint>
+#include <cstring> // For memcmp
+#include <cstddef> // For offsetof
 
 // ObjectGeometry
 
+const ObjectGeometry::VertexAttribute ObjectGeometry::mVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_COUNT] =
+{
+	{3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position)}, // OBJECT_GEOMETRY_ATTRIBUTE_POSITION
+	{2, GL_FLOAT, GL_FALSE, offsetof(Vertex, UV)},       // OBJECT_GEOMETRY_ATTRIBUTE_UV
+	{3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal)}    // OBJECT_GEOMETRY_ATTRIBUTE_NORMAL
+};
+
+bool ObjectGeometry::mPositionQuantization = false;
+
+ObjectGeometry::ObjectGeometry(const std::string& name, const uintVector& indices, const vertexVector& vertices)
+							   : mIndices(indices),
+							   mIndexBuffer(GL_ELEMENT_ARRAY_BUFFER), // A special type of buffer
+							   mVertices(vertices)
+{
+	mName = name;
+
+	computeBounds();
+	chooseVertexFormat();
+	uploadIndices();
+	uploadVertices();
+
+	createVertexArrays();
+}
+
+// Separate attributes, they are interleaved here
 ObjectGeometry::ObjectGeometry(const std::string& name,
 							   const uintVector& indices, const vec3Vector& positions, const vec2Vector& UVs, const vec3Vector& normals)
-							   : mIndexBuffer(GL_ELEMENT_ARRAY_BUFFER) // A special type of buffer
+							   : ObjectGeometry(name, indices, interleaveVertices(positions, UVs, normals))
 {
-	mName = name;
-	
-	// GL_STATIC_DRAW as a hint to OpenGL that we probably won't change the data
-	mIndexBuffer.setMutableData(indices, GL_STATIC_DRAW);
-	mPositionBuffer.setMutableData(positions, GL_STATIC_DRAW);
-	mUVBuffer.setMutableData(UVs, GL_STATIC_DRAW);
-	mNormalBuffer.setMutableData(normals, GL_STATIC_DRAW);
+	// Do nothing
 }
 
 ObjectGeometry::~ObjectGeometry()
 {
-	// Do nothing
+	if(Graphics::isEnabled())
+		GLState::deleteVertexArrays(OBJECT_GEOMETRY_LAYOUT_COUNT * 2, &mVertexArrays[0][0]);
+}
+
+// Private
+// Box around every vertex, and a sphere around the box's center that fits every vertex.
+// Tighter than a sphere around the box, which matters for long objects.
+void ObjectGeometry::computeBounds()
+{
+	mBoundingBoxMin = mBoundingBoxMax = glm::vec3(0.0f);
+
+	if(!mVertices.empty())
+		mBoundingBoxMin = mBoundingBoxMax = mVertices[0].position;
+
+	for(const auto &vertex : mVertices)
+	{
+		mBoundingBoxMin = glm::min(mBoundingBoxMin, vertex.position);
+		mBoundingBoxMax = glm::max(mBoundingBoxMax, vertex.position);
+	}
+
+	glm::vec3 center = (mBoundingBoxMin + mBoundingBoxMax) * 0.5f;
+	float squaredRadius = 0.0f;
+
+	for(const auto &vertex : mVertices)
+	{
+		glm::vec3 offset = vertex.position - center;
+		squaredRadius = std::max(squaredRadius, glm::dot(offset, offset));
+	}
+
+	mBoundingSphere = glm::vec4(center, std::sqrt(squaredRadius));
+}
+
+// Private
+// Picks the smallest GPU format that holds mVertices well enough. Call computeBounds() first. Positions are only quantized if
+// setPositionQuantization() was turned on; they are then stored relative to the mesh's bounding box,
+// see getPositionDecodeMatrix(). Normals are always 10-bit, since they are normalized in the shaders anyways.
+void ObjectGeometry::chooseVertexFormat()
+{
+	mHalfUVs = true;
+
+	for(const auto &vertex : mVertices)
+	{
+		if(std::abs(vertex.UV.x) > OBJECT_GEOMETRY_HALF_UV_LIMIT || std::abs(vertex.UV.y) > OBJECT_GEOMETRY_HALF_UV_LIMIT)
+			mHalfUVs = false;
+	}
+
+	mQuantizedPositions = mPositionQuantization;
+
+	if(mQuantizedPositions)
+	{
+		mPositionBias = mBoundingBoxMin;
+		mPositionScale = mBoundingBoxMax - mBoundingBoxMin;
+	} else
+	{
+		mPositionBias = glm::vec3(0.0f);
+		mPositionScale = glm::vec3(1.0f);
+	}
+
+	std::size_t offset = 0;
+
+	if(mQuantizedPositions) // 3 normalized shorts, plus 2 bytes so the rest stays aligned
+	{
+		mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_POSITION] = {3, GL_UNSIGNED_SHORT, GL_TRUE, offset};
+		offset += 4 * sizeof(std::uint16_t);
+	} else
+	{
+		mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_POSITION] = {3, GL_FLOAT, GL_FALSE, offset};
+		offset += sizeof(glm::vec3);
+	}
+
+	if(mHalfUVs)
+	{
+		mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_UV] = {2, GL_HALF_FLOAT, GL_FALSE, offset};
+		offset += 2 * sizeof(std::uint16_t);
+	} else
+	{
+		mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_UV] = {2, GL_FLOAT, GL_FALSE, offset};
+		offset += sizeof(glm::vec2);
+	}
+
+	// Packed formats always have 4 values, the shaders ignore w
+	mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_NORMAL] = {4, GL_INT_2_10_10_10_REV, GL_TRUE, offset};
+	offset += sizeof(std::uint32_t);
+
+	mGPUVertexSize = static_cast<GLsizei>(offset);
+}
+
+// Private
+// False if some of these vertices can't be stored in the current format
+bool ObjectGeometry::fitsVertexFormat(std::size_t firstVertex, std::size_t vertexCount) const
+{
+	glm::vec3 maxPosition = mPositionBias + mPositionScale;
+
+	for(std::size_t i = firstVertex; i < firstVertex + vertexCount; i++)
+	{
+		const Vertex& vertex = mVertices[i];
+
+		if(mHalfUVs &&
+			(std::abs(vertex.UV.x) > OBJECT_GEOMETRY_HALF_UV_LIMIT || std::abs(vertex.UV.y) > OBJECT_GEOMETRY_HALF_UV_LIMIT))
+			return false;
+
+		if(mQuantizedPositions &&
+			(glm::any(glm::lessThan(vertex.position, mPositionBias)) || glm::any(glm::greaterThan(vertex.position, maxPosition))))
+			return false;
+	}
+
+	return true;
+}
+
+// Private
+// Packs vertices in the current format
+ObjectGeometry::byteVector ObjectGeometry::encodeVertices(std::size_t firstVertex, std::size_t vertexCount) const
+{
+	byteVector bytes(vertexCount * mGPUVertexSize, 0);
+
+	for(std::size_t i = 0; i < vertexCount; i++)
+	{
+		const Vertex& vertex = mVertices[firstVertex + i];
+		unsigned char* encodedVertex = bytes.data() + i * mGPUVertexSize;
+
+		unsigned char* position = encodedVertex + mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_POSITION].offset;
+		unsigned char* UV = encodedVertex + mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_UV].offset;
+		unsigned char* normal = encodedVertex + mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_NORMAL].offset;
+
+		if(mQuantizedPositions)
+		{
+			std::uint16_t quantizedPosition[3];
+
+			for(int axis = 0; axis < 3; axis++)
+			{
+				// Flat axes only have one value, the bias
+				float scale = mPositionScale[axis];
+				float unitPosition = scale > 0.0f ? (vertex.position[axis] - mPositionBias[axis]) / scale : 0.0f;
+
+				quantizedPosition[axis] = glm::packUnorm1x16(unitPosition);
+			}
+
+			std::memcpy(position, quantizedPosition, sizeof(quantizedPosition));
+		} else
+			std::memcpy(position, &vertex.position, sizeof(glm::vec3));
+
+		if(mHalfUVs)
+		{
+			std::uint16_t halfUV[2] = {glm::packHalf1x16(vertex.UV.x), glm::packHalf1x16(vertex.UV.y)};
+			std::memcpy(UV, halfUV, sizeof(halfUV));
+		} else
+			std::memcpy(UV, &vertex.UV, sizeof(glm::vec2));
+
+		std::uint32_t packedNormal = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f));
+		std::memcpy(normal, &packedNormal, sizeof(packedNormal));
+	}
+
+	return bytes;
+}
+
+// Private
+// 16-bit indices if they fit
+void ObjectGeometry::uploadIndices()
+{
+	unsigned int maxIndex = mIndices.empty() ? 0 : *std::max_element(mIndices.begin(), mIndices.end());
+	byteVector bytes;
+
+	if(maxIndex <= OBJECT_GEOMETRY_SHORT_INDEX_MAX)
+	{
+		mIndexType = GL_UNSIGNED_SHORT;
+		bytes.resize(mIndices.size() * sizeof(std::uint16_t));
+
+		std::uint16_t* shortIndices = reinterpret_cast<std::uint16_t*>(bytes.data());
+
+		for(std::size_t i = 0; i < mIndices.size(); i++)
+			shortIndices[i] = static_cast<std::uint16_t>(mIndices[i]);
+	} else
+	{
+		mIndexType = GL_UNSIGNED_INT;
+		bytes.resize(mIndices.size() * sizeof(unsigned int));
+
+		if(!mIndices.empty())
+			std::memcpy(bytes.data(), mIndices.data(), bytes.size());
+	}
+
+	// GL_STATIC_DRAW as a hint to OpenGL that we probably won't change the data
+	mIndexBuffer.setMutableData(bytes, GL_STATIC_DRAW);
+}
+
+// Private
+void ObjectGeometry::uploadVertices()
+{
+	mVertexBuffer.setMutableData(encodeVertices(0, mVertices.size()), GL_STATIC_DRAW);
+}
+
+// Private
+void ObjectGeometry::createVertexArrays()
+{
+	if(!Graphics::isEnabled())
+	{
+		for(int layout = 0; layout < OBJECT_GEOMETRY_LAYOUT_COUNT; layout++)
+			mVertexArrays[layout][0] = mVertexArrays[layout][1] = 0;
+
+		return;
+	}
+
+	glGenVertexArrays(OBJECT_GEOMETRY_LAYOUT_COUNT * 2, &mVertexArrays[0][0]);
+	setUpVertexArrays();
+}
+
+// Private
+// The buffers are only referenced, so changing their data later is fine. Changing the vertex format isn't,
+// call this again after.
+void ObjectGeometry::setUpVertexArrays()
+{
+	if(!Graphics::isEnabled())
+		return;
+
+	for(int layout = 0; layout < OBJECT_GEOMETRY_LAYOUT_COUNT; layout++)
+	{
+		int attributeCount = layout + 1; // Layouts add one attribute each, see Definitions.hpp
+
+		for(int instanced = 0; instanced < 2; instanced++)
+		{
+			GLState::bindVertexArray(mVertexArrays[layout][instanced]);
+			mIndexBuffer.bind(); // The element buffer is part of the vertex array
+			mVertexBuffer.bind(GL_ARRAY_BUFFER);
+
+			for(int attribute = 0; attribute < attributeCount; attribute++)
+			{
+				const VertexAttribute& vertexAttribute = mGPUVertexLayout[attribute];
+
+				glEnableVertexAttribArray(attribute);
+				glVertexAttribPointer(attribute, vertexAttribute.size, vertexAttribute.type, vertexAttribute.normalized,
+					mGPUVertexSize, reinterpret_cast<void*>(vertexAttribute.offset));
+			}
+
+			// Per instance matrices, one attribute per column. They point to the instance buffer at draw time (RenderState::useInstances()).
+			if(instanced)
+			{
+				for(int i = 0; i < 4; i++)
+				{
+					glEnableVertexAttribArray(RENDER_INSTANCE_ATTRIBUTE_MODEL_MATRIX + i);
+					glVertexAttribDivisor(RENDER_INSTANCE_ATTRIBUTE_MODEL_MATRIX + i, 1); // Next value every instance
+				}
+
+				for(int i = 0; i < 3; i++)
+				{
+					glEnableVertexAttribArray(RENDER_INSTANCE_ATTRIBUTE_NORMAL_MATRIX + i);
+					glVertexAttribDivisor(RENDER_INSTANCE_ATTRIBUTE_NORMAL_MATRIX + i, 1);
+				}
+			}
+		}
+	}
+
+	GLState::bindVertexArray(Graphics::getDefaultVertexArray());
+}
+
+// Private
+// Sends vertices that changed in mVertices to the GPU. If they don't fit in the format anymore,
+// a new one is picked and everything is sent again.
+void ObjectGeometry::updateVertexBuffer(std::size_t firstVertex, std::size_t vertexCount)
+{
+	computeBounds();
+
+	if(!fitsVertexFormat(firstVertex, vertexCount))
+	{
+		chooseVertexFormat();
+		uploadVertices();
+		setUpVertexArrays();
+		return;
+	}
+
+	mVertexBuffer.modify(firstVertex * mGPUVertexSize, encodeVertices(firstVertex, vertexCount));
+}
+
+// Static
+const ObjectGeometry::VertexAttribute& ObjectGeometry::getVertexAttribute(int attribute)
+{
+	return mVertexLayout[attribute];
+}
+
+// Static
+// Only affects geometry created after this. 16-bit positions are good enough for most models,
+// but big meshes (like terrain) might start to look wobbly.
+void ObjectGeometry::setPositionQuantization(bool enabled)
+{
+	mPositionQuantization = enabled;
+}
+
+// Static
+bool ObjectGeometry::getPositionQuantization()
+{
+	return mPositionQuantization;
+}
+
+// Static
+// All three must have the same size
+ObjectGeometry::vertexVector ObjectGeometry::interleaveVertices(const vec3Vector& positions, const vec2Vector& UVs, const vec3Vector& normals)
+{
+	if(positions.size() != UVs.size() || positions.size() != normals.size())
+	{
+		Utils::CRASH("Vertex data is not coherent! There must be as many positions, UVs and normals.");
+		return vertexVector();
+	}
+
+	vertexVector vertices(positions.size());
+
+	for(std::size_t i = 0; i < vertices.size(); i++)
+	{
+		vertices[i].position = positions[i];
+		vertices[i].UV = UVs[i];
+		vertices[i].normal = normals[i];
+	}
+
+	return vertices;
+}
+
+// Static
+// Merges vertices with the exact same position, UV and normal, and points the indices to what is left.
+// Returns how many vertices were removed. Doesn't touch OpenGL, safe to call from jobs.
+std::size_t ObjectGeometry::weldVertices(uintVector& indices, vertexVector& vertices)
+{
+	// Vertex has no padding, so its bytes are all we need to compare
+	struct VertexHash
+	{
+		std::size_t operator()(const Vertex& vertex) const
+		{
+			// FNV-1a
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+			std::size_t hash = 2166136261u;
+
+			for(std::size_t i = 0; i < sizeof(Vertex); i++)
+				hash = (hash ^ bytes[i]) * 16777619u;
+
+			return hash;
+		}
+	};
+
+	struct VertexEqual
+	{
+		bool operator()(const Vertex& a, const Vertex& b) const
+		{
+			return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> weldedIndices;
+	weldedIndices.reserve(vertices.size());
+
+	uintVector newIndices(vertices.size()); // Old index to new index
+	vertexVector weldedVertices;
+	weldedVertices.reserve(vertices.size());
+
+	for(std::size_t i = 0; i < vertices.size(); i++)
+	{
+		auto inserted = weldedIndices.insert(std::make_pair(vertices[i], static_cast<unsigned int>(weldedVertices.size())));
+
+		if(inserted.second) // First time we see it
+			weldedVertices.push_back(vertices[i]);
+
+		newIndices[i] = inserted.first->second;
+	}
+
+	for(auto &index : indices)
+	{
+		if(index < newIndices.size()) // Bad indices stay bad
+			index = newIndices[index];
+	}
+
+	std::size_t removed = vertices.size() - weldedVertices.size();
+	vertices.swap(weldedVertices);
+
+	return removed;
 }
 
 std::string ObjectGeometry::getName() const
@@ -45,38 +445,170 @@ std::string ObjectGeometry::getName() const
 	return mName;
 }
 
-ObjectGeometry::uintBuffer& ObjectGeometry::getIndexBuffer()
+// Layout is one of OBJECT_GEOMETRY_LAYOUT_*. Instanced ones also take the per instance attributes.
+GLuint ObjectGeometry::getVertexArray(int layout, bool instanced) const
+{
+	return mVertexArrays[layout][instanced ? 1 : 0];
+}
+
+// Can change the index type
+void ObjectGeometry::setIndices(const uintVector& indices)
+{
+	mIndices = indices;
+	uploadIndices();
+}
+
+const ObjectGeometry::uintVector& ObjectGeometry::getIndices() const
+{
+	return mIndices;
+}
+
+GLsizei ObjectGeometry::getIndexCount() const
+{
+	return static_cast<GLsizei>(mIndices.size());
+}
+
+// For glDrawElements()
+GLenum ObjectGeometry::getIndexType() const
+{
+	return mIndexType;
+}
+
+GLuint ObjectGeometry::getIndexBufferID() const
+{
+	return mIndexBuffer.getID();
+}
+
+const ObjectGeometry::vertexVector& ObjectGeometry::getVertices() const
+{
+	return mVertices;
+}
+
+const ObjectGeometry::byteBuffer& ObjectGeometry::getVertexBuffer() const
+{
+	return mVertexBuffer;
+}
+
+// Where an attribute is in the vertex buffer
+const ObjectGeometry::VertexAttribute& ObjectGeometry::getGPUVertexAttribute(int attribute) const
+{
+	return mGPUVertexLayout[attribute];
+}
+
+GLsizei ObjectGeometry::getGPUVertexSize() const
 {
-	return mIndexBuffer;
+	return mGPUVertexSize;
 }
-const ObjectGeometry::uintBuffer& ObjectGeometry::getIndexBuffer() const
+
+// Turns positions from the vertex buffer back into model space. Multiply the model matrix by this.
+// Identity if positions aren't quantized.
+glm::mat4 ObjectGeometry::getPositionDecodeMatrix() const
 {
-	return mIndexBuffer;
+	if(!mQuantizedPositions)
+		return glm::mat4(1.0f);
+
+	return glm::scale(glm::translate(glm::mat4(1.0f), mPositionBias), mPositionScale);
 }
 
-ObjectGeometry::vec3Buffer& ObjectGeometry::getPositionBuffer()
+ObjectGeometry::vec3View ObjectGeometry::getPositionBuffer()
 {
-	return mPositionBuffer;
+	return vec3View(this, OBJECT_GEOMETRY_ATTRIBUTE_POSITION);
 }
-const ObjectGeometry::vec3Buffer& ObjectGeometry::getPositionBuffer() const
+const ObjectGeometry::vec3View ObjectGeometry::getPositionBuffer() const
 {
-	return mPositionBuffer;
+	return vec3View(this, OBJECT_GEOMETRY_ATTRIBUTE_POSITION);
 }
 
-ObjectGeometry::vec2Buffer& ObjectGeometry::getUVBuffer()
+ObjectGeometry::vec2View ObjectGeometry::getUVBuffer()
 {
-	return mUVBuffer;
+	return vec2View(this, OBJECT_GEOMETRY_ATTRIBUTE_UV);
 }
-const ObjectGeometry::vec2Buffer& ObjectGeometry::getUVBuffer() const
+const ObjectGeometry::vec2View ObjectGeometry::getUVBuffer() const
 {
-	return mUVBuffer;
+	return vec2View(this, OBJECT_GEOMETRY_ATTRIBUTE_UV);
 }
 
-ObjectGeometry::vec3Buffer& ObjectGeometry::getNormalBuffer()
+ObjectGeometry::vec3View ObjectGeometry::getNormalBuffer()
 {
-	return mNormalBuffer;
+	return vec3View(this, OBJECT_GEOMETRY_ATTRIBUTE_NORMAL);
 }
-const ObjectGeometry::vec3Buffer& ObjectGeometry::getNormalBuffer() const
+const ObjectGeometry::vec3View ObjectGeometry::getNormalBuffer() const
+{
+	return vec3View(this, OBJECT_GEOMETRY_ATTRIBUTE_NORMAL);
+}
+
+glm::vec3 ObjectGeometry::getBoundingBoxMin() const
 {
-	return mNormalBuffer;
-}
\ No newline at end of file
+	return mBoundingBoxMin;
+}
+
+glm::vec3 ObjectGeometry::getBoundingBoxMax() const
+{
+	return mBoundingBoxMax;
+}
+
+// Center in xyz, radius in w
+const glm::vec4& ObjectGeometry::getBoundingSphere() const
+{
+	return mBoundingSphere;
+}
+
+// The bounding sphere once moved by the model matrix, in world space
+glm::vec4 ObjectGeometry::getBoundingSphere(const glm::mat4& modelMatrix) const
+{
+	// Scaling can be different on each axis, take the biggest
+	float scale = std::sqrt(std::max(std::max(
+		glm::dot(glm::vec3(modelMatrix[0]), glm::vec3(modelMatrix[0])),
+		glm::dot(glm::vec3(modelMatrix[1]), glm::vec3(modelMatrix[1]))),
+		glm::dot(glm::vec3(modelMatrix[2]), glm::vec3(modelMatrix[2]))));
+
+	glm::vec4 center = modelMatrix * glm::vec4(glm::vec3(mBoundingSphere), 1.0f);
+	return glm::vec4(glm::vec3(center), mBoundingSphere.w * scale);
+}
+
+glm::vec3 ObjectGeometry::getBoundingSphereCenter() const
+{
+	return glm::vec3(mBoundingSphere);
+}
+
+float ObjectGeometry::getBoundingSphereRadius() const
+{
+	return mBoundingSphere.w;
+}
+
+// Levels are added in order, each one coarser than the last, with a larger error. See ObjectGeometryGroup::generateLODs().
+void ObjectGeometry::addLOD(constObjectGeometryPointer objectGeometry, float error)
+{
+	LOD lod = {objectGeometry, error};
+	mLODs.push_back(lod);
+}
+
+// Including this one, level 0
+int ObjectGeometry::getLODCount() const
+{
+	return static_cast<int>(mLODs.size()) + 1;
+}
+
+// From 1 to getLODCount() - 1
+const ObjectGeometry::constObjectGeometryPointer& ObjectGeometry::getLOD(int level) const
+{
+	return mLODs[level - 1].objectGeometry;
+}
+
+float ObjectGeometry::getLODError(int level) const
+{
+	return level == 0 ? 0.0f : mLODs[level - 1].error;
+}
+
+// Picks the coarsest level whose error would cover less than OBJECT_GEOMETRY_LOD_MAX_SCREEN_ERROR of the screen's height.
+// screenScale is how much of the screen's height one model space unit covers where the geometry is.
+int ObjectGeometry::selectLOD(float screenScale) const
+{
+	for(int level = static_cast<int>(mLODs.size()); level > 0; level--)
+	{
+		if(mLODs[level - 1].error * screenScale <= OBJECT_GEOMETRY_LOD_MAX_SCREEN_ERROR)
+			return level;
+	}
+
+	return 0;
+}
@@ -17,7 +17,12 @@
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
+
 // This class holds the vertex data. Use this class as a member for other 3D objects.
+// Vertices are interleaved in one buffer (see Vertex), with a copy kept on the CPU.
+// On the GPU, vertices and indices are packed as small as they can be without losing much: half float UVs,
+// 10-bit normals, optionally 16-bit positions and 16-bit indices. See chooseVertexFormat().
+// Geometries can have simplified versions of themselves for when they are far, see addLOD() and selectLOD().
 
 #ifndef OBJECT_GEOMETRY_HPP
 #define OBJECT_GEOMETRY_HPP
@@ -26,51 +31,153 @@
 
 #include <string>
 #include <vector>
+#include <cstddef> // For std::size_t
 #include <glm/glm.hpp>
 
 #include <Shader.hpp>
 #include <GPUBuffer.hpp>
+#include <VertexAttributeView.hpp>
+#include <Definitions.hpp>
 
 class ObjectGeometry
 {
 public:
-	using uintBuffer = GPUBuffer<unsigned int>;
-	using vec2Buffer = GPUBuffer<glm::vec2>;
-	using vec3Buffer = GPUBuffer<glm::vec3>;
+	// Interleaved, so a vertex is read from one spot
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec2 UV;
+		glm::vec3 normal;
+	};
+
+	// Where an attribute is in a vertex, for glVertexAttribPointer
+	struct VertexAttribute
+	{
+		GLint size; // Number of values
+		GLenum type;
+		GLboolean normalized;
+		std::size_t offset; // In the vertex, in bytes
+	};
+
+	using byteBuffer = GPUBuffer<unsigned char>; // Holds whatever format we picked
+
+	using vec2View = VertexAttributeView<glm::vec2>;
+	using vec3View = VertexAttributeView<glm::vec3>;
 
 	using uintVector = std::vector<unsigned int>;
 	using vec2Vector = std::vector<glm::vec2>;
 	using vec3Vector = std::vector<glm::vec3>;
+	using vertexVector = std::vector<Vertex>;
+	using byteVector = std::vector<unsigned char>;
+
+	using constObjectGeometryPointer = std::shared_ptr<const ObjectGeometry>;
 
 private:
+	// A simplified version of this geometry
+	struct LOD
+	{
+		constObjectGeometryPointer objectGeometry;
+		float error; // How far its surface can be from ours, in model space
+	};
+
+	template<typename attributeType> friend class VertexAttributeView; // Views read and write mVertices
+
 	using constShaderPointer = std::shared_ptr<const Shader>; // Const shader
 
+	static const VertexAttribute mVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_COUNT]; // In Vertex, indexed by attribute
+	static bool mPositionQuantization;
+
 	std::string mName; // Don't change this stupidly
 
-	uintBuffer mIndexBuffer;
-	vec3Buffer mPositionBuffer;
-	vec2Buffer mUVBuffer;
-	vec3Buffer mNormalBuffer;
+	uintVector mIndices; // What is in mIndexBuffer, as unsigned ints
+	GLenum mIndexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	byteBuffer mIndexBuffer;
+
+	vertexVector mVertices; // What is in mVertexBuffer, unpacked, so reading doesn't need OpenGL
+	byteBuffer mVertexBuffer;
+
+	// The format in mVertexBuffer
+	VertexAttribute mGPUVertexLayout[OBJECT_GEOMETRY_ATTRIBUTE_COUNT];
+	GLsizei mGPUVertexSize; // In bytes
+	bool mQuantizedPositions; // 16-bit, from mPositionBias to mPositionBias + mPositionScale
+	bool mHalfUVs;
+	glm::vec3 mPositionBias;
+	glm::vec3 mPositionScale;
+
+	// Model space bounds, for culling
+	glm::vec3 mBoundingBoxMin;
+	glm::vec3 mBoundingBoxMax;
+	glm::vec4 mBoundingSphere; // Center in xyz, radius in w
+
+	// [layout][instanced], built once so drawing only needs a bind. 0 when graphics are disabled.
+	GLuint mVertexArrays[OBJECT_GEOMETRY_LAYOUT_COUNT][2];
+
+	std::vector<LOD> mLODs; // Level 1 and up, coarser and coarser. Level 0 is this geometry.
+
+	void computeBounds();
+	void chooseVertexFormat();
+	bool fitsVertexFormat(std::size_t firstVertex, std::size_t vertexCount) const;
+	byteVector encodeVertices(std::size_t firstVertex, std::size_t vertexCount) const;
+	void uploadIndices();
+	void uploadVertices();
+
+	void createVertexArrays();
+	void setUpVertexArrays();
+	void updateVertexBuffer(std::size_t firstVertex, std::size_t vertexCount);
 
 public:
+	ObjectGeometry(const std::string& name, const uintVector& indices, const vertexVector& vertices);
 	ObjectGeometry(const std::string& name,
 		const uintVector& indices, const vec3Vector& positions, const vec2Vector& UVs, const vec3Vector& normals);
 	~ObjectGeometry();
 
-	std::string getName() const;
-
-	// Return a const buffer if we need it, could be useful
-	uintBuffer& getIndexBuffer();
-	const uintBuffer& getIndexBuffer() const;
+	// Would share the vertex arrays
+	ObjectGeometry(const ObjectGeometry&) = delete;
+	ObjectGeometry& operator=(const ObjectGeometry&) = delete;
 
-	vec3Buffer& getPositionBuffer();
-	const vec3Buffer& getPositionBuffer() const;
+	static const VertexAttribute& getVertexAttribute(int attribute);
+	static void setPositionQuantization(bool enabled);
+	static bool getPositionQuantization();
+	static vertexVector interleaveVertices(const vec3Vector& positions, const vec2Vector& UVs, const vec3Vector& normals);
+	static std::size_t weldVertices(uintVector& indices, vertexVector& vertices);
 
-	vec2Buffer& getUVBuffer();
-	const vec2Buffer& getUVBuffer() const;
-
-	vec3Buffer& getNormalBuffer();
-	const vec3Buffer& getNormalBuffer() const;
+	std::string getName() const;
+	GLuint getVertexArray(int layout, bool instanced) const;
+
+	void setIndices(const uintVector& indices);
+	const uintVector& getIndices() const;
+	GLsizei getIndexCount() const;
+	GLenum getIndexType() const;
+	GLuint getIndexBufferID() const;
+
+	const vertexVector& getVertices() const;
+	const byteBuffer& getVertexBuffer() const;
+	const VertexAttribute& getGPUVertexAttribute(int attribute) const;
+	GLsizei getGPUVertexSize() const;
+	glm::mat4 getPositionDecodeMatrix() const;
+
+	glm::vec3 getBoundingBoxMin() const;
+	glm::vec3 getBoundingBoxMax() const;
+	const glm::vec4& getBoundingSphere() const;
+	glm::vec4 getBoundingSphere(const glm::mat4& modelMatrix) const;
+	glm::vec3 getBoundingSphereCenter() const;
+	float getBoundingSphereRadius() const;
+
+	void addLOD(constObjectGeometryPointer objectGeometry, float error);
+	int getLODCount() const;
+	const constObjectGeometryPointer& getLOD(int level) const;
+	float getLODError(int level) const;
+	int selectLOD(float screenScale) const;
+
+	// Views, as if every attribute had its own buffer
+	vec3View getPositionBuffer();
+	const vec3View getPositionBuffer() const;
+
+	vec2View getUVBuffer();
+	const vec2View getUVBuffer() const;
+
+	vec3View getNormalBuffer();
+	const vec3View getNormalBuffer() const;
 };
 
-#endif /* OBJECT_GEOMETRY_HPP */
\ No newline at end of file
+#endif /* OBJECT_GEOMETRY_HPP */
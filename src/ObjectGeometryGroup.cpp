@@ -26,6 +26,7 @@
 #include <tiny_obj_loader.h>
 
 #include <Utils.hpp> // For vector stuff and error messages
+#include <MeshSimplifier.hpp>
 #include <ResourceManager.hpp> // For getting the basename of files
 
 ObjectGeometryGroup::ObjectGeometryGroup(const std::string& name)
@@ -54,6 +55,32 @@ std::string ObjectGeometryGroup::getName()
 
 // Loads an .obj file. The objects found will be added to this group.
 bool ObjectGeometryGroup::loadOBJFile(const std::string& OBJfilePath)
+{
+	geometryDataVector geometryData;
+	std::string error;
+	std::vector<std::string> warnings;
+
+	bool success = readOBJFile(OBJfilePath, mName, geometryData, error, warnings);
+
+	for(const auto &warning : warnings)
+		Utils::WARN(warning);
+
+	if(!success)
+	{
+		Utils::CRASH(error);
+		return false;
+	}
+
+	addGeometryData(geometryData);
+	return true;
+}
+
+// Static
+// Reads the geometries of an .obj file, without touching OpenGL. Safe to call from jobs.
+// Nothing is logged: on failure, it returns false with the reason in error, and warnings are added to warnings.
+// Report them from the calling thread. The group name is only used for the messages.
+bool ObjectGeometryGroup::readOBJFile(const std::string& OBJfilePath, const std::string& groupName, geometryDataVector& geometryData,
+	std::string& error, std::vector<std::string>& warnings)
 {
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
@@ -66,7 +93,7 @@ bool ObjectGeometryGroup::loadOBJFile(const std::string& OBJfilePath)
 
 	if(!file)
 	{
-		Utils::CRASH("Object file '" + OBJfilePath + "' could not be opened!");
+		error = "Object file '" + OBJfilePath + "' could not be opened!";
 		return false;
 	}
 
@@ -77,12 +104,12 @@ bool ObjectGeometryGroup::loadOBJFile(const std::string& OBJfilePath)
 	// Failed
 	if(!success)
 	{
-		Utils::LOGPRINT(".obj file '" + OBJfilePath + "' failed to load!");
-		Utils::CRASH("Tinyobjloader message: " + tinyobjError); // The error 'could' be an empty string, just sayin'
+		// The message 'could' be an empty string, just sayin'
+		error = ".obj file '" + OBJfilePath + "' failed to load! Tinyobjloader message: " + tinyobjError;
 		return false;
 	} else if(!tinyobjError.empty()) // Success, but there is a warning
 	{
-		Utils::WARN("Tinyobjloader message: " + tinyobjError); // The file should still load
+		warnings.push_back("Tinyobjloader message: " + tinyobjError); // The file should still load
 	}
 
 	// Loop through all shapes in the file and add them to the group
@@ -95,15 +122,15 @@ bool ObjectGeometryGroup::loadOBJFile(const std::string& OBJfilePath)
 			currentShape.mesh.texcoords.size()%2 != 0 ||
 			currentShape.mesh.normals.size()%3 != 0)
 		{
-			Utils::WARN("OBJ data for geometry '" + currentShape.name + "' in file '" + OBJfilePath +
-				"' for group '" + mName + "' is invalid! Skipping this geometry.");
+			warnings.push_back("OBJ data for geometry '" + currentShape.name + "' in file '" + OBJfilePath +
+				"' for group '" + groupName + "' is invalid! Skipping this geometry.");
 			continue;
 		}
 
 		if(currentShape.mesh.indices.size() % 3 != 0) // Not triangles, but Tinyobjloader should of taken care of this
 		{
-			Utils::WARN("OBJ data for geometry '" + currentShape.name + "' in file '" + OBJfilePath +
-				"' for group '" + mName + "' does not contain triangles! Tinyobjloader should of taken care of this. Bug?" +
+			warnings.push_back("OBJ data for geometry '" + currentShape.name + "' in file '" + OBJfilePath +
+				"' for group '" + groupName + "' does not contain triangles! Tinyobjloader should of taken care of this. Bug?" +
 				" To fix this, open your model in a object modeling software, triangulate the faces and the export it as" + 
 				" .obj (Wavefront).");
 			continue;
@@ -111,47 +138,118 @@ bool ObjectGeometryGroup::loadOBJFile(const std::string& OBJfilePath)
 
 		std::size_t numberOfVertices = currentShape.mesh.positions.size()/3; // Since positions are vec3
 
-		// Create the vectors with the right sizes
-		ObjectGeometry::vec3Vector positions(numberOfVertices);
-		ObjectGeometry::vec2Vector UVcoords(numberOfVertices);
-		ObjectGeometry::vec3Vector normals(numberOfVertices);
-
 		// Final safety check!
 		if(currentShape.mesh.positions.size()/3 != currentShape.mesh.normals.size()/3 ||
 			currentShape.mesh.positions.size()/3 != currentShape.mesh.texcoords.size()/2 ||
 			currentShape.mesh.texcoords.size()/2 != currentShape.mesh.normals.size()/3)
 		{
-			Utils::CRASH("OBJ data for geometry '" + currentShape.name + "' in file '" + OBJfilePath +
-				"' for group '" + mName + "' is not coherent! Did you include normals/texcoords and in the same amount?");
+			error = "OBJ data for geometry '" + currentShape.name + "' in file '" + OBJfilePath +
+				"' for group '" + groupName + "' is not coherent! Did you include normals/texcoords and in the same amount?";
 			return false;
 		}
 
+		geometryData.push_back(GeometryData());
+		GeometryData& currentData = geometryData.back();
+
+		currentData.name = currentShape.name;
+		currentData.indices.swap(currentShape.mesh.indices);
+
+		ObjectGeometry::vertexVector& vertices = currentData.vertices;
+		vertices.resize(numberOfVertices);
+
 		// Copy the data since I couldn't find a way to avoid it
 		// Very annoying to iterate through all vertices, but seems to be the safest
 		for(std::size_t j=0; j<numberOfVertices; j++)
 		{
-			positions[j] = glm::vec3(currentShape.mesh.positions[j*3],            // X
+			vertices[j].position = glm::vec3(currentShape.mesh.positions[j*3],    // X
 										 currentShape.mesh.positions[j*3 + 1],    // Y
 										 currentShape.mesh.positions[j*3 + 2]);   // Z
 
-			UVcoords[j] = glm::vec2(currentShape.mesh.texcoords[j*2],             // X
+			vertices[j].UV = glm::vec2(currentShape.mesh.texcoords[j*2],          // X
 										 currentShape.mesh.texcoords[j*2 + 1]);   // Y
 
-			normals[j] = glm::vec3(currentShape.mesh.normals[j*3],                // X
+			vertices[j].normal = glm::vec3(currentShape.mesh.normals[j*3],        // X
 										 currentShape.mesh.normals[j*3 + 1],      // Y
 										 currentShape.mesh.normals[j*3 + 2]);     // Z
 		}
 
-		std::string name = getValidName(currentShape.name); // Make sure we have a unique name
-
-		objectGeometryPointer objectGeometryPointer(new ObjectGeometry(name,
-			currentShape.mesh.indices, positions, UVcoords, normals));
-		addObjectGeometry(objectGeometryPointer);
+		// Exporters often repeat the same vertex for every face using it
+		ObjectGeometry::weldVertices(currentData.indices, vertices);
 	}
 
 	return true; // Success!
 }
 
+// Static
+// Fills geometryData.LODs, each level simplified from the one before (see MeshSimplifier) until they get too small,
+// stop getting simpler or OBJECT_GEOMETRY_LOD_MAX_LEVELS is reached. Doesn't touch OpenGL, safe to call from jobs.
+void ObjectGeometryGroup::generateLODs(GeometryData& geometryData)
+{
+	geometryData.LODs.clear();
+
+	if(geometryData.vertices.empty())
+		return;
+
+	glm::vec3 boxMin = geometryData.vertices[0].position;
+	glm::vec3 boxMax = boxMin;
+
+	for(const auto &vertex : geometryData.vertices)
+	{
+		boxMin = glm::min(boxMin, vertex.position);
+		boxMax = glm::max(boxMax, vertex.position);
+	}
+
+	float maxError = glm::length(boxMax - boxMin) * OBJECT_GEOMETRY_LOD_MAX_ERROR;
+	float error = 0.0f;
+
+	for(int level = 1; level <= OBJECT_GEOMETRY_LOD_MAX_LEVELS; level++)
+	{
+		const ObjectGeometry::uintVector& indices = geometryData.LODs.empty() ? geometryData.indices : geometryData.LODs.back().indices;
+		const ObjectGeometry::vertexVector& vertices = geometryData.LODs.empty() ? geometryData.vertices : geometryData.LODs.back().vertices;
+
+		std::size_t triangleCount = indices.size() / 3;
+		std::size_t targetTriangleCount = static_cast<std::size_t>(triangleCount * OBJECT_GEOMETRY_LOD_REDUCTION);
+
+		if(targetTriangleCount < OBJECT_GEOMETRY_LOD_MIN_TRIANGLES)
+			break;
+
+		MeshSimplifier simplifier(indices, vertices);
+		std::size_t indexCount = simplifier.simplify(targetTriangleCount * 3, maxError - error);
+
+		if(indexCount > indices.size() * OBJECT_GEOMETRY_LOD_MIN_GAIN) // Not worth another level
+			break;
+
+		error += simplifier.getError(); // Errors of each level add up, since each starts from the last one
+
+		LODData lod;
+		simplifier.getResult(lod.indices, lod.vertices);
+		lod.error = error;
+
+		geometryData.LODs.push_back(lod); // Invalidates indices and vertices, we're done with them
+	}
+}
+
+// Creates the object geometries (on the GPU) from data read before, with their levels of detail if they have some
+void ObjectGeometryGroup::addGeometryData(const geometryDataVector& geometryData)
+{
+	for(const auto &data : geometryData)
+	{
+		std::string name = getValidName(data.name); // Make sure we have a unique name
+
+		objectGeometryPointer objectGeometryPointer(new ObjectGeometry(name, data.indices, data.vertices));
+
+		for(std::size_t i = 0; i < data.LODs.size(); i++)
+		{
+			const LODData& lod = data.LODs[i];
+			std::string LODName = name + "LOD" + std::to_string(i + 1);
+
+			objectGeometryPointer->addLOD(std::make_shared<ObjectGeometry>(LODName, lod.indices, lod.vertices), lod.error);
+		}
+
+		addObjectGeometry(objectGeometryPointer);
+	}
+}
+
 // Checks if the name is available. If not, it will generate one.
 // Use this before creating and adding a geometry object to store the right name
 std::string ObjectGeometryGroup::getValidName(const std::string& name)
@@ -38,7 +38,28 @@ public:
 
 	using objectGeometryVector = std::vector<objectGeometryPointer>;
 
+	// A simplified version of a GeometryData, see generateLODs()
+	struct LODData
+	{
+		ObjectGeometry::uintVector indices;
+		ObjectGeometry::vertexVector vertices;
+		float error; // See ObjectGeometry::addLOD()
+	};
+
+	// Geometry read from a file but not on the GPU yet, so it can be loaded on any thread
+	struct GeometryData
+	{
+		std::string name;
+		ObjectGeometry::uintVector indices;
+		ObjectGeometry::vertexVector vertices; // Welded
+		std::vector<LODData> LODs; // Coarser and coarser, empty unless generated
+	};
+
+	using geometryDataVector = std::vector<GeometryData>;
+
 private:
+	friend class MicroBench; // bench/MicroBench.cpp times the private hot spots
+
 	std::string mName;
 	objectGeometryMap mObjectGeometryMap;
 
@@ -51,6 +72,11 @@ public:
 	ObjectGeometryGroup(const std::string& name, const std::string& objectFile);
 	~ObjectGeometryGroup();
 
+	static bool readOBJFile(const std::string& OBJfilePath, const std::string& groupName, geometryDataVector& geometryData,
+		std::string& error, std::vector<std::string>& warnings);
+	static void generateLODs(GeometryData& geometryData);
+	void addGeometryData(const geometryDataVector& geometryData);
+
 	std::string getName();
 
 	std::string getValidName(const std::string& objectGeometryName);
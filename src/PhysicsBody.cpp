@@ -37,9 +37,13 @@
 #include <PhysicsBody.hpp>
 
 #include <Utils.hpp>
-#include <GPUBuffer.hpp>
 #include <Camera.hpp>
 #include <ShadedObject.hpp>
+#include <JobSystem.hpp>
+#include <Profiler.hpp>
+#include <Graphics.hpp>
+#include <GLState.hpp>
+#include <StreamBuffer.hpp>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -49,6 +53,9 @@
 
 #include <math.h> // For trig stuff
 
+bool PhysicsBody::mDeferringDebugShapes = false;
+PhysicsBody::debugShapeVector PhysicsBody::mDeferredDebugShapes;
+
 PhysicsBody::PhysicsBody()
 {
 	init();
@@ -148,6 +155,10 @@ void PhysicsBody::init()
 	mIsCircular = true;
 	mRadius = 0.0f;
 	mType = PHYSICS_BODY_IGNORED;
+
+	mPreviousPosition = glm::vec3(0.0f);
+	mPreviousRotation = glm::vec3(0.0f);
+	mInterpolationFactor = 1.0f;
 }
 
 // Static
@@ -160,6 +171,13 @@ PhysicsBody::shapeVector PhysicsBody::createShapesFromObjectGeometry(const Objec
 	// b2Vec2 is a float32 point/vector
 	std::vector<b2Vec2> positions2D = get2DObjectGeometryCoords(objectGeometry, pixelsPerMeter, rotation, scaling);
 
+	return createShapesFromPoints(positions2D, generateCircular);
+}
+
+// Static
+// The heavy part of creating shapes. Doesn't touch OpenGL or the world, so it is safe in jobs.
+PhysicsBody::shapeVector PhysicsBody::createShapesFromPoints(const B2Vec2Vector& positions2D, bool generateCircular)
+{
 	if(generateCircular)
 	{
 		shapeVector shapes;
@@ -238,7 +256,7 @@ PhysicsBody::shapeUniquePointer PhysicsBody::createShapesFromRadius(float radius
 PhysicsBody::B2Vec2Vector PhysicsBody::get2DObjectGeometryCoords(const ObjectGeometry& objectGeometry,
 	float pixelsPerMeter, glm::vec3 rotation, glm::vec3 scaling)
 {
-	ObjectGeometry::uintVector indices = objectGeometry.getIndexBuffer().read();
+	const ObjectGeometry::uintVector& indices = objectGeometry.getIndices();
 	ObjectGeometry::vec3Vector positions3D = objectGeometry.getPositionBuffer().read();
 
 	// generate a matrix so we can easily have rotation and scaling
@@ -593,16 +611,8 @@ bool PhysicsBody::calculateShapes(bool isCircularShape, glm::vec3 scaling)
 {
 	if(mObjectGeometry)
 	{
-		mIsCircular = isCircularShape;
-		mShapes = createShapesFromObjectGeometry(*mObjectGeometry, isCircularShape, PHYSICS_PIXELS_PER_METER,
-			mRotation, scaling);
-		mScaling = scaling;
-
-		if(isCircularShape)
-			mRadius = mShapes[0]->m_radius; // A circular shape is 1 shape
-
-		if(mWorldBody)
-			updateWorldBodyFixtures();
+		setShapes(createShapesFromObjectGeometry(*mObjectGeometry, isCircularShape, PHYSICS_PIXELS_PER_METER,
+			mRotation, scaling), isCircularShape, scaling);
 	} else
 	{
 		Utils::CRASH("Object geometry not defined! Cannot create shape from object geometry!");
@@ -612,6 +622,71 @@ bool PhysicsBody::calculateShapes(bool isCircularShape, glm::vec3 scaling)
 	return true;
 }
 
+// Static
+// Same as calling calculateShapes() on each body, but the heavy part runs in parallel on the job system
+// Returns false on failure
+bool PhysicsBody::calculateShapes(const std::vector<PhysicsBody*>& bodies, JobSystem& jobSystem)
+{
+	std::vector<B2Vec2Vector> positions2D(bodies.size());
+	std::vector<shapeVector> shapes(bodies.size());
+	std::vector<char> fromObjectGeometry(bodies.size(), false); // Not vector<bool>, jobs write to it at the same time
+
+	// Reading the geometry uses OpenGL, so do it here
+	for(std::size_t i = 0; i < bodies.size(); i++)
+	{
+		PhysicsBody& body = *bodies[i];
+
+		if(body.mIsCircular && !body.mObjectGeometry)
+			continue; // Simple circle, done below
+
+		if(!body.mObjectGeometry)
+		{
+			Utils::CRASH("Object geometry not defined! Cannot create shape from object geometry!");
+			return false;
+		}
+
+		positions2D[i] = get2DObjectGeometryCoords(*body.mObjectGeometry, PHYSICS_PIXELS_PER_METER,
+			body.mRotation, body.mScaling);
+		fromObjectGeometry[i] = true;
+	}
+
+	jobSystem.parallelFor(bodies.size(), 0, [&](std::size_t begin, std::size_t end)
+	{
+		for(std::size_t i = begin; i < end; i++)
+		{
+			if(fromObjectGeometry[i])
+				shapes[i] = createShapesFromPoints(positions2D[i], bodies[i]->mIsCircular);
+		}
+	});
+
+	// Box2D isn't thread safe, update the world here
+	for(std::size_t i = 0; i < bodies.size(); i++)
+	{
+		PhysicsBody& body = *bodies[i];
+
+		if(fromObjectGeometry[i])
+			body.setShapes(std::move(shapes[i]), body.mIsCircular, body.mScaling);
+		else
+			body.calculateShapes(body.mRadius);
+	}
+
+	return true;
+}
+
+// Takes ownership of the shapes and updates the world body
+void PhysicsBody::setShapes(shapeVector shapes, bool isCircularShape, glm::vec3 scaling)
+{
+	mIsCircular = isCircularShape;
+	mShapes = std::move(shapes);
+	mScaling = scaling;
+
+	if(isCircularShape)
+		mRadius = mShapes[0]->m_radius; // A circular shape is 1 shape
+
+	if(mWorldBody)
+		updateWorldBodyFixtures();
+}
+
 // Calculate circular shape
 bool PhysicsBody::calculateShapes(float radius)
 {
@@ -888,7 +963,7 @@ glm::vec3 PhysicsBody::getShapesLocal3DCenter() const
 
 		if(mObjectGeometry)
 		{
-			ObjectGeometry::uintVector indices = mObjectGeometry->getIndexBuffer().read();
+			const ObjectGeometry::uintVector& indices = mObjectGeometry->getIndices();
 			ObjectGeometry::vec3Vector positions3D = mObjectGeometry->getPositionBuffer().read();
 
 			std::size_t indexCount = indices.size();
@@ -921,6 +996,9 @@ bool PhysicsBody::addToWorld(b2World* world)
 {
 	b2BodyDef bodyDef;
 
+	// Whatever happened before doesn't count, don't interpolate from it
+	resetInterpolation();
+
 	if(mType == PHYSICS_BODY_IGNORED)
 		return true;
 
@@ -959,12 +1037,45 @@ void PhysicsBody::removeFromWorld()
 	mWorld = nullptr;
 }
 
+// Where to render between the previous step (0.0) and the last step (1.0)
+void PhysicsBody::setInterpolationFactor(float factor)
+{
+	mInterpolationFactor = factor;
+}
+
+// Makes the previous step the same as the current state, useful after teleporting
+void PhysicsBody::resetInterpolation()
+{
+	mPreviousPosition = getPosition();
+	mPreviousRotation = getRotation();
+}
+
+// In meters, as always
+glm::vec3 PhysicsBody::getInterpolatedPosition() const
+{
+	return glm::mix(mPreviousPosition, getPosition(), mInterpolationFactor);
+}
+
+// In degrees
+glm::vec3 PhysicsBody::getInterpolatedRotation() const
+{
+	glm::vec3 rotation = getRotation();
+
+	// The angle was normalized or set by hand during the step, interpolating would spin the wrong way around
+	glm::vec3 difference = glm::abs(rotation - mPreviousRotation);
+	if(difference.x > 180.0f || difference.y > 180.0f || difference.z > 180.0f)
+		return rotation;
+
+	return glm::mix(mPreviousRotation, rotation, mInterpolationFactor);
+}
+
 // Generates model matrix based on this body's position, rotation and scaling
-glm::mat4 PhysicsBody::generateModelMatrix()
+// Uses the interpolated state, since this is what we render
+glm::mat4 PhysicsBody::generateModelMatrix() const
 {
 	glm::mat4 modelM = generateModelMatrix(
-		getPosition(),
-		getRotation(),
+		getInterpolatedPosition(),
+		getInterpolatedRotation(),
 		mScaling);
 
 	return modelM;
@@ -973,6 +1084,10 @@ glm::mat4 PhysicsBody::generateModelMatrix()
 // timeStep in seconds, like Box2D (speed is in meters/seconds normally)
 void PhysicsBody::step(float timeStep)
 {
+	// Remember where we were before this step for interpolation
+	mPreviousPosition = getPosition();
+	mPreviousRotation = getRotation();
+
 	if(mWorldBody)
 	{
 		if(mWorldFriction != 0.0f)
@@ -1046,18 +1161,33 @@ void PhysicsBody::step(float timeStep)
 // The shader is the same for basic objects
 void PhysicsBody::renderDebugShape(constShaderPointer shader, const Camera* camera, float other3DCoord)
 {
-	glm::vec3 color(0.0f, 1.0f, 0.0f);
+	if(!Graphics::isEnabled())
+		return;
+
+	DebugShape debugShape;
+
+	if(!generateDebugShape(debugShape, shader, camera, other3DCoord))
+		return;
+
+	// We might not be on the thread owning the OpenGL context, let the render thread draw it later
+	if(mDeferringDebugShapes)
+		mDeferredDebugShapes.push_back(std::move(debugShape));
+	else
+		drawDebugShape(debugShape);
+}
 
+// Fills debugShape with everything needed to draw this body's shapes, without touching OpenGL
+// Returns false on failure
+bool PhysicsBody::generateDebugShape(DebugShape& debugShape, constShaderPointer shader, const Camera* camera, float other3DCoord) const
+{
 	if(mShapes.empty())
 	{
 		Utils::CRASH("Cannot debug render this physics body, it does not have shapes! Please calculate them before calling.");
-		return;
+		return false;
 	}
-	
-	// Lets do something very smart, create a buffer, fill it, and then delete it each time we render
-	GPUBuffer<glm::vec3> positionBuffer;
-	vec3Vector localPositions3D; // Object space coords, before model matrix!
-	int drawMode = 0;
+
+	vec3Vector& localPositions3D = debugShape.positions; // Object space coords, before model matrix!
+	localPositions3D.clear();
 
 	if(mIsCircular)
 	{
@@ -1086,7 +1216,7 @@ void PhysicsBody::renderDebugShape(constShaderPointer shader, const Camera* came
 			0.0f,
 			circleCenter.y * PHYSICS_PIXELS_PER_METER)); // Add the center of the circle
 
-		drawMode = GL_LINE_STRIP;
+		debugShape.drawMode = GL_LINE_STRIP;
 	} else
 	{
 		for(std::size_t i = 0; i < mShapes.size(); i++)
@@ -1107,27 +1237,57 @@ void PhysicsBody::renderDebugShape(constShaderPointer shader, const Camera* came
 			}
 		}
 
-		drawMode = GL_TRIANGLES;
-		// Draw lines only, but they are still rasterized as triangles
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Must reset this after rendering!
+		debugShape.drawMode = GL_TRIANGLES; // Drawn as lines, see drawDebugShape()
 	}
 
-	positionBuffer.setMutableData(localPositions3D, GL_STATIC_DRAW);
-
 	glm::vec3 position = getPosition();
 	glm::mat4 modelMatrix = generateModelMatrix(
 		glm::vec3(position.x, other3DCoord, position.z),
 		glm::vec3(0.0f, getRotation().y, 0.0f), // Ignore any rotation apart Box2D's rotation
 		glm::vec3(1.0f)); // No scaling here! The scaling is built-in the vertices
 
-	glm::mat4 MVP = camera->getProjectionMatrix() * camera->getViewMatrix() * modelMatrix;
+	debugShape.shader = shader;
+	debugShape.MVP = camera->getProjectionMatrix() * camera->getViewMatrix() * modelMatrix;
+	return true;
+}
+
+// Static
+// When deferring, debug shapes are queued instead of drawn. Use this when Lua steps on another thread than OpenGL.
+void PhysicsBody::setDebugShapeDeferring(bool deferring)
+{
+	mDeferringDebugShapes = deferring;
+}
+
+// Static
+// Moves the queued debug shapes at the end of 'debugShapes'
+void PhysicsBody::takeDeferredDebugShapes(debugShapeVector& debugShapes)
+{
+	for(auto &debugShape : mDeferredDebugShapes)
+		debugShapes.push_back(std::move(debugShape));
+
+	mDeferredDebugShapes.clear();
+}
+
+// Static
+// Call on the thread owning the OpenGL context
+void PhysicsBody::drawDebugShape(const DebugShape& debugShape)
+{
+	glm::vec3 color(0.0f, 1.0f, 0.0f);
+
+	// Only used for this frame, stream it
+	StreamBuffer& streamBuffer = *Graphics::getStreamBuffer();
+	GLintptr positionOffset = streamBuffer.write(debugShape.positions, sizeof(GLfloat));
+
+	if(debugShape.drawMode == GL_TRIANGLES)
+		// Draw lines only, but they are still rasterized as triangles
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // Must reset this after rendering!
 
-	glUseProgram(shader->getID());
-	glUniformMatrix4fv(shader->findUniform("MVP"), 1, GL_FALSE, &MVP[0][0]);
-	glUniform3f(shader->findUniform("color"), color.r, color.g, color.b);
+	GLState::useProgram(debugShape.shader->getID());
+	GLState::setUniform(debugShape.shader->getUniform(SHADER_UNIFORM_MVP), debugShape.MVP);
+	GLState::setUniform(debugShape.shader->getUniform(SHADER_UNIFORM_COLOR), color);
 
 	glEnableVertexAttribArray(0); // Number to give to OpenGL VertexAttribPointer
-	positionBuffer.bind(GL_ARRAY_BUFFER);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, streamBuffer.getID());
 
 	// Give it to the shader. Each time the vertex shader runs, it will get the next element of this buffer.
 	glVertexAttribPointer(
@@ -1136,21 +1296,22 @@ void PhysicsBody::renderDebugShape(constShaderPointer shader, const Camera* came
 		GL_FLOAT,			// Type of data (GLfloats)
 		GL_FALSE,			// Normalized?
 		0,					// Stride
-		(void*)0			// Array buffer offset
+		reinterpret_cast<void*>(positionOffset) // Array buffer offset
 		);
 
-	glDisable(GL_CULL_FACE); // Must re-enable after!
+	GLState::setCapability(GL_CULL_FACE, false); // Must re-enable after!
 
 	// Draw!
 	glDrawArrays(
-		drawMode, // Mode
+		debugShape.drawMode, // Mode
 		0, // First
-		localPositions3D.size() // Count
+		debugShape.positions.size() // Count
 		);
+	Profiler::countDrawCall();
 
 	glDisableVertexAttribArray(0);
 	glPolygonMode(GRAPHICS_RASTERIZE_FACE, GRAPHICS_RASTERIZE_MODE); // Reset
-	glEnable(GL_CULL_FACE);
+	GLState::setCapability(GL_CULL_FACE, true);
 }
 
 // Will use the body's position
@@ -36,9 +36,24 @@
 
 class Shader;
 class Camera;
+class JobSystem;
 class PhysicsBody
 {
+public:
+	// Everything needed to draw a debug shape, so it can be drawn later on the OpenGL thread
+	struct DebugShape
+	{
+		std::shared_ptr<const Shader> shader;
+		std::vector<glm::vec3> positions; // Object space
+		glm::mat4 MVP;
+		int drawMode;
+	};
+
+	using debugShapeVector = std::vector<DebugShape>;
+
 private:
+	friend class MicroBench; // bench/MicroBench.cpp times the private hot spots
+
 	using shapeUniquePointer = std::unique_ptr<b2Shape>; // Smart pointers mean ownership!!
 	using shapeVector = std::vector<shapeUniquePointer>;
 	using fixtureDefVector = std::vector<b2FixtureDef>;
@@ -85,9 +100,18 @@ private:
 
 	int mType; // Can't change
 
+	static bool mDeferringDebugShapes;
+	static debugShapeVector mDeferredDebugShapes; // Debug shapes waiting to be drawn
+
+	// State at the start of the last step, used to interpolate between steps when rendering
+	glm::vec3 mPreviousPosition;
+	glm::vec3 mPreviousRotation;
+	float mInterpolationFactor; // 0.0 renders the previous step, 1.0 renders the last step
+
 	// Static functions
 	static shapeVector createShapesFromObjectGeometry(const ObjectGeometry& objectGeometry,
 		bool generateCircular, float pixelsPerMeter, glm::vec3 rotation, glm::vec3 scaling);
+	static shapeVector createShapesFromPoints(const B2Vec2Vector& positions2D, bool generateCircular);
 	static shapeUniquePointer createShapesFromRadius(float radius);
 	static B2Vec2Vector get2DObjectGeometryCoords(const ObjectGeometry& objectGeometry,
 		float pixelsPerMeter, glm::vec3 rotation, glm::vec3 scaling);
@@ -140,6 +164,7 @@ private:
 		return sqrt((point2.x - point1.x)*(point2.x - point1.x) + (point2.y - point1.y)*(point2.y - point1.y));
 	}
 
+	void setShapes(shapeVector shapes, bool isCircularShape, glm::vec3 scaling);
 	fixtureDefVector generateFixtureDefsAndSetBodyDef(b2BodyDef& bodyDef);
 	bool updateWorldBodyFixtures();
 
@@ -155,6 +180,7 @@ public:
 	bool calculateShapes();
 	bool calculateShapes(bool isCircularShape, glm::vec3 scaling);
 	bool calculateShapes(float radius);
+	static bool calculateShapes(const std::vector<PhysicsBody*>& bodies, JobSystem& jobSystem);
 
 	void setDensity(float density);
 	float getDensity() const;
@@ -191,12 +217,22 @@ public:
 	bool addToWorld(b2World* world);
 	void removeFromWorld();
 
-	glm::mat4 generateModelMatrix();
+	void setInterpolationFactor(float factor);
+	void resetInterpolation();
+	glm::vec3 getInterpolatedPosition() const;
+	glm::vec3 getInterpolatedRotation() const;
+
+	glm::mat4 generateModelMatrix() const;
 
 	void step(float timeStep);
 
 	void renderDebugShape(constShaderPointer shader, const Camera* camera, float other3DCoord);
 	void renderDebugShape(constShaderPointer shader, const Camera* camera);
+	bool generateDebugShape(DebugShape& debugShape, constShaderPointer shader, const Camera* camera, float other3DCoord) const;
+
+	static void setDebugShapeDeferring(bool deferring);
+	static void takeDeferredDebugShapes(debugShapeVector& debugShapes);
+	static void drawDebugShape(const DebugShape& debugShape);
 };
 
 #endif /* PHYSICS_BODY_HPP */
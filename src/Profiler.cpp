@@ -0,0 +1,291 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <Profiler.hpp>
+#include <HighResolutionClock.hpp>
+#include <Utils.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+std::uint32_t Profiler::mDrawCallCount = 0;
+std::uint32_t Profiler::mVisibleObjectCount = 0;
+std::uint32_t Profiler::mCulledObjectCount = 0;
+
+Profiler::StageTimer::StageTimer(Profiler& profiler, int stage)
+	: mProfiler(profiler)
+{
+	mStage = stage;
+	mStartTime = HighResolutionClock::getNanoseconds();
+}
+
+Profiler::StageTimer::~StageTimer()
+{
+	mProfiler.addStageTime(mStage, HighResolutionClock::getNanoseconds() - mStartTime);
+}
+
+Profiler::Profiler()
+	: mHistory(PROFILER_HISTORY_LENGTH * PROFILER_STAGE_COUNT, 0)
+{
+	mNextFrameIndex = 0;
+	mRecordedFrames = 0;
+
+	for(int i = 0; i < PROFILER_STAGE_COUNT; i++)
+		mCurrentFrame[i] = 0;
+}
+
+Profiler::~Profiler()
+{
+	// Do nothing
+}
+
+// Static
+// Used for the CSV header
+std::string Profiler::getStageName(int stage)
+{
+	switch(stage)
+	{
+	case PROFILER_STAGE_EVENTS:             return "events";
+	case PROFILER_STAGE_PHYSICS_BODIES:     return "physicsBodies";
+	case PROFILER_STAGE_PHYSICS_WORLD:      return "physicsWorld";
+	case PROFILER_STAGE_SCRIPT:             return "script";
+	case PROFILER_STAGE_RENDER:             return "render";
+	case PROFILER_STAGE_ERROR_CHECK:        return "errorCheck";
+	case PROFILER_STAGE_SWAP:               return "swap";
+	case PROFILER_STAGE_SLEEP:              return "sleep";
+	case PROFILER_STAGE_FRAME:              return "frame";
+	case PROFILER_COUNTER_DRAW_CALLS:       return "drawCalls";
+	case PROFILER_COUNTER_VISIBLE_OBJECTS:  return "visibleObjects";
+	case PROFILER_COUNTER_CULLED_OBJECTS:   return "culledObjects";
+	case PROFILER_COUNTER_GL_CALLS:         return "glCalls";
+	case PROFILER_COUNTER_SKIPPED_GL_CALLS: return "skippedGLCalls";
+	default:                                return "unknown";
+	}
+}
+
+// Static
+// Call after each glDraw*()
+void Profiler::countDrawCall()
+{
+	mDrawCallCount++;
+}
+
+// Static
+// Returns the draw calls counted since the last call
+std::uint32_t Profiler::takeDrawCallCount()
+{
+	std::uint32_t count = mDrawCallCount;
+	mDrawCallCount = 0;
+	return count;
+}
+
+// Static
+// Call after frustum culling
+void Profiler::countCulling(std::uint32_t visibleCount, std::uint32_t culledCount)
+{
+	mVisibleObjectCount += visibleCount;
+	mCulledObjectCount += culledCount;
+}
+
+// Static
+std::uint32_t Profiler::takeVisibleObjectCount()
+{
+	std::uint32_t count = mVisibleObjectCount;
+	mVisibleObjectCount = 0;
+	return count;
+}
+
+// Static
+std::uint32_t Profiler::takeCulledObjectCount()
+{
+	std::uint32_t count = mCulledObjectCount;
+	mCulledObjectCount = 0;
+	return count;
+}
+
+bool Profiler::isValidStage(int stage) const
+{
+	if(stage < 0 || stage >= PROFILER_STAGE_COUNT)
+	{
+		Utils::WARN("Profiler stage " + std::to_string(stage) + " does not exist!");
+		return false;
+	}
+
+	return true;
+}
+
+// Copies the recorded times of this stage, in no particular order
+void Profiler::getStageHistory(int stage, std::vector<std::uint32_t>& times) const
+{
+	times.resize(mRecordedFrames);
+
+	for(int i = 0; i < mRecordedFrames; i++)
+		times[i] = mHistory[i * PROFILER_STAGE_COUNT + stage];
+}
+
+// Adds time to a stage of the current frame
+// Only one thread should record each stage
+void Profiler::addStageTime(int stage, std::int64_t nanoseconds)
+{
+	mCurrentFrame[stage] += nanoseconds; // Converted to microseconds in endFrame(), short steps would round to 0
+}
+
+// Adds to a counter of the current frame, same rules as stages
+void Profiler::addCount(int counter, std::uint32_t count)
+{
+	mCurrentFrame[counter] += count;
+}
+
+// Saves the current frame in the history and starts a new one
+// Call when no other thread is recording!
+void Profiler::endFrame()
+{
+	std::uint32_t* frame = &mHistory[mNextFrameIndex * PROFILER_STAGE_COUNT];
+
+	for(int i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+		if(i < PROFILER_COUNTER_DRAW_CALLS) // Stages
+			frame[i] = static_cast<std::uint32_t>(mCurrentFrame[i] / 1000);
+		else // Counters
+			frame[i] = static_cast<std::uint32_t>(mCurrentFrame[i]);
+
+		mCurrentFrame[i] = 0;
+	}
+
+	mNextFrameIndex = (mNextFrameIndex + 1) % PROFILER_HISTORY_LENGTH;
+
+	if(mRecordedFrames < PROFILER_HISTORY_LENGTH)
+		mRecordedFrames++;
+}
+
+int Profiler::getRecordedFrames() const
+{
+	return mRecordedFrames;
+}
+
+// All times are in microseconds
+float Profiler::getLast(int stage) const
+{
+	if(!isValidStage(stage) || mRecordedFrames == 0)
+		return 0.0f;
+
+	int lastFrameIndex = (mNextFrameIndex + PROFILER_HISTORY_LENGTH - 1) % PROFILER_HISTORY_LENGTH;
+	return static_cast<float>(mHistory[lastFrameIndex * PROFILER_STAGE_COUNT + stage]);
+}
+
+float Profiler::getMin(int stage) const
+{
+	if(!isValidStage(stage) || mRecordedFrames == 0)
+		return 0.0f;
+
+	std::vector<std::uint32_t> times;
+	getStageHistory(stage, times);
+
+	return static_cast<float>(*std::min_element(times.begin(), times.end()));
+}
+
+float Profiler::getMax(int stage) const
+{
+	if(!isValidStage(stage) || mRecordedFrames == 0)
+		return 0.0f;
+
+	std::vector<std::uint32_t> times;
+	getStageHistory(stage, times);
+
+	return static_cast<float>(*std::max_element(times.begin(), times.end()));
+}
+
+float Profiler::getAverage(int stage) const
+{
+	if(!isValidStage(stage) || mRecordedFrames == 0)
+		return 0.0f;
+
+	std::vector<std::uint32_t> times;
+	getStageHistory(stage, times);
+
+	double total = 0.0;
+	for(auto time : times)
+		total += time;
+
+	return static_cast<float>(total / times.size());
+}
+
+// Percentile from 0 to 100, nearest rank
+float Profiler::getPercentile(int stage, float percentile) const
+{
+	if(!isValidStage(stage) || mRecordedFrames == 0)
+		return 0.0f;
+
+	std::vector<std::uint32_t> times;
+	getStageHistory(stage, times);
+
+	percentile = std::min(std::max(percentile, 0.0f), 100.0f);
+	std::size_t rank = static_cast<std::size_t>((percentile / 100.0f) * (times.size() - 1) + 0.5f);
+
+	std::nth_element(times.begin(), times.begin() + rank, times.end());
+	return static_cast<float>(times[rank]);
+}
+
+// Everything at once, for Lua
+std::map<std::string, float> Profiler::getStats(int stage) const
+{
+	std::map<std::string, float> stats;
+
+	stats["last"] = getLast(stage);
+	stats["min"] = getMin(stage);
+	stats["max"] = getMax(stage);
+	stats["average"] = getAverage(stage);
+	stats["p95"] = getPercentile(stage, 95.0f);
+	stats["p99"] = getPercentile(stage, 99.0f);
+
+	return stats;
+}
+
+// One line per recorded frame, oldest first, in microseconds (counters are counts)
+// Returns false on failure
+bool Profiler::writeCSV(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if(!file)
+	{
+		Utils::WARN("Could not open '" + path + "' to write the profiler's data!");
+		return false;
+	}
+
+	file << "frame";
+	for(int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+		file << ',' << getStageName(stage);
+	file << '\n';
+
+	// The oldest frame is where the next one would go, if we went around the ring
+	int firstFrameIndex = (mRecordedFrames < PROFILER_HISTORY_LENGTH) ? 0 : mNextFrameIndex;
+
+	for(int i = 0; i < mRecordedFrames; i++)
+	{
+		int frameIndex = (firstFrameIndex + i) % PROFILER_HISTORY_LENGTH;
+
+		file << i;
+		for(int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+			file << ',' << mHistory[frameIndex * PROFILER_STAGE_COUNT + stage];
+		file << '\n';
+	}
+
+	return true;
+}
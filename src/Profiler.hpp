@@ -0,0 +1,89 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// Times the stages of each frame in microseconds and keeps the last frames in a ring buffer.
+// Recording never allocates; all the memory is taken when constructing.
+// A stage can be timed many times in a frame (steps), the times are added together.
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <Definitions.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class Profiler
+{
+public:
+	// Times a stage from construction to destruction
+	class StageTimer
+	{
+	private:
+		Profiler& mProfiler;
+		int mStage;
+		std::int64_t mStartTime; // In nanoseconds
+
+	public:
+		StageTimer(Profiler& profiler, int stage);
+		~StageTimer();
+	};
+
+private:
+	std::vector<std::uint32_t> mHistory; // PROFILER_HISTORY_LENGTH frames of PROFILER_STAGE_COUNT times, in microseconds
+	std::int64_t mCurrentFrame[PROFILER_STAGE_COUNT]; // Being recorded, stages in nanoseconds, each written by one thread
+	int mNextFrameIndex; // Where the next frame goes in the ring
+	int mRecordedFrames; // Up to PROFILER_HISTORY_LENGTH
+
+	static std::uint32_t mDrawCallCount; // Only counted on the OpenGL thread
+	static std::uint32_t mVisibleObjectCount; // Same
+	static std::uint32_t mCulledObjectCount;
+
+	bool isValidStage(int stage) const;
+	void getStageHistory(int stage, std::vector<std::uint32_t>& times) const;
+
+public:
+	Profiler();
+	~Profiler();
+
+	static std::string getStageName(int stage);
+	static void countDrawCall();
+	static std::uint32_t takeDrawCallCount();
+	static void countCulling(std::uint32_t visibleCount, std::uint32_t culledCount);
+	static std::uint32_t takeVisibleObjectCount();
+	static std::uint32_t takeCulledObjectCount();
+
+	void addStageTime(int stage, std::int64_t nanoseconds);
+	void addCount(int counter, std::uint32_t count);
+	void endFrame();
+
+	int getRecordedFrames() const;
+	float getLast(int stage) const;
+	float getMin(int stage) const;
+	float getMax(int stage) const;
+	float getAverage(int stage) const;
+	float getPercentile(int stage, float percentile) const;
+	std::map<std::string, float> getStats(int stage) const;
+
+	bool writeCSV(const std::string& path) const;
+};
+
+#endif /* PROFILER_HPP */
@@ -0,0 +1,469 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <RenderQueue.hpp>
+#include <Object.hpp>
+#include <Texture.hpp>
+#include <ObjectGeometry.hpp>
+#include <GLState.hpp>
+#include <Graphics.hpp>
+#include <StreamBuffer.hpp>
+#include <Profiler.hpp>
+#include <Definitions.hpp>
+
+#include <algorithm> // For std::sort
+#include <typeinfo> // For typeid
+
+RenderQueue::RenderQueue()
+{
+	mStaticBatching = DEFAULT_RENDER_QUEUE_STATIC_BATCHING;
+	mLODSelection = DEFAULT_RENDER_QUEUE_LOD_SELECTION;
+	mMaxLightIndices = std::min(LIGHT_CLUSTER_MAX_LIGHT_INDICES, LIGHT_CLUSTER_MIN_TEXTURE_BUFFER_SIZE);
+	mFrustumCulling = DEFAULT_RENDER_QUEUE_FRUSTUM_CULLING;
+
+	for(auto &texture : mLightTextures)
+		texture = 0;
+}
+
+RenderQueue::~RenderQueue()
+{
+	if(mLightTextures[0] != 0)
+	{
+		for(GLuint texture : mLightTextures)
+			GLState::deleteTexture(texture);
+	}
+}
+
+// Shifts the key and puts the lowest bits of value in the new space
+std::uint64_t RenderQueue::packKeyField(std::uint64_t key, std::uint64_t value, int bits)
+{
+	std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+	return (key << bits) | (value & mask);
+}
+
+// Static
+// The pass is in the highest bits
+int RenderQueue::getKeyPass(std::uint64_t key)
+{
+	return static_cast<int>(key >> (RENDER_QUEUE_SHADER_BITS + RENDER_QUEUE_TEXTURE_BITS + RENDER_QUEUE_GEOMETRY_BITS + RENDER_QUEUE_DEPTH_BITS));
+}
+
+// Static
+// Depth is the distance in front of the camera. Closer items come first, which helps the depth test.
+std::uint64_t RenderQueue::generateKey(int pass, GLuint shaderID, GLuint textureID, GLuint geometryID, float depth)
+{
+	const std::uint64_t maxDepthValue = (std::uint64_t(1) << RENDER_QUEUE_DEPTH_BITS) - 1;
+
+	float clampedDepth = glm::clamp(depth, 0.0f, RENDER_QUEUE_MAX_DEPTH);
+	std::uint64_t depthValue = static_cast<std::uint64_t>((clampedDepth / RENDER_QUEUE_MAX_DEPTH) * maxDepthValue);
+
+	std::uint64_t key = 0;
+	key = packKeyField(key, pass, RENDER_QUEUE_PASS_BITS);
+	key = packKeyField(key, shaderID, RENDER_QUEUE_SHADER_BITS);
+	key = packKeyField(key, textureID, RENDER_QUEUE_TEXTURE_BITS);
+	key = packKeyField(key, geometryID, RENDER_QUEUE_GEOMETRY_BITS);
+	key = packKeyField(key, depthValue, RENDER_QUEUE_DEPTH_BITS);
+
+	return key;
+}
+
+// Static
+// Same object type (same render function), same shader, texture and geometry
+bool RenderQueue::canInstanceTogether(const RenderItem& first, const RenderItem& other)
+{
+	return typeid(*first.object) == typeid(*other.object)
+		&& first.shader == other.shader
+		&& first.texture == other.texture
+		&& first.objectGeometry == other.objectGeometry;
+}
+
+// Static
+// Binds a texture reading the buffer on a texture unit, creating the texture the first time
+void RenderQueue::bindTextureBuffer(GLenum unit, GLuint& texture, GLenum format, GLuint buffer)
+{
+	if(texture == 0)
+	{
+		glGenTextures(1, &texture);
+		GLState::bindTexture(unit, GL_TEXTURE_BUFFER, texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, format, buffer); // Follows the buffer when its storage is replaced
+	} else
+		GLState::bindTexture(unit, GL_TEXTURE_BUFFER, texture);
+}
+
+// Groups consecutive entries that can be instanced, and fills the instance data for them
+void RenderQueue::buildBatches()
+{
+	mBatches.clear();
+	mInstanceData.clear();
+
+	std::size_t entryIndex = 0;
+	while(entryIndex < mEntries.size())
+	{
+		const RenderItem& first = *mEntries[entryIndex].renderItem;
+
+		Batch batch;
+		batch.firstEntry = entryIndex;
+		batch.entryCount = 1;
+		batch.firstInstance = 0;
+		batch.instanced = false;
+		batch.pass = getKeyPass(mEntries[entryIndex].key);
+
+		if(first.object->canRenderInstanced() && first.shader->getInstancedShader())
+		{
+			while(entryIndex + batch.entryCount < mEntries.size()
+				&& getKeyPass(mEntries[entryIndex + batch.entryCount].key) == batch.pass
+				&& canInstanceTogether(first, *mEntries[entryIndex + batch.entryCount].renderItem))
+				batch.entryCount++;
+
+			if(batch.entryCount >= RENDER_INSTANCING_MIN_COUNT)
+			{
+				batch.instanced = true;
+				batch.firstInstance = mInstanceData.size();
+
+				// Same geometry for the whole batch, so the same position decoding
+				glm::mat4 positionDecodeMatrix = first.objectGeometry->getPositionDecodeMatrix();
+
+				for(std::size_t i = 0; i < batch.entryCount; i++)
+				{
+					const glm::mat4& modelMatrix = mEntries[entryIndex + i].renderItem->modelMatrix;
+
+					InstanceData instanceData;
+					instanceData.modelMatrix = modelMatrix * positionDecodeMatrix;
+					instanceData.normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+					mInstanceData.push_back(instanceData);
+				}
+			} else
+				batch.entryCount = 1; // Not worth it, draw them one by one
+		}
+
+		mBatches.push_back(batch);
+		entryIndex += batch.entryCount;
+	}
+}
+
+// Switches to the deferred rendering path, lit objects will be drawn with the geometry shader (it must have an instanced version).
+// Call with OpenGL loaded, once.
+void RenderQueue::setDeferredShading(DeferredRenderer::constShaderPointer geometryShader,
+	DeferredRenderer::constShaderPointer lightingShader)
+{
+	mDeferredRenderer.reset(new DeferredRenderer(geometryShader, lightingShader));
+}
+
+int RenderQueue::getRenderingPath() const
+{
+	return mDeferredRenderer ? RENDERING_PATH_DEFERRED : RENDERING_PATH_FORWARD;
+}
+
+// Gives shadows to shadow casting lights, with the engine's depth shader. Call with OpenGL loaded, once.
+void RenderQueue::setShadowMapping(ShadowMapCache::constShaderPointer shader)
+{
+	mShadowMapCache.reset(new ShadowMapCache(shader));
+}
+
+// Keeps the memory for the next frame
+void RenderQueue::clear()
+{
+	mEntries.clear();
+	mDeferredItems.clear();
+	mLODItems.clear();
+}
+
+// The item isn't copied, keep it alive until the queue is rendered!
+// Lit items are copied with the deferred path, to swap their shader.
+void RenderQueue::addRenderItem(const RenderItem& renderItem, const glm::mat4& viewMatrix)
+{
+	const RenderItem* queuedItem = &renderItem;
+	int pass = RENDER_PASS_OPAQUE;
+
+	if(mDeferredRenderer && renderItem.object->canRenderDeferred())
+	{
+		mDeferredItems.push_back(renderItem);
+		mDeferredItems.back().shader = mDeferredRenderer->getGeometryShader();
+
+		queuedItem = &mDeferredItems.back();
+		pass = RENDER_PASS_DEFERRED_GEOMETRY;
+	}
+
+	GLuint textureID = queuedItem->texture ? queuedItem->texture->getID() : 0;
+	GLuint geometryID = queuedItem->objectGeometry->getIndexBufferID(); // Every geometry has its own
+
+	// The camera looks down -z
+	float depth = -(viewMatrix * queuedItem->modelMatrix[3]).z;
+
+	Entry entry;
+	entry.key = generateKey(pass, queuedItem->shader->getID(), textureID, geometryID, depth);
+	entry.renderItem = queuedItem;
+
+	mEntries.push_back(entry);
+}
+
+// Private
+// Returns the item to add: itself, or a copy using the level of detail its size on screen needs (see ObjectGeometry::selectLOD())
+const RenderItem& RenderQueue::selectLOD(const RenderItem& renderItem, const glm::mat4& viewMatrix,
+	const glm::mat4& projectionMatrix)
+{
+	const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
+
+	if(!mLODSelection || objectGeometry.getLODCount() == 1 || objectGeometry.getBoundingSphereRadius() <= 0.0f)
+		return renderItem;
+
+	glm::vec4 boundingSphere = objectGeometry.getBoundingSphere(renderItem.modelMatrix);
+
+	// How much of the screen's height a model space unit covers, clip space is 2 high
+	float modelScale = boundingSphere.w / objectGeometry.getBoundingSphereRadius();
+	float screenScale = modelScale * projectionMatrix[1][1] * 0.5f;
+
+	if(projectionMatrix[2][3] != 0.0f) // Perspective, things shrink with depth. The camera looks down -z.
+	{
+		float depth = -(viewMatrix * glm::vec4(glm::vec3(boundingSphere), 1.0f)).z - boundingSphere.w; // Closest point
+
+		if(depth <= 0.0f) // Around the camera
+			return renderItem;
+
+		screenScale /= depth;
+	}
+
+	int level = objectGeometry.selectLOD(screenScale);
+
+	if(level == 0)
+		return renderItem;
+
+	mLODItems.push_back(renderItem);
+	mLODItems.back().objectGeometry = objectGeometry.getLOD(level);
+
+	return mLODItems.back();
+}
+
+// Adds the items that can be in the frustum. Bounding spheres are tested first, all at once;
+// boxes are only tested for spheres crossing a plane. Visible items get their level of detail picked.
+void RenderQueue::addRenderItems(const RenderSnapshot::renderItemVector& renderItems, const glm::mat4& viewMatrix,
+	const glm::mat4& projectionMatrix, const Frustum& frustum)
+{
+	mEntries.reserve(mEntries.size() + renderItems.size());
+
+	if(!mFrustumCulling)
+	{
+		for(const auto &renderItem : renderItems)
+			addRenderItem(selectLOD(renderItem, viewMatrix, projectionMatrix), viewMatrix);
+
+		Profiler::countCulling(static_cast<std::uint32_t>(renderItems.size()), 0);
+		return;
+	}
+
+	mBoundingSpheres.resize(renderItems.size());
+	mCullResults.resize(renderItems.size());
+
+	for(std::size_t i = 0; i < renderItems.size(); i++)
+		mBoundingSpheres[i] = renderItems[i].objectGeometry->getBoundingSphere(renderItems[i].modelMatrix);
+
+	frustum.testSpheres(mBoundingSpheres.data(), mBoundingSpheres.size(), mCullResults.data());
+
+	std::uint32_t culledCount = 0;
+
+	for(std::size_t i = 0; i < renderItems.size(); i++)
+	{
+		const RenderItem& renderItem = renderItems[i];
+		const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
+
+		bool visible = mCullResults[i] == FRUSTUM_INSIDE
+			|| (mCullResults[i] == FRUSTUM_INTERSECTING
+			&& frustum.isBoxVisible(renderItem.modelMatrix, objectGeometry.getBoundingBoxMin(), objectGeometry.getBoundingBoxMax()));
+
+		if(visible)
+			addRenderItem(selectLOD(renderItem, viewMatrix, projectionMatrix), viewMatrix);
+		else
+			culledCount++;
+	}
+
+	Profiler::countCulling(static_cast<std::uint32_t>(renderItems.size()) - culledCount, culledCount);
+}
+
+std::size_t RenderQueue::getLength() const
+{
+	return mEntries.size();
+}
+
+// Batching is off by default, static objects must really stay still for it to pay off
+void RenderQueue::setStaticBatching(bool batching)
+{
+	mStaticBatching = batching;
+}
+
+bool RenderQueue::isStaticBatching() const
+{
+	return mStaticBatching;
+}
+
+// Returns what to draw instead of renderItems, valid until the next call
+const RenderSnapshot::renderItemVector& RenderQueue::batchStaticItems(const RenderSnapshot::renderItemVector& renderItems)
+{
+	if(!mStaticBatching)
+	{
+		mStaticBatcher.reset(); // Frees the merged geometries
+		return renderItems;
+	}
+
+	if(!mStaticBatcher)
+		mStaticBatcher.reset(new StaticBatcher());
+
+	return mStaticBatcher->batch(renderItems);
+}
+
+// On by default, only geometries with levels of detail are affected (see ResourceManager::setLODGeneration())
+void RenderQueue::setLODSelection(bool selection)
+{
+	mLODSelection = selection;
+}
+
+bool RenderQueue::isLODSelection() const
+{
+	return mLODSelection;
+}
+
+// Culling is on by default, turn it off to compare
+void RenderQueue::setFrustumCulling(bool culling)
+{
+	mFrustumCulling = culling;
+}
+
+bool RenderQueue::isFrustumCulling() const
+{
+	return mFrustumCulling;
+}
+
+void RenderQueue::sort()
+{
+	std::sort(mEntries.begin(), mEntries.end(),
+		[](const Entry& a, const Entry& b)
+	{
+		return a.key < b.key;
+	});
+}
+
+// Updates the shadow maps of the lights in shadowLights (see FrameData) and binds them on SHADOW_MAP_UNIT.
+// Draws in the shadow maps' framebuffers, so call it before the frame is drawn.
+void RenderQueue::renderShadowMaps(const RenderSnapshot::renderItemVector& renderItems, const std::vector<FrameLight>& lights,
+	const glm::ivec4& shadowLights)
+{
+	if(mShadowMapCache)
+		mShadowMapCache->render(renderItems, lights, shadowLights, mRenderState);
+}
+
+// Uploads the frame's uniform block and binds it for every shader (see FRAME_DATA_BINDING)
+void RenderQueue::setFrameData(const FrameData& frameData)
+{
+	StreamBuffer& streamBuffer = *Graphics::getStreamBuffer();
+	FrameData data = frameData;
+
+	if(!mShadowMapCache) // Nothing to sample
+		data.shadowLights = glm::ivec4(-1);
+
+	GLintptr offset = streamBuffer.write(&data, sizeof(data), streamBuffer.getUniformAlignment());
+	GLState::bindBufferRange(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, streamBuffer.getID(), offset, sizeof(data));
+}
+
+// Uploads the lights and their clusters as texture buffers, on the LIGHT_CLUSTER_UNIT_* texture units.
+// Shaders read them with texelFetch(), see shaded.f.glsl.
+void RenderQueue::setLights(const std::vector<FrameLight>& lights, const LightClusterGrid& lightClusterGrid)
+{
+	if(!mLightBuffer)
+	{
+		mLightBuffer.reset(new lightBuffer(GL_TEXTURE_BUFFER));
+		mClusterBuffer.reset(new clusterBuffer(GL_TEXTURE_BUFFER));
+		mLightIndexBuffer.reset(new lightIndexBuffer(GL_TEXTURE_BUFFER));
+
+		// The light indices are the only buffer that can get that big
+		GLint maxTextureBufferSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTextureBufferSize);
+
+		std::size_t maxLightIndices = std::max(maxTextureBufferSize, LIGHT_CLUSTER_MIN_TEXTURE_BUFFER_SIZE);
+		mMaxLightIndices = std::min(maxLightIndices, static_cast<std::size_t>(LIGHT_CLUSTER_MAX_LIGHT_INDICES));
+	}
+
+	// New storage every frame. Texture buffers can't read a range of the stream buffer in OpenGL 3.3.
+	mLightBuffer->setMutableData(lights, GL_STREAM_DRAW);
+	mClusterBuffer->setMutableData(lightClusterGrid.getClusters(), GL_STREAM_DRAW);
+	mLightIndexBuffer->setMutableData(lightClusterGrid.getLightIndices(), GL_STREAM_DRAW);
+
+	bindTextureBuffer(LIGHT_CLUSTER_UNIT_LIGHTS, mLightTextures[0], GL_RGBA32F, mLightBuffer->getID()); // 3 texels per light
+	bindTextureBuffer(LIGHT_CLUSTER_UNIT_CLUSTERS, mLightTextures[1], GL_RG32UI, mClusterBuffer->getID());
+	bindTextureBuffer(LIGHT_CLUSTER_UNIT_LIGHT_INDICES, mLightTextures[2], GL_R16UI, mLightIndexBuffer->getID());
+}
+
+// The most light indices a LightClusterGrid can have for us, see LightClusterGrid::build().
+// Until the lights are first set, it's what every OpenGL 3.3 driver takes.
+std::size_t RenderQueue::getMaxLightIndices() const
+{
+	return mMaxLightIndices;
+}
+
+// Renders in the current order, call sort() first
+void RenderQueue::render(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	buildBatches();
+
+	GLuint instanceBuffer = 0;
+	std::size_t firstInstance = 0; // Of the frame, in the stream buffer
+
+	if(!mInstanceData.empty())
+	{
+		// Aligned on whole InstanceData, so batches can point to their first instance
+		StreamBuffer& streamBuffer = *Graphics::getStreamBuffer();
+		GLintptr offset = streamBuffer.write(mInstanceData, sizeof(InstanceData));
+
+		instanceBuffer = streamBuffer.getID();
+		firstInstance = offset / sizeof(InstanceData);
+	}
+
+	// Lit objects come first with the deferred path, then the G-buffer is lit before the others
+	bool deferred = !mBatches.empty() && mBatches.front().pass == RENDER_PASS_DEFERRED_GEOMETRY;
+	bool lit = false;
+
+	if(deferred)
+		mDeferredRenderer->beginGeometryPass();
+
+	for(const auto &batch : mBatches)
+	{
+		const RenderItem& renderItem = *mEntries[batch.firstEntry].renderItem;
+
+		if(deferred && !lit && batch.pass != RENDER_PASS_DEFERRED_GEOMETRY)
+		{
+			mDeferredRenderer->renderLightingPass(projectionMatrix, mRenderState);
+			lit = true;
+		}
+
+		if(batch.instanced)
+		{
+			InstanceBatch instanceBatch;
+			instanceBatch.renderItem = &renderItem;
+			instanceBatch.instanceBuffer = instanceBuffer;
+			instanceBatch.firstInstance = firstInstance + batch.firstInstance;
+			instanceBatch.instanceCount = static_cast<int>(batch.entryCount);
+
+			renderItem.object->renderInstanced(instanceBatch, viewMatrix, projectionMatrix, mRenderState);
+		} else
+			renderItem.object->render(renderItem, viewMatrix, projectionMatrix, mRenderState);
+	}
+
+	if(deferred && !lit) // Only lit objects
+		mDeferredRenderer->renderLightingPass(projectionMatrix, mRenderState);
+
+	mRenderState.reset();
+}
@@ -0,0 +1,145 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Draws render items sorted by a 64-bit key (pass, shader, texture, geometry, depth), so items sharing
+// state end up next to each other and RenderState can skip what consecutive items have in common.
+// Consecutive items that can be instanced (see Shader::setInstancedShader()) are drawn with one instanced draw call.
+// Items outside of the camera's frustum are culled when added, using their geometry's bounds.
+// Geometries with levels of detail are swapped for the coarsest one that looks the same from where they are.
+// It also uploads what every shader can read for the frame: FrameData and the clustered lights.
+// FrameData and instance data are streamed through Graphics::getStreamBuffer().
+// With the deferred rendering path, lit objects are drawn in a first pass with DeferredRenderer's geometry shader.
+// Shadow maps of shadow casting lights are updated before anything is drawn, see ShadowMapCache.
+// With static batching, static items are merged into a few big ones before anything else, see StaticBatcher.
+// Use it on the thread owning the OpenGL context.
+
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <RenderSnapshot.hpp>
+#include <RenderState.hpp>
+#include <GPUBuffer.hpp>
+#include <Frustum.hpp>
+#include <DeferredRenderer.hpp>
+#include <ShadowMapCache.hpp>
+#include <StaticBatcher.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint> // For std::uint64_t
+#include <vector>
+#include <deque>
+#include <memory> // For std::unique_ptr
+#include <atomic>
+
+class RenderQueue
+{
+private:
+	struct Entry
+	{
+		std::uint64_t key;
+		const RenderItem* renderItem; // Must live until render()
+	};
+
+	// Entries drawn together
+	struct Batch
+	{
+		std::size_t firstEntry;
+		std::size_t entryCount;
+		std::size_t firstInstance; // In mInstanceData, only for instanced batches
+		bool instanced;
+		int pass; // RENDER_PASS_*
+	};
+
+	using entryVector = std::vector<Entry>;
+	using batchVector = std::vector<Batch>;
+	using lightBuffer = GPUBuffer<FrameLight>;
+	using clusterBuffer = GPUBuffer<LightClusterGrid::Cluster>;
+	using lightIndexBuffer = GPUBuffer<GLushort>;
+
+	entryVector mEntries;
+	batchVector mBatches;
+	std::vector<InstanceData> mInstanceData; // For every instanced batch of the frame, uploaded at once
+	std::unique_ptr<lightBuffer> mLightBuffer; // Texture buffers of the lights and their clusters, created when first needed (the queue can exist before OpenGL)
+	std::unique_ptr<clusterBuffer> mClusterBuffer;
+	std::unique_ptr<lightIndexBuffer> mLightIndexBuffer;
+	GLuint mLightTextures[3]; // Textures reading the 3 buffers above, 0 until created
+	std::atomic<std::size_t> mMaxLightIndices; // Fits in a texture buffer, read when filling snapshots on the simulation thread
+	RenderState mRenderState;
+
+	std::unique_ptr<DeferredRenderer> mDeferredRenderer; // Only with the deferred rendering path
+	std::deque<RenderItem> mDeferredItems; // Copies of lit items using the geometry shader, a deque so entries can point to them
+
+	std::unique_ptr<ShadowMapCache> mShadowMapCache; // Without it, lights have no shadows
+
+	std::unique_ptr<StaticBatcher> mStaticBatcher; // Created when batching is first used, dropped when turned off
+	std::atomic<bool> mStaticBatching; // Can be set from the simulation thread
+
+	std::atomic<bool> mLODSelection; // Can be set from the simulation thread
+	std::deque<RenderItem> mLODItems; // Copies of items using a simpler geometry, a deque so entries can point to them
+
+	std::atomic<bool> mFrustumCulling; // Can be set from the simulation thread
+	std::vector<glm::vec4> mBoundingSpheres; // In world space, for the items being added
+	std::vector<unsigned char> mCullResults;
+
+	static std::uint64_t packKeyField(std::uint64_t key, std::uint64_t value, int bits);
+	static int getKeyPass(std::uint64_t key);
+	static bool canInstanceTogether(const RenderItem& first, const RenderItem& other);
+	static void bindTextureBuffer(GLenum unit, GLuint& texture, GLenum format, GLuint buffer);
+
+	void buildBatches();
+	const RenderItem& selectLOD(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	static std::uint64_t generateKey(int pass, GLuint shaderID, GLuint textureID, GLuint geometryID, float depth);
+
+	void setDeferredShading(DeferredRenderer::constShaderPointer geometryShader, DeferredRenderer::constShaderPointer lightingShader);
+	int getRenderingPath() const;
+	void setShadowMapping(ShadowMapCache::constShaderPointer shader);
+
+	void setStaticBatching(bool batching);
+	bool isStaticBatching() const;
+	const RenderSnapshot::renderItemVector& batchStaticItems(const RenderSnapshot::renderItemVector& renderItems);
+
+	void clear();
+	void addRenderItem(const RenderItem& renderItem, const glm::mat4& viewMatrix);
+	void addRenderItems(const RenderSnapshot::renderItemVector& renderItems, const glm::mat4& viewMatrix,
+		const glm::mat4& projectionMatrix, const Frustum& frustum);
+	std::size_t getLength() const;
+
+	void setLODSelection(bool selection);
+	bool isLODSelection() const;
+
+	void setFrustumCulling(bool culling);
+	bool isFrustumCulling() const;
+
+	void sort();
+	void renderShadowMaps(const RenderSnapshot::renderItemVector& renderItems, const std::vector<FrameLight>& lights,
+		const glm::ivec4& shadowLights);
+	void setFrameData(const FrameData& frameData);
+	void setLights(const std::vector<FrameLight>& lights, const LightClusterGrid& lightClusterGrid);
+	std::size_t getMaxLightIndices() const;
+	void render(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+};
+
+#endif /* RENDER_QUEUE_HPP */
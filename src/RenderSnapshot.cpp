@@ -0,0 +1,181 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <RenderSnapshot.hpp>
+#include <Object.hpp>
+#include <RenderQueue.hpp>
+#include <Frustum.hpp>
+#include <Light.hpp>
+#include <ShadowMapCache.hpp>
+
+#include <cmath> // For std::sqrt
+
+RenderSnapshot::RenderSnapshot()
+{
+	setCameraMatrices(glm::mat4(1.0f), glm::mat4(1.0f));
+	mFrameData.clusterDepthScale = mLightClusterGrid.getDepthScale();
+	mFrameData.clusterGridSize = glm::ivec4(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y, LIGHT_CLUSTER_GRID_Z, 0);
+	mFrameData.lightCount = 0;
+	mFrameData.shadowLights = glm::ivec4(-1);
+}
+
+RenderSnapshot::~RenderSnapshot()
+{
+	// Do nothing
+}
+
+// Empties the snapshot but keeps the memory around for the next frame.
+// This can release the last pointer to shaders and all, so call it on the render thread!
+void RenderSnapshot::clear()
+{
+	mRenderItems.clear();
+	mDebugShapes.clear();
+	mLights.clear();
+	mLightClusterGrid.clear();
+	mFrameData.lightCount = 0;
+	mFrameData.shadowLights = glm::ivec4(-1);
+}
+
+void RenderSnapshot::setCameraMatrices(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	mFrameData.viewMatrix = viewMatrix;
+	mFrameData.projectionMatrix = projectionMatrix;
+	mFrameData.viewProjectionMatrix = projectionMatrix * viewMatrix;
+	mFrameData.cameraPosition = glm::vec4(glm::vec3(glm::inverse(viewMatrix)[3]), 1.0f); // Where the view matrix moves the origin from
+}
+
+const glm::mat4& RenderSnapshot::getViewMatrix() const
+{
+	return mFrameData.viewMatrix;
+}
+
+const glm::mat4& RenderSnapshot::getProjectionMatrix() const
+{
+	return mFrameData.projectionMatrix;
+}
+
+// Only lights that are on are kept, up to LIGHT_CLUSTER_MAX_LIGHTS. The rest are ignored.
+// The first SHADOW_MAP_MAX_LIGHTS shadow casting lights get a shadow map slot.
+// Call buildLightClusters() after adding them all.
+void RenderSnapshot::addLight(Light& light)
+{
+	if(!light.isOn() || mLights.size() >= LIGHT_CLUSTER_MAX_LIGHTS)
+		return;
+
+	// Lights are in meters and powers are for distances in meters, shaders work in pixels
+	glm::vec3 position = light.getPhysicsBody().getInterpolatedPosition() * PHYSICS_PIXELS_PER_METER;
+	float power = light.getPower() * PHYSICS_PIXELS_PER_METER * PHYSICS_PIXELS_PER_METER;
+
+	// Where the brightest color of the light gets too dim to see (power / distance^2 < LIGHT_CLUSTER_MIN_INTENSITY)
+	glm::vec3 diffuseColor = light.getDiffuseColor();
+	glm::vec3 specularColor = light.getSpecularColor();
+	float brightest = glm::max(glm::max(glm::max(diffuseColor.r, diffuseColor.g), diffuseColor.b),
+		glm::max(glm::max(specularColor.r, specularColor.g), specularColor.b));
+	float range = std::sqrt(glm::max(power * brightest, 0.0f) / LIGHT_CLUSTER_MIN_INTENSITY);
+
+	if(range <= 0.0f) // Lights nothing
+		return;
+
+	FrameLight frameLight;
+	frameLight.position = glm::vec4(position, power);
+	frameLight.diffuseColor = glm::vec4(diffuseColor, 1.0f);
+	frameLight.specularColor = glm::vec4(specularColor, range);
+
+	mLights.push_back(frameLight);
+	mFrameData.lightCount = static_cast<int>(mLights.size());
+
+	if(!light.isShadowCasting())
+		return;
+
+	// The first free shadow map slot, if there is one
+	for(int slot = 0; slot < SHADOW_MAP_MAX_LIGHTS; slot++)
+	{
+		if(mFrameData.shadowLights[slot] >= 0)
+			continue;
+
+		mFrameData.shadowLights[slot] = mFrameData.lightCount - 1;
+
+		for(int face = 0; face < SHADOW_MAP_FACE_COUNT; face++)
+			mFrameData.shadowMatrices[slot * SHADOW_MAP_FACE_COUNT + face] =
+				ShadowMapCache::generateTextureMatrix(position, range, slot, face);
+
+		break;
+	}
+}
+
+// Lists the lights reaching each cluster of the camera's view, with jobs if there is a job system
+// maxLightIndices comes from the queue rendering the snapshot, see RenderQueue::getMaxLightIndices()
+void RenderSnapshot::buildLightClusters(std::size_t maxLightIndices, JobSystem* jobSystem)
+{
+	mLightClusterGrid.build(mLights, mFrameData.viewMatrix, mFrameData.projectionMatrix, maxLightIndices, jobSystem);
+	mFrameData.clusterDepthScale = mLightClusterGrid.getDepthScale();
+}
+
+const FrameData& RenderSnapshot::getFrameData() const
+{
+	return mFrameData;
+}
+
+const std::vector<FrameLight>& RenderSnapshot::getLights() const
+{
+	return mLights;
+}
+
+const LightClusterGrid& RenderSnapshot::getLightClusterGrid() const
+{
+	return mLightClusterGrid;
+}
+
+// Returns a new item to fill
+RenderItem& RenderSnapshot::addRenderItem()
+{
+	mRenderItems.push_back(RenderItem());
+	return mRenderItems.back();
+}
+
+const RenderSnapshot::renderItemVector& RenderSnapshot::getRenderItems() const
+{
+	return mRenderItems;
+}
+
+PhysicsBody::debugShapeVector& RenderSnapshot::getDebugShapes()
+{
+	return mDebugShapes;
+}
+
+// Call on the thread owning the OpenGL context
+// Items are culled and drawn sorted by state through the queue, after the shadow maps are updated
+// Static items may be replaced by batches first
+void RenderSnapshot::render(RenderQueue& renderQueue) const
+{
+	Frustum frustum(mFrameData.viewProjectionMatrix);
+	const auto& renderItems = renderQueue.batchStaticItems(mRenderItems);
+
+	renderQueue.clear();
+	renderQueue.addRenderItems(renderItems, mFrameData.viewMatrix, mFrameData.projectionMatrix, frustum);
+	renderQueue.sort();
+	renderQueue.renderShadowMaps(renderItems, mLights, mFrameData.shadowLights);
+	renderQueue.setFrameData(mFrameData);
+	renderQueue.setLights(mLights, mLightClusterGrid);
+	renderQueue.render(mFrameData.viewMatrix, mFrameData.projectionMatrix);
+	renderQueue.clear(); // Don't keep pointers to our items
+
+	for(const auto &debugShape : mDebugShapes)
+		PhysicsBody::drawDebugShape(debugShape);
+}
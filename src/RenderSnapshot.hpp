@@ -0,0 +1,126 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// An immutable copy of what needs to be drawn for a frame.
+// The simulation fills one while the render thread draws the other, so they never touch the same data.
+
+#ifndef RENDER_SNAPSHOT_HPP
+#define RENDER_SNAPSHOT_HPP
+
+#include <PhysicsBody.hpp> // For debug shapes
+#include <LightClusterGrid.hpp>
+#include <Definitions.hpp>
+
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+
+#include <memory>
+#include <vector>
+#include <cstddef> // For std::size_t
+
+class Object;
+class RenderQueue;
+class Shader;
+class Texture;
+class ObjectGeometry;
+class Light;
+class JobSystem;
+
+// Everything the render thread needs to draw one object
+struct RenderItem
+{
+	std::shared_ptr<const Object> object; // Picks the render function and keeps the object alive, its state is never read while rendering
+	std::shared_ptr<const Shader> shader;
+	std::shared_ptr<const Texture> texture; // Empty for objects without textures
+	std::shared_ptr<const ObjectGeometry> objectGeometry;
+	glm::mat4 modelMatrix;
+	bool staticBody; // PHYSICS_BODY_STATIC, its shadows are cached (see ShadowMapCache)
+};
+
+// Per instance vertex attributes of instanced shaders
+struct InstanceData
+{
+	glm::mat4 modelMatrix;
+	glm::mat3 normalMatrix; // In world space, the shader applies the view
+};
+
+// Items of the same object type, sharing a shader, a texture and a geometry, drawn with one call
+struct InstanceBatch
+{
+	const RenderItem* renderItem; // The first item, its shader, texture and geometry are used
+	GLuint instanceBuffer; // Holds the InstanceData of every item
+	std::size_t firstInstance; // Index of our first InstanceData in the buffer
+	int instanceCount;
+};
+
+// The "FrameData" uniform block every engine shader can use, uploaded once per frame.
+// std140: only 16-byte aligned types, so C++ lays it out like OpenGL does.
+struct FrameData
+{
+	glm::mat4 viewMatrix;
+	glm::mat4 projectionMatrix;
+	glm::mat4 viewProjectionMatrix;
+	glm::vec4 cameraPosition; // World space (pixels), w is unused
+	glm::vec4 clusterDepthScale; // See LightClusterGrid::getDepthScale()
+	glm::ivec4 clusterGridSize; // Clusters on x, y and z, w is unused
+	int lightCount; // In the light texture buffer, see RenderQueue::setLights()
+	int padding[3];
+	glm::ivec4 shadowLights; // The light using each shadow map slot (index in the lights), -1 for unused slots
+	glm::mat4 shadowMatrices[SHADOW_MAP_MAX_LIGHTS * SHADOW_MAP_FACE_COUNT]; // World space to atlas, see ShadowMapCache
+};
+
+class RenderSnapshot
+{
+public:
+	using renderItemVector = std::vector<RenderItem>;
+
+private:
+	FrameData mFrameData; // Has the camera's matrices
+
+	std::vector<FrameLight> mLights;
+	LightClusterGrid mLightClusterGrid;
+
+	renderItemVector mRenderItems;
+	PhysicsBody::debugShapeVector mDebugShapes;
+
+public:
+	RenderSnapshot();
+	~RenderSnapshot();
+
+	void clear();
+
+	void setCameraMatrices(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+	const glm::mat4& getViewMatrix() const;
+	const glm::mat4& getProjectionMatrix() const;
+
+	void addLight(Light& light);
+	void buildLightClusters(std::size_t maxLightIndices, JobSystem* jobSystem);
+	const FrameData& getFrameData() const;
+	const std::vector<FrameLight>& getLights() const;
+	const LightClusterGrid& getLightClusterGrid() const;
+
+	RenderItem& addRenderItem();
+	const renderItemVector& getRenderItems() const;
+
+	PhysicsBody::debugShapeVector& getDebugShapes();
+
+	void render(RenderQueue& renderQueue) const;
+};
+
+#endif /* RENDER_SNAPSHOT_HPP */
@@ -0,0 +1,83 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <RenderState.hpp>
+#include <RenderSnapshot.hpp> // For InstanceData
+#include <Graphics.hpp>
+#include <GLState.hpp>
+#include <Definitions.hpp>
+
+#include <cstddef> // For offsetof
+
+RenderState::RenderState()
+{
+	// Do nothing
+}
+
+RenderState::~RenderState()
+{
+	// Do nothing
+}
+
+// Returns true if the program changed, so the caller can set uniforms that stay the same for the whole program
+bool RenderState::useProgram(GLuint program)
+{
+	return GLState::useProgram(program);
+}
+
+// Objects only use the first unit for now
+void RenderState::bindTexture(GLuint texture)
+{
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+}
+
+// See ObjectGeometry::getVertexArray()
+void RenderState::useVertexArray(GLuint vertexArray)
+{
+	GLState::bindVertexArray(vertexArray);
+}
+
+// Points the per instance attributes of the bound (instanced) vertex array to the InstanceData at firstInstance in the buffer
+void RenderState::useInstances(GLuint instanceBuffer, std::size_t firstInstance)
+{
+	std::size_t offset = firstInstance * sizeof(InstanceData);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	// One attribute per column
+	for(int i = 0; i < 4; i++)
+	{
+		std::size_t columnOffset = offset + offsetof(InstanceData, modelMatrix) + i * sizeof(glm::vec4);
+		glVertexAttribPointer(RENDER_INSTANCE_ATTRIBUTE_MODEL_MATRIX + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			reinterpret_cast<void*>(columnOffset));
+	}
+
+	for(int i = 0; i < 3; i++)
+	{
+		std::size_t columnOffset = offset + offsetof(InstanceData, normalMatrix) + i * sizeof(glm::vec3);
+		glVertexAttribPointer(RENDER_INSTANCE_ATTRIBUTE_NORMAL_MATRIX + i, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			reinterpret_cast<void*>(columnOffset));
+	}
+}
+
+// Call when done rendering, leaves OpenGL like the rest of the engine expects it
+void RenderState::reset()
+{
+	GLState::bindVertexArray(Graphics::getDefaultVertexArray());
+}
@@ -0,0 +1,44 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// The OpenGL state objects set while rendering a queue. GLState remembers it and skips what is already set.
+
+#ifndef RENDER_STATE_HPP
+#define RENDER_STATE_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef> // For std::size_t
+
+class RenderState
+{
+public:
+	RenderState();
+	~RenderState();
+
+	bool useProgram(GLuint program);
+	void bindTexture(GLuint texture);
+	void useVertexArray(GLuint vertexArray);
+	void useInstances(GLuint instanceBuffer, std::size_t firstInstance);
+
+	void reset();
+};
+
+#endif /* RENDER_STATE_HPP */
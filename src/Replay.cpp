@@ -0,0 +1,276 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <Replay.hpp>
+#include <Definitions.hpp>
+#include <Utils.hpp>
+
+#include <cstring> // For memcmp
+
+namespace
+{
+	template<typename T>
+	void writeValue(std::ofstream& file, T value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	bool readValue(std::ifstream& file, T& value)
+	{
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+}
+
+Replay::Replay()
+{
+	mMode = REPLAY_MODE_OFF;
+	mSeed = 0;
+	mFrameCount = 0;
+
+	mFrameTime = 0;
+	mFrameStepCount = 0;
+}
+
+Replay::~Replay()
+{
+	stop();
+}
+
+// Reads the next frame from the file
+// Returns false if there are no more frames
+bool Replay::readFrame()
+{
+	std::int32_t stepCount;
+	std::int32_t eventCount;
+
+	if(!readValue(mInputFile, mFrameTime))
+		return false; // Clean end of file
+
+	if(!readValue(mInputFile, stepCount) || !readValue(mInputFile, eventCount) || stepCount < 0 || eventCount < 0)
+	{
+		Utils::WARN("Replay '" + mPath + "' is truncated or corrupted after " + std::to_string(mFrameCount) + " frames!");
+		return false;
+	}
+
+	mFrameStepCount = stepCount;
+	mFrameEvents.resize(eventCount);
+
+	for(Event& event : mFrameEvents)
+	{
+		if(!readValue(mInputFile, event.type) || !readValue(mInputFile, event.key))
+		{
+			Utils::WARN("Replay '" + mPath + "' is truncated or corrupted after " + std::to_string(mFrameCount) + " frames!");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Replay::writeFrame(int stepCount)
+{
+	writeValue(mOutputFile, mFrameTime);
+	writeValue(mOutputFile, static_cast<std::int32_t>(stepCount));
+	writeValue(mOutputFile, static_cast<std::int32_t>(mFrameEvents.size()));
+
+	for(const Event& event : mFrameEvents)
+	{
+		writeValue(mOutputFile, event.type);
+		writeValue(mOutputFile, event.key);
+	}
+}
+
+// Returns false on failure
+bool Replay::startRecording(const std::string& path, std::int64_t stepLength, std::uint32_t seed)
+{
+	stop();
+
+	mOutputFile.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if(!mOutputFile)
+	{
+		Utils::WARN("Could not open '" + path + "' to record a replay!");
+		return false;
+	}
+
+	mOutputFile.write(REPLAY_FILE_MAGIC, 4);
+	writeValue(mOutputFile, static_cast<std::uint32_t>(REPLAY_FILE_VERSION));
+	writeValue(mOutputFile, stepLength);
+	writeValue(mOutputFile, seed);
+
+	mMode = REPLAY_MODE_RECORDING;
+	mPath = path;
+	mSeed = seed;
+	mFrameCount = 0;
+	return true;
+}
+
+// The replay must have been recorded with the same step length, or it won't simulate the same thing
+// Returns false on failure
+bool Replay::startReplaying(const std::string& path, std::int64_t stepLength)
+{
+	stop();
+
+	mInputFile.open(path, std::ios::in | std::ios::binary);
+
+	if(!mInputFile)
+	{
+		Utils::WARN("Replay '" + path + "' cannot be opened or doesn't exist!");
+		return false;
+	}
+
+	char magic[4];
+	std::uint32_t version = 0;
+	std::int64_t recordedStepLength = 0;
+	std::uint32_t seed = 0;
+
+	mInputFile.read(magic, 4);
+	bool validHeader = mInputFile && std::memcmp(magic, REPLAY_FILE_MAGIC, 4) == 0
+		&& readValue(mInputFile, version) && readValue(mInputFile, recordedStepLength) && readValue(mInputFile, seed);
+
+	if(!validHeader || version != REPLAY_FILE_VERSION)
+	{
+		mInputFile.close();
+		Utils::WARN("'" + path + "' is not a replay, or was recorded by another version of the game!");
+		return false;
+	}
+
+	if(recordedStepLength != stepLength)
+	{
+		mInputFile.close();
+		Utils::WARN("Replay '" + path + "' was recorded with another step length, it can't be played back!");
+		return false;
+	}
+
+	mMode = REPLAY_MODE_REPLAYING;
+	mPath = path;
+	mSeed = seed;
+	mFrameCount = 0;
+	return true;
+}
+
+void Replay::stop()
+{
+	if(mMode == REPLAY_MODE_RECORDING)
+	{
+		mOutputFile.close();
+		Utils::LOGPRINT("Recorded " + std::to_string(mFrameCount) + " frames to replay '" + mPath + "'.");
+	} else if(mMode == REPLAY_MODE_REPLAYING)
+	{
+		mInputFile.close();
+		Utils::LOGPRINT("Played back " + std::to_string(mFrameCount) + " frames of replay '" + mPath + "'.");
+	}
+
+	mMode = REPLAY_MODE_OFF;
+	mFrameEvents.clear();
+}
+
+bool Replay::isRecording() const
+{
+	return mMode == REPLAY_MODE_RECORDING;
+}
+
+bool Replay::isReplaying() const
+{
+	return mMode == REPLAY_MODE_REPLAYING;
+}
+
+// Lua's random numbers must be seeded with this for scripts to do the same thing again
+std::uint32_t Replay::getSeed() const
+{
+	return mSeed;
+}
+
+// Call at the start of each frame, with the time measured since the last one.
+// When replaying, elapsedTime is replaced by the recorded time.
+// Returns false when the replay is over.
+bool Replay::beginFrame(std::int64_t& elapsedTime)
+{
+	if(mMode == REPLAY_MODE_REPLAYING)
+	{
+		if(!readFrame())
+			return false;
+
+		elapsedTime = mFrameTime;
+	} else
+	{
+		mFrameTime = elapsedTime;
+		mFrameEvents.clear();
+	}
+
+	return true;
+}
+
+// Only events that change what the game does are kept
+void Replay::recordEvent(const SDL_Event& event)
+{
+	if(mMode != REPLAY_MODE_RECORDING)
+		return;
+
+	Event recordedEvent;
+	recordedEvent.type = event.type;
+	recordedEvent.key = 0;
+
+	if(event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+		recordedEvent.key = event.key.keysym.sym;
+	else if(event.type != SDL_QUIT)
+		return;
+
+	mFrameEvents.push_back(recordedEvent);
+}
+
+// The recorded events of this frame, rebuilt as SDL events
+std::vector<SDL_Event> Replay::getFrameEvents() const
+{
+	std::vector<SDL_Event> events(mFrameEvents.size());
+
+	for(std::size_t i = 0; i < mFrameEvents.size(); i++)
+	{
+		SDL_Event& event = events[i];
+		std::memset(&event, 0, sizeof(SDL_Event));
+
+		event.type = mFrameEvents[i].type;
+		if(event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+		{
+			event.key.state = (event.type == SDL_KEYDOWN) ? SDL_PRESSED : SDL_RELEASED;
+			event.key.keysym.sym = mFrameEvents[i].key;
+		}
+	}
+
+	return events;
+}
+
+// How many steps were done in this frame when it was recorded
+int Replay::getFrameStepCount() const
+{
+	return mFrameStepCount;
+}
+
+// Call once the frame is simulated. Can be called from the simulation thread.
+void Replay::endFrame(int stepCount)
+{
+	if(mMode == REPLAY_MODE_RECORDING)
+		writeFrame(stepCount);
+	else if(mMode != REPLAY_MODE_REPLAYING)
+		return;
+
+	mFrameCount++;
+}
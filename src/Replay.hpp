@@ -0,0 +1,85 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Records what a play-through depends on (input events, frame times and step counts) into a binary file,
+// and plays it back later. Replayed frames use the recorded times and step counts instead of the clock,
+// so the same session can be simulated again (and profiled) as many times as we want.
+//
+// File layout (native byte order):
+//   header: "S3DR", uint32 version, int64 step length (ns), uint32 random seed
+//   frames: int64 elapsed time (ns), int32 step count, int32 event count, then event count * (uint32 type, int32 key)
+
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <SDL.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+class Replay
+{
+public:
+	// Only what the game looks at in an SDL_Event
+	struct Event
+	{
+		std::uint32_t type;
+		std::int32_t key; // SDL keycode, for keyboard events
+	};
+
+private:
+	int mMode; // REPLAY_MODE_*
+	std::string mPath;
+	std::ofstream mOutputFile;
+	std::ifstream mInputFile;
+
+	std::uint32_t mSeed;
+	int mFrameCount;
+
+	// The current frame
+	std::int64_t mFrameTime;
+	int mFrameStepCount;
+	std::vector<Event> mFrameEvents;
+
+	bool readFrame();
+	void writeFrame(int stepCount);
+
+public:
+	Replay();
+	~Replay();
+
+	bool startRecording(const std::string& path, std::int64_t stepLength, std::uint32_t seed);
+	bool startReplaying(const std::string& path, std::int64_t stepLength);
+	void stop();
+
+	bool isRecording() const;
+	bool isReplaying() const;
+	std::uint32_t getSeed() const;
+
+	bool beginFrame(std::int64_t& elapsedTime);
+	void recordEvent(const SDL_Event& event);
+	std::vector<SDL_Event> getFrameEvents() const;
+	int getFrameStepCount() const;
+	void endFrame(int stepCount);
+};
+
+#endif /* REPLAY_HPP */
@@ -36,12 +36,16 @@
 ResourceManager::ResourceManager()
 {
 	mBasePath = "";
+	mJobSystem = nullptr;
+	mLODGeneration = DEFAULT_RESOURCE_MANAGER_LOD_GENERATION;
 }
 
 
 ResourceManager::ResourceManager(const std::string& basePath)
 {
 	mBasePath = basePath;
+	mJobSystem = nullptr;
+	mLODGeneration = DEFAULT_RESOURCE_MANAGER_LOD_GENERATION;
 }
 
 ResourceManager::~ResourceManager()
@@ -97,6 +101,24 @@ void ResourceManager::setBasePath(const std::string& basePath)
 	mBasePath = basePath;
 }
 
+// Without a job system, everything loads on the calling thread
+void ResourceManager::setJobSystem(JobSystem* jobSystem)
+{
+	mJobSystem = jobSystem;
+}
+
+// Object geometry groups loaded after this get levels of detail (see ObjectGeometryGroup::generateLODs()).
+// Makes loading slower, but dense geometries get much cheaper from afar.
+void ResourceManager::setLODGeneration(bool generation)
+{
+	mLODGeneration = generation;
+}
+
+bool ResourceManager::isLODGeneration() const
+{
+	return mLODGeneration;
+}
+
 // Returns the full absolute resource path
 // Example: level1/fun.obj -> C:/Program Files/SDL3D/resources/level1/fun.obj
 // This makes sure it will on most platforms and if the game is being launched from somewhere else
@@ -218,11 +240,59 @@ void ResourceManager::clearTextures()
 
 
 /////// ObjectGeometryGroups ///////
+// Private
+// Every geometry of every file gets its own job, the big ones take a while
+void ResourceManager::generateLODs(std::vector<ObjectGeometryGroup::geometryDataVector>& geometryData)
+{
+	if(!mLODGeneration)
+		return;
+
+	std::vector<ObjectGeometryGroup::GeometryData*> geometries;
+
+	for(auto &fileData : geometryData)
+	{
+		for(auto &data : fileData)
+			geometries.push_back(&data);
+	}
+
+	auto generate = [&](std::size_t begin, std::size_t end)
+	{
+		for(std::size_t i = begin; i < end; i++)
+			ObjectGeometryGroup::generateLODs(*geometries[i]);
+	};
+
+	if(mJobSystem)
+		mJobSystem->parallelFor(geometries.size(), 1, generate);
+	else
+		generate(0, geometries.size());
+}
+
 ResourceManager::objectGeometryGroup_pointer
 	ResourceManager::addObjectGeometryGroup(const std::string& name, const std::string& objectFile)
 {
 	std::string path = getFullResourcePath(objectFile);
-	objectGeometryGroup_pointer group(new ObjectGeometryGroup(name, path));
+	objectGeometryGroup_pointer group;
+
+	if(mLODGeneration)
+	{
+		std::vector<ObjectGeometryGroup::geometryDataVector> geometryData(1);
+		std::string error;
+		std::vector<std::string> warnings;
+
+		bool success = ObjectGeometryGroup::readOBJFile(path, name, geometryData[0], error, warnings);
+
+		for(const auto &warning : warnings)
+			Utils::WARN(warning);
+
+		if(!success)
+			Utils::CRASH(error);
+
+		generateLODs(geometryData);
+
+		group.reset(new ObjectGeometryGroup(name));
+		group->addGeometryData(geometryData[0]);
+	} else
+		group.reset(new ObjectGeometryGroup(name, path));
 
 	return addObjectGeometryGroup(group);
 }
@@ -254,6 +324,60 @@ ResourceManager::objectGeometryGroup_pointer
 	return newlyAddedPair.first->second;
 }
 
+// Loads many .obj files at once. Groups are named after their files.
+// The files are read (and their levels of detail generated) in parallel on the job system, then put on the GPU here
+// since only this thread has the OpenGL context. Errors and warnings are reported here too, not from the jobs.
+ResourceManager::objectGeometryGroup_vector
+	ResourceManager::addObjectGeometryGroups(const std::vector<std::string>& objectFiles)
+{
+	std::vector<std::string> paths;
+	std::vector<std::string> names;
+	std::vector<ObjectGeometryGroup::geometryDataVector> geometryData(objectFiles.size());
+	std::vector<unsigned char> loaded(objectFiles.size()); // Not vector<bool>, jobs write next to each other
+	std::vector<std::string> errors(objectFiles.size());
+	std::vector<std::vector<std::string>> warnings(objectFiles.size());
+
+	for(const auto &objectFile : objectFiles)
+	{
+		paths.push_back(getFullResourcePath(objectFile));
+		names.push_back(getBasename(objectFile));
+	}
+
+	auto readFiles = [&](std::size_t begin, std::size_t end)
+	{
+		for(std::size_t i = begin; i < end; i++)
+			loaded[i] = ObjectGeometryGroup::readOBJFile(paths[i], names[i], geometryData[i], errors[i], warnings[i]);
+	};
+
+	if(mJobSystem)
+		mJobSystem->parallelFor(objectFiles.size(), 1, readFiles); // One file per job
+	else
+		readFiles(0, objectFiles.size());
+
+	for(std::size_t i = 0; i < objectFiles.size(); i++)
+	{
+		for(const auto &warning : warnings[i])
+			Utils::WARN(warning);
+
+		if(!loaded[i])
+			Utils::CRASH(errors[i]);
+	}
+
+	generateLODs(geometryData);
+
+	objectGeometryGroup_vector groups;
+
+	for(std::size_t i = 0; i < objectFiles.size(); i++)
+	{
+		objectGeometryGroup_pointer group(new ObjectGeometryGroup(names[i]));
+		group->addGeometryData(geometryData[i]);
+
+		groups.push_back(addObjectGeometryGroup(group));
+	}
+
+	return groups;
+}
+
 ResourceManager::objectGeometryGroup_pointer
 	ResourceManager::findObjectGeometryGroup(const std::string& name) // Gives a pointer
 {
@@ -25,6 +25,7 @@
 #include <ObjectGeometryGroup.hpp>
 #include <Script.hpp>
 #include <Sound.hpp>
+#include <JobSystem.hpp>
 
 #include <Definitions.hpp>
 
@@ -32,6 +33,7 @@
 #include <string>
 
 #include <map>
+#include <vector>
 #include <memory> // For shared_ptr
 
 // All paths are prefixed with mResourceDir
@@ -46,6 +48,8 @@ public:
 	using scriptPointer                 = std::shared_ptr<Script>;
 	using soundPointer                  = std::shared_ptr<Sound>;
 
+	using objectGeometryGroup_vector    = std::vector<objectGeometryGroup_pointer>;
+
 private:
 	// Each map will hold shared_ptrs to instances. When you remove this from the map, the instance will stay alive until all
 	// shared_ptrs pointing to it are gone.
@@ -71,6 +75,10 @@ private:
 	soundMap mSoundMap;
 
 	std::string mBasePath; // This is directory the game is in or, in a Mac bundle, the bundle's Resources directory. Absolute path.
+	JobSystem* mJobSystem; // For loading in parallel, can be null. Don't destroy this!
+	bool mLODGeneration; // Simplified levels of detail for loaded object geometries
+
+	void generateLODs(std::vector<ObjectGeometryGroup::geometryDataVector>& geometryData);
 
 public:
 	ResourceManager();
@@ -80,6 +88,9 @@ public:
 	static std::string getBasename(const std::string& path);
 
 	void setBasePath(const std::string& basePath);
+	void setJobSystem(JobSystem* jobSystem);
+	void setLODGeneration(bool generation);
+	bool isLODGeneration() const;
 	std::string getFullResourcePath(const std::string& path);
 	std::string getFullShaderPath(const std::string& path);
 	std::string getFullScriptPath(const std::string& path);
@@ -98,6 +109,7 @@ public:
 	objectGeometryGroup_pointer addObjectGeometryGroup(const std::string& name, const std::string& objectFile);
 	objectGeometryGroup_pointer addObjectGeometryGroup(const std::string& objectFile);
 	objectGeometryGroup_pointer addObjectGeometryGroup(objectGeometryGroup_pointer objectGeometryGroupPointer);
+	objectGeometryGroup_vector addObjectGeometryGroups(const std::vector<std::string>& objectFiles);
 	objectGeometryGroup_pointer findObjectGeometryGroup(const std::string& objectName);
 	void clearObjectGeometryGroups();
 
@@ -23,6 +23,8 @@
 
 #include <stdio.h>
 #include <memory> // For smart pointers. C++ libraries have no .h
+#include <string>
+#include <cstdlib> // For atoi
 
 int main(int argc, char **argv)
 {
@@ -32,6 +34,36 @@ int main(int argc, char **argv)
 
 	Game game;
 
+	// --record <file> records the session, --replay <file> plays it back
+	// --headless renders without a window, --dump-frames <interval> writes every interval frames to Frame<n>.bmp
+	// --simulate-only skips graphics and audio, --speed <multiple> of real time (0 for as fast as possible)
+	// --deferred uses deferred shading for lit objects
+	bool headless = false;
+	int dumpInterval = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = (i + 1 < argc);
+
+		if(argument == "--record" && hasValue)
+			game.recordReplay(argv[++i]);
+		else if(argument == "--replay" && hasValue)
+			game.playReplay(argv[++i]);
+		else if(argument == "--headless")
+			headless = true;
+		else if(argument == "--dump-frames" && hasValue)
+			dumpInterval = std::atoi(argv[++i]);
+		else if(argument == "--simulate-only")
+			game.setSimulationOnly(true);
+		else if(argument == "--speed" && hasValue)
+			game.setSimulationSpeed(static_cast<float>(std::atof(argv[++i])));
+		else if(argument == "--deferred")
+			game.setRenderingPath(RENDERING_PATH_DEFERRED);
+	}
+
+	game.setHeadless(headless, HEADLESS_FRAME_DUMP_PREFIX, dumpInterval);
+
 	game.init();
 	game.startMainLoop(); // Runs the game, returns when the game quits
 
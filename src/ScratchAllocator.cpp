@@ -0,0 +1,84 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <ScratchAllocator.hpp>
+
+ScratchAllocator::ScratchAllocator(std::size_t blockSize)
+{
+	mBlockSize = blockSize;
+	mCurrentBlock = 0;
+	mOffset = 0;
+}
+
+ScratchAllocator::~ScratchAllocator()
+{
+	// Do nothing
+}
+
+// Returns memory that stays valid until reset()
+// Alignment must be a power of 2
+void* ScratchAllocator::allocate(std::size_t size, std::size_t alignment)
+{
+	// Try the current block, then the next ones we already have
+	while(mCurrentBlock < mBlocks.size())
+	{
+		Block& block = mBlocks[mCurrentBlock];
+		std::size_t address = reinterpret_cast<std::size_t>(block.data.get()) + mOffset;
+		std::size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+
+		if(mOffset + padding + size <= block.size)
+		{
+			void* memory = block.data.get() + mOffset + padding;
+			mOffset += padding + size;
+			return memory;
+		}
+
+		mCurrentBlock++;
+		mOffset = 0;
+	}
+
+	// Out of blocks, make one big enough even with the worst alignment
+	Block newBlock;
+	newBlock.size = (size + alignment > mBlockSize) ? size + alignment : mBlockSize;
+	newBlock.data.reset(new unsigned char[newBlock.size]);
+	mBlocks.push_back(std::move(newBlock));
+
+	mCurrentBlock = mBlocks.size() - 1;
+	mOffset = 0;
+
+	return allocate(size, alignment);
+}
+
+// Everything allocated before is now invalid
+void ScratchAllocator::reset()
+{
+	mCurrentBlock = 0;
+	mOffset = 0;
+}
+
+// In bytes
+std::size_t ScratchAllocator::getCapacity() const
+{
+	std::size_t capacity = 0;
+
+	for(const auto &block : mBlocks)
+		capacity += block.size;
+
+	return capacity;
+}
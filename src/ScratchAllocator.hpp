@@ -0,0 +1,61 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// A simple bump allocator for temporary data. Allocating is just moving an offset, and everything is
+// freed at once with reset(). Only use it for types that don't need their destructor called!
+// Not thread safe, the job system gives one to each thread.
+
+#ifndef SCRATCH_ALLOCATOR_HPP
+#define SCRATCH_ALLOCATOR_HPP
+
+#include <memory>
+#include <vector>
+#include <cstddef> // For std::size_t
+
+class ScratchAllocator
+{
+private:
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> data;
+		std::size_t size;
+	};
+
+	std::vector<Block> mBlocks; // Kept between resets, so we stop allocating after the first few frames
+	std::size_t mBlockSize; // Default size of new blocks, in bytes
+	std::size_t mCurrentBlock;
+	std::size_t mOffset; // In the current block
+
+public:
+	ScratchAllocator(std::size_t blockSize);
+	~ScratchAllocator();
+
+	void* allocate(std::size_t size, std::size_t alignment);
+	void reset();
+
+	std::size_t getCapacity() const;
+
+	template<typename T>
+	T* allocateArray(std::size_t count)
+	{
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+};
+
+#endif /* SCRATCH_ALLOCATOR_HPP */
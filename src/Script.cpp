@@ -125,6 +125,7 @@ bool Script::setLuaRequirePath(const std::string& absolutePath)
 #include <ResourceManager.hpp>
 #include <InputManager.hpp>
 #include <EntityManager.hpp>
+#include <JobSystem.hpp>
 
 #include <Shader.hpp>
 #include <Texture.hpp>
@@ -177,7 +178,23 @@ void Script::bindInterface(Game& game)
 		.addFunction("setSize", &Game::setSize)
 		.addFunction("getSize", &Game::getSize)
 
-		.addFunction("setMaxFramesPerSecond", &Game::setMaxFramesPerSecond)
+		.addFunction("setMaxFramesPerSecond", &Game::setMaxFramesPerSecond) // 0 for no limit
+		.addFunction("getLaunchParameter", &Game::getLaunchParameter)
+		.addFunction("getFrameCount", &Game::getFrameCount)
+		.addFunction("isSimulationOnly", &Game::isSimulationOnly)
+		.addFunction("getRenderingPath", &Game::getRenderingPath) // Chosen before init, with --deferred
+		.addFunction("setSimulationSpeed", &Game::setSimulationSpeed) // Multiple of real time when simulating only, 0 for as fast as possible
+		.addFunction("getSimulationSpeed", &Game::getSimulationSpeed)
+		.addFunction("setMaxStepsPerFrame", &Game::setMaxStepsPerFrame)
+		.addFunction("getMaxStepsPerFrame", &Game::getMaxStepsPerFrame)
+		.addFunction("setPipelinedRendering", &Game::setPipelinedRendering)
+		.addFunction("isPipelinedRendering", &Game::isPipelinedRendering)
+		.addFunction("setStaticBatching", &Game::setStaticBatching)
+		.addFunction("isStaticBatching", &Game::isStaticBatching)
+		.addFunction("setLODSelection", &Game::setLODSelection)
+		.addFunction("isLODSelection", &Game::isLODSelection)
+		.addFunction("setFrustumCulling", &Game::setFrustumCulling)
+		.addFunction("isFrustumCulling", &Game::isFrustumCulling)
 		.addFunction("setMainWindowPosition", &Game::setMainWindowPosition)
 		.addFunction("getMainWindowPosition", &Game::getMainWindowPosition)
 		.addFunction("reCenterMainWindow", &Game::reCenterMainWindow)
@@ -188,12 +205,47 @@ void Script::bindInterface(Game& game)
 		.addFunction("getResourceManager", &Game::getResourceManager)
 		.addFunction("getInputManager", &Game::getInputManager)
 		.addFunction("getEntityManager", &Game::getEntityManager)
+		.addFunction("getJobSystem", &Game::getJobSystem)
 	.endClass();
 
+	// Jobs themselves stay C++ side, Lua states can't be shared between threads
+	LuaBinding(luaState).beginClass<JobSystem>("JobSystem")
+		.addFunction("getWorkerCount", &JobSystem::getWorkerCount)
+		.addFunction("getThreadCount", &JobSystem::getThreadCount)
+	.endClass();
+
+	// Times are in microseconds, over the last frames. Counters work the same way.
+	LuaBinding(luaState).beginModule("Profiler")
+		.addConstant("Events", PROFILER_STAGE_EVENTS)
+		.addConstant("PhysicsBodies", PROFILER_STAGE_PHYSICS_BODIES)
+		.addConstant("PhysicsWorld", PROFILER_STAGE_PHYSICS_WORLD)
+		.addConstant("Script", PROFILER_STAGE_SCRIPT)
+		.addConstant("Render", PROFILER_STAGE_RENDER)
+		.addConstant("ErrorCheck", PROFILER_STAGE_ERROR_CHECK)
+		.addConstant("Swap", PROFILER_STAGE_SWAP)
+		.addConstant("Sleep", PROFILER_STAGE_SLEEP)
+		.addConstant("Frame", PROFILER_STAGE_FRAME)
+		.addConstant("DrawCalls", PROFILER_COUNTER_DRAW_CALLS) // A count, not a time
+		.addConstant("VisibleObjects", PROFILER_COUNTER_VISIBLE_OBJECTS)
+		.addConstant("CulledObjects", PROFILER_COUNTER_CULLED_OBJECTS)
+		.addConstant("GLCalls", PROFILER_COUNTER_GL_CALLS)
+		.addConstant("SkippedGLCalls", PROFILER_COUNTER_SKIPPED_GL_CALLS)
+
+		.addFunction("getRecordedFrames", [&game]() {return game.getProfiler().getRecordedFrames();})
+		.addFunction("getLast", [&game](int stage) {return game.getProfiler().getLast(stage);})
+		.addFunction("getMin", [&game](int stage) {return game.getProfiler().getMin(stage);})
+		.addFunction("getMax", [&game](int stage) {return game.getProfiler().getMax(stage);})
+		.addFunction("getAverage", [&game](int stage) {return game.getProfiler().getAverage(stage);})
+		.addFunction("getPercentile", [&game](int stage, float percentile) {return game.getProfiler().getPercentile(stage, percentile);})
+		.addFunction("getStats", [&game](int stage) {return game.getProfiler().getStats(stage);}) // Table with last, min, max, average, p95 and p99
+	.endModule();
+
 
 	LuaBinding(luaState).beginModule("Engine")
 		.addConstant("Name", ENGINE_NAME)
 		.addConstant("Version", ENGINE_VERSION)
+		.addConstant("ForwardRendering", RENDERING_PATH_FORWARD)
+		.addConstant("DeferredRendering", RENDERING_PATH_DEFERRED)
 	.endModule();
 
 
@@ -234,6 +286,9 @@ void Script::bindInterface(Game& game)
 			static_cast<ResourceManager::objectGeometryGroup_pointer(ResourceManager::*) (ResourceManager::objectGeometryGroup_pointer)>
 			(&ResourceManager::addObjectGeometryGroup))
 
+		.addFunction("addObjectGeometryGroups", &ResourceManager::addObjectGeometryGroups)
+		.addFunction("setLODGeneration", &ResourceManager::setLODGeneration)
+		.addFunction("isLODGeneration", &ResourceManager::isLODGeneration)
 		.addFunction("findObjectGeometryGroup", &ResourceManager::findObjectGeometryGroup)
 		.addFunction("clearObjectGeometryGroups", &ResourceManager::clearObjectGeometryGroups)
 
@@ -252,6 +307,8 @@ void Script::bindInterface(Game& game)
 
 	LuaBinding(luaState).beginClass<Shader>("Shader")
 		.addFunction("getName", &Shader::getName)
+		.addFunction("setInstancedShader", &Shader::setInstancedShader)
+		.addFunction("getInstancedShader", &Shader::getInstancedShader)
 	.endClass();
 
 
@@ -290,18 +347,31 @@ void Script::bindInterface(Game& game)
 			const ObjectGeometry::vec3Vector&))
 
 		.addFunction("getName", &ObjectGeometry::getName)
-		.addFunction("getIndexBuffer",
-			// To get the non-const version
-			static_cast<ObjectGeometry::uintBuffer&(ObjectGeometry::*) ()> (&ObjectGeometry::getIndexBuffer))
+		.addFunction("setIndices", &ObjectGeometry::setIndices)
+		.addFunction("getIndices", &ObjectGeometry::getIndices)
+
+		// Only affects geometry created after
+		.addStaticFunction("setPositionQuantization", &ObjectGeometry::setPositionQuantization)
+		.addStaticFunction("getPositionQuantization", &ObjectGeometry::getPositionQuantization)
+
+		// Model space
+		.addFunction("getBoundingBoxMin", &ObjectGeometry::getBoundingBoxMin)
+		.addFunction("getBoundingBoxMax", &ObjectGeometry::getBoundingBoxMax)
+		.addFunction("getBoundingSphereCenter", &ObjectGeometry::getBoundingSphereCenter)
+		.addFunction("getBoundingSphereRadius", &ObjectGeometry::getBoundingSphereRadius)
+
+		// Levels of detail, 1 when there are none
+		.addFunction("getLODCount", &ObjectGeometry::getLODCount)
+		.addFunction("getLODError", &ObjectGeometry::getLODError)
 
 		.addFunction("getPositionBuffer",
-			static_cast<ObjectGeometry::vec3Buffer&(ObjectGeometry::*) ()> (&ObjectGeometry::getPositionBuffer))
+			static_cast<ObjectGeometry::vec3View(ObjectGeometry::*) ()> (&ObjectGeometry::getPositionBuffer))
 
 		.addFunction("getUVBuffer",
-			static_cast<ObjectGeometry::vec2Buffer&(ObjectGeometry::*) ()> (&ObjectGeometry::getUVBuffer))
+			static_cast<ObjectGeometry::vec2View(ObjectGeometry::*) ()> (&ObjectGeometry::getUVBuffer))
 
 		.addFunction("getNormalBuffer",
-			static_cast<ObjectGeometry::vec3Buffer&(ObjectGeometry::*) ()> (&ObjectGeometry::getNormalBuffer))
+			static_cast<ObjectGeometry::vec3View(ObjectGeometry::*) ()> (&ObjectGeometry::getNormalBuffer))
 	.endClass();
 
 
@@ -328,61 +398,24 @@ void Script::bindInterface(Game& game)
 	.endModule();
 
 
-	// Bind a few useful GPUBuffers
-	LuaBinding(luaState).beginClass<ObjectGeometry::uintBuffer>("GPUBuffer_uint")
-		// We could of added a constructor, but I figured it would be pretty much useless, since we can't control
-		// how buffers are sent to shaders from Lua.
-
-		// Simplified 1-argument versions of setMutableData and setImmutableData
-		.addFunction("setMutableData",
-			static_cast<void (ObjectGeometry::uintBuffer::*)(const std::vector<unsigned int>&)>
-			(&ObjectGeometry::uintBuffer::setMutableData))
-
-		.addFunction("setImmutableData",
-			static_cast<void (ObjectGeometry::uintBuffer::*)(const std::vector<unsigned int>&)>
-			(&ObjectGeometry::uintBuffer::setImmutableData))
-
-		// No argument version of read()
-		.addFunction("read",
-			static_cast<std::vector<unsigned int>(ObjectGeometry::uintBuffer::*)() const> (&ObjectGeometry::uintBuffer::read))
-		
-		.addFunction("modify", &ObjectGeometry::uintBuffer::modify)
+	// Vertices are interleaved, but each attribute looks like its own buffer
+	LuaBinding(luaState).beginClass<ObjectGeometry::vec2View>("VertexAttributeView_vec2")
+		.addFunction("getLength", &ObjectGeometry::vec2View::getLength)
+		.addFunction("setData", &ObjectGeometry::vec2View::setData)
+		.addFunction("setMutableData", &ObjectGeometry::vec2View::setData) // Old names, when they had their own buffers
+		.addFunction("setImmutableData", &ObjectGeometry::vec2View::setData)
+		.addFunction("readData", &ObjectGeometry::vec2View::read)
+		.addFunction("modifyData", &ObjectGeometry::vec2View::modify)
 	.endClass();
 
 
-	LuaBinding(luaState).beginClass<ObjectGeometry::vec2Buffer>("GPUBuffer_vec2")
-		// Simplified 1-argument versions of setMutableData and setImmutableData
-		.addFunction("setMutableData",
-			static_cast<void (ObjectGeometry::vec2Buffer::*)(const std::vector<glm::vec2>&)>
-			(&ObjectGeometry::vec2Buffer::setMutableData))
-
-		.addFunction("setImmutableData",
-			static_cast<void (ObjectGeometry::vec2Buffer::*)(const std::vector<glm::vec2>&)>
-			(&ObjectGeometry::vec2Buffer::setImmutableData))
-
-		// No argument version of readData()
-		.addFunction("readData",
-			static_cast<std::vector<glm::vec2>(ObjectGeometry::vec2Buffer::*)() const> (&ObjectGeometry::vec2Buffer::read))
-
-		.addFunction("modifyData", &ObjectGeometry::vec2Buffer::modify)
-	.endClass();
-
-
-	LuaBinding(luaState).beginClass<ObjectGeometry::vec3Buffer>("GPUBuffer_vec3")
-		// Simplified 1-argument versions of setMutableData and setImmutableData
-		.addFunction("setMutableData",
-			static_cast<void (ObjectGeometry::vec3Buffer::*)(const std::vector<glm::vec3>&)>
-			(&ObjectGeometry::vec3Buffer::setMutableData))
-
-		.addFunction("setImmutableData",
-			static_cast<void (ObjectGeometry::vec3Buffer::*)(const std::vector<glm::vec3>&)>
-			(&ObjectGeometry::vec3Buffer::setImmutableData))
-
-		// No argument version of readData()
-		.addFunction("readData",
-			static_cast<std::vector<glm::vec3>(ObjectGeometry::vec3Buffer::*)() const> (&ObjectGeometry::vec3Buffer::read))
-		
-		.addFunction("modifyData", &ObjectGeometry::vec3Buffer::modify)
+	LuaBinding(luaState).beginClass<ObjectGeometry::vec3View>("VertexAttributeView_vec3")
+		.addFunction("getLength", &ObjectGeometry::vec3View::getLength)
+		.addFunction("setData", &ObjectGeometry::vec3View::setData)
+		.addFunction("setMutableData", &ObjectGeometry::vec3View::setData)
+		.addFunction("setImmutableData", &ObjectGeometry::vec3View::setData)
+		.addFunction("readData", &ObjectGeometry::vec3View::read)
+		.addFunction("modifyData", &ObjectGeometry::vec3View::modify)
 	.endClass();
 
 
@@ -487,6 +520,8 @@ void Script::bindInterface(Game& game)
 	LuaBinding(luaState).beginClass<EntityManager>("EntityManager")
 		.addFunction("getGameCamera", &EntityManager::getGameCamera)
 		.addFunction("addObject", &EntityManager::addObject)
+		.addFunction("addTexturedObjectBatch", &EntityManager::addTexturedObjectBatch) // One object per position in the table
+		.addFunction("addShadedObjectBatch", &EntityManager::addShadedObjectBatch)
 
 		.addFunction("removeObjectByIndex",
 			static_cast<EntityManager::objectPointer(EntityManager::*) (std::size_t)>
@@ -497,6 +532,7 @@ void Script::bindInterface(Game& game)
 			(&EntityManager::removeObject))
 
 		.addFunction("getObjects", &EntityManager::getObjects)
+		.addFunction("calculateShapes", &EntityManager::calculateShapes)
 
 		.addFunction("addLight", &EntityManager::addLight)
 
@@ -631,6 +667,9 @@ void Script::bindInterface(Game& game)
 
 		.addFunction("setOnState", &Light::setOnState)
 		.addFunction("isOn", &Light::isOn)
+
+		.addFunction("setShadowCasting", &Light::setShadowCasting)
+		.addFunction("isShadowCasting", &Light::isShadowCasting)
 	.endClass();
 
 
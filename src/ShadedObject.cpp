@@ -18,6 +18,8 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include <ShadedObject.hpp>
+#include <Profiler.hpp>
+#include <GLState.hpp>
 #include <Utils.hpp>
 
 // In:
@@ -27,11 +29,19 @@
 
 // Uniforms:
 // - mat4 MVP (precalculated)
-// - mat4 modelMatrix
-// - mat4 viewMatrix
-// - mat4 projectionMatrix
-// - mat4 normalMatrix
+// - mat4 modelMatrix (optional)
+// - mat4 normalMatrix (camera space)
 // - sampler2D textureSampler
+// - FrameData block, for the view matrix and the lights (see shaded.v.glsl)
+
+// Instanced shader in:
+// - layout locations 0 to 2: same as above
+// - layout location 3: mat4 model matrix, per instance
+// - layout location 7: mat3 normal matrix (world space), per instance
+
+// Instanced shader uniforms:
+// - sampler2D textureSampler
+// - FrameData block
 
 ShadedObject::ShadedObject(constObjectGeometryPointer objectGeometry,
 						   constShaderPointer shaderPointer, constTexturePointer texturePointer,
@@ -46,83 +56,62 @@ ShadedObject::~ShadedObject()
 	// Do nothing
 }
 
-void ShadedObject::render(const Camera& camera)
+void ShadedObject::render(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+	RenderState& renderState) const
 {
-	const ObjectGeometry::uintBuffer& indexBuffer = getObjectGeometry()->getIndexBuffer();
-	const ObjectGeometry::vec3Buffer& positionBuffer = getObjectGeometry()->getPositionBuffer();
-	const ObjectGeometry::vec2Buffer& UVBuffer = getObjectGeometry()->getUVBuffer();
-	const ObjectGeometry::vec3Buffer& normalBuffer = getObjectGeometry()->getNormalBuffer();
+	const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
 
-	glm::mat4 modelMatrix = getPhysicsBody().generateModelMatrix();
-	glm::mat4 viewMatrix = camera.getViewMatrix();
-	glm::mat4 projectionMatrix = camera.getProjectionMatrix();
+	// Vertex positions might be quantized, normals never are
+	glm::mat4 modelMatrix = renderItem.modelMatrix * objectGeometry.getPositionDecodeMatrix();
 
 	glm::mat4 MVP = projectionMatrix * viewMatrix * modelMatrix;
-	glm::mat4 modelViewMatrix = viewMatrix * modelMatrix;
+	glm::mat4 modelViewMatrix = viewMatrix * renderItem.modelMatrix;
 	glm::mat4 normalMatrix = glm::transpose(glm::inverse(modelViewMatrix));
 
-	glUseProgram(getShader()->getID());
-
-	glUniformMatrix4fv(getShader()->findUniform("MVP"), 1, GL_FALSE, &MVP[0][0]);
-	glUniformMatrix4fv(getShader()->findUniform("modelMatrix"), 1, GL_FALSE, &modelMatrix[0][0]);
-	glUniformMatrix4fv(getShader()->findUniform("viewMatrix"), 1, GL_FALSE, &viewMatrix[0][0]);
-	//glUniformMatrix4fv(getShader()->findUniform("projectionMatrix"), 1, GL_FALSE, &projectionMatrix[0][0]);
-	glUniformMatrix4fv(getShader()->findUniform("normalMatrix"), 1, GL_FALSE, &normalMatrix[0][0]);
-
-	glUniform1i(getShader()->findUniform("textureSampler"), 0); // The first texture, not necessary for now
-
-	// Attribute 0, position buffer
-	glEnableVertexAttribArray(0);
-	positionBuffer.bind(GL_ARRAY_BUFFER);
-	glVertexAttribPointer(
-		0,					// Attribute 0, no particular reason but same as the vertex shader's layout and glEnableVertexAttribArray
-		3,					// Size. Number of values per vertex, must be 1, 2, 3 or 4.
-		GL_FLOAT,			// Type of data (GLfloats)
-		GL_FALSE,			// Normalized?
-		0,					// Stride
-		(void*)0			// Array buffer offset
-	);
-
-	// Attribute 1, UV buffer
-	glEnableVertexAttribArray(1);
-	UVBuffer.bind(GL_ARRAY_BUFFER);
-
-	glVertexAttribPointer(
-		1,                // Attribute
-		2,                // Size (values per vertex)
-		GL_FLOAT,         // Type
-		GL_FALSE,         // Normalize?
-		0,                // Stride
-		(void*)0          // Array buffer offset
-	);
+	if(renderState.useProgram(renderItem.shader->getID()))
+		GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_TEXTURE_SAMPLER), 0); // The first texture, not necessary for now
 
-	// Attribute 2, normal buffer
-	glEnableVertexAttribArray(2);
-	normalBuffer.bind(GL_ARRAY_BUFFER);
-	glVertexAttribPointer(
-		2,                // Attribute
-		3,                // Size (values per vertex)
-		GL_FLOAT,         // Type
-		GL_FALSE,         // Normalize?
-		0,                // Stride
-		(void*)0          // Array buffer offset
-	);
+	GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_MVP), MVP);
+	// The deferred geometry shader doesn't need it
+	GLState::setUniform(renderItem.shader->getOptionalUniform(SHADER_UNIFORM_MODEL_MATRIX), modelMatrix);
+	GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_NORMAL_MATRIX), normalMatrix);
 
-	// Texture
-	glActiveTexture(GL_TEXTURE0); // Set the active texture unit, you can have more than 1 texture at once
-	glBindTexture(GL_TEXTURE_2D, getTexture()->getID());
+	renderState.useVertexArray(objectGeometry.getVertexArray(OBJECT_GEOMETRY_LAYOUT_POSITION_UV_NORMAL, false));
+	renderState.bindTexture(renderItem.texture->getID());
 
 	// Draw!
 	// Use the index buffer, more efficient!
 	glDrawElements(
 		GL_TRIANGLES,            // Mode
-		indexBuffer.getLength(), // Count
-		GL_UNSIGNED_INT,         // Type
-		(void*)0                 // Element array buffer offset
+		objectGeometry.getIndexCount(), // Count
+		objectGeometry.getIndexType(),  // Type
+		(void*)0                        // Element array buffer offset
 	);
+	Profiler::countDrawCall();
+}
 
-	// Disable vertex attrib arrays
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
-}
\ No newline at end of file
+// Uses the shader's instanced shader, see shadedInstanced.v.glsl
+void ShadedObject::renderInstanced(const InstanceBatch& instanceBatch, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+	RenderState& renderState) const
+{
+	const RenderItem& renderItem = *instanceBatch.renderItem;
+	const Shader& shader = *renderItem.shader->getInstancedShader();
+	const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
+
+	if(renderState.useProgram(shader.getID()))
+		GLState::setUniform(shader.getUniform(SHADER_UNIFORM_TEXTURE_SAMPLER), 0);
+
+	renderState.useVertexArray(objectGeometry.getVertexArray(OBJECT_GEOMETRY_LAYOUT_POSITION_UV_NORMAL, true));
+	renderState.useInstances(instanceBatch.instanceBuffer, instanceBatch.firstInstance);
+	renderState.bindTexture(renderItem.texture->getID());
+
+	glDrawElementsInstanced(GL_TRIANGLES, objectGeometry.getIndexCount(), objectGeometry.getIndexType(), (void*)0,
+		instanceBatch.instanceCount);
+	Profiler::countDrawCall();
+}
+
+// Lit like shaded.f.glsl, see deferredLighting.f.glsl
+bool ShadedObject::canRenderDeferred() const
+{
+	return true;
+}
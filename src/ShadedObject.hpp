@@ -34,7 +34,12 @@ public:
 		bool physicsCircularShape, int physicsType);
 	~ShadedObject() override;
 
-	void render(const Camera& camera) override;
+	using Object::render; // Keep render(camera) visible
+	void render(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		RenderState& renderState) const override;
+	void renderInstanced(const InstanceBatch& instanceBatch, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		RenderState& renderState) const override;
+	bool canRenderDeferred() const override;
 };
 
 #endif /* SHADED_OBJECT_HPP */
\ No newline at end of file
@@ -19,8 +19,50 @@
 
 #include <Shader.hpp>
 #include <Utils.hpp>
+#include <Graphics.hpp>
+#include <GLState.hpp>
 
 #include <limits> // For numeric_limits
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	// Every uniform name we have seen, in any shader. IDs are indices in names.
+	struct UniformNameTable
+	{
+		std::mutex mutex; // Shaders can be created while another thread asks for IDs
+		std::unordered_map<std::string, int> IDs;
+		std::vector<std::string> names;
+
+		UniformNameTable()
+		{
+			// In SHADER_UNIFORM_* order, so they get those IDs
+			const char* engineUniformNames[SHADER_UNIFORM_COUNT] =
+			{
+				"MVP",
+				"modelMatrix",
+				"viewMatrix",
+				"projectionMatrix",
+				"normalMatrix",
+				"textureSampler",
+				"color"
+			};
+
+			for(int i = 0; i < SHADER_UNIFORM_COUNT; i++)
+			{
+				IDs[engineUniformNames[i]] = i;
+				names.push_back(engineUniformNames[i]);
+			}
+		}
+	};
+
+	UniformNameTable& getUniformNameTable()
+	{
+		static UniformNameTable uniformNameTable; // Built the first time we need it
+		return uniformNameTable;
+	}
+}
 
 // Takes the shader paths for better error logs
 Shader::Shader(const std::string& name,
@@ -28,6 +70,10 @@ Shader::Shader(const std::string& name,
 			   const std::string& fragmentShaderPath)
 {
 	mName = name;
+	mID = 0;
+
+	if(!Graphics::isEnabled()) // Nothing to compile for, uniforms won't be found either
+		return;
 
 	std::string vertexShaderCode = Utils::getFileContents(vertexShaderPath);
 	std::string fragmentShaderCode = Utils::getFileContents(fragmentShaderPath);
@@ -45,7 +91,8 @@ Shader::Shader(const std::string& name,
 
 Shader::~Shader()
 {
-	glDeleteShader(mID); // Free memory
+	if(mID != 0)
+		GLState::deleteProgram(mID); // Free memory, and forget its uniform values
 }
 
 // PRIVATE
@@ -140,30 +187,67 @@ void Shader::registerUniforms()
 
 	for(int i=0; i < numberOfUniforms; i++)
 	{
+		// Uniforms in blocks (like FrameData) come from buffers, they don't have locations
+		GLuint uniformIndex = i;
+		GLint blockIndex;
+		glGetActiveUniformsiv(mID, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+
+		if(blockIndex != -1)
+			continue;
+
 		glGetActiveUniformName(mID, i, bufferSize, &numberOfCharsReceived, uniformNameBuffer);
 
 		// Buffer is converted to an std::string using the null terminator placed by gl
 		registerUniform(uniformNameBuffer);
 	}
+
+	// Shaders declaring the per frame block read it from the same binding point, see RenderQueue::setFrameData()
+	GLuint frameDataIndex = glGetUniformBlockIndex(mID, FRAME_DATA_BLOCK_NAME);
+
+	if(frameDataIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(mID, frameDataIndex, FRAME_DATA_BINDING);
+
+	// Same for the lighting texture buffers and the shadow maps, they are always on the same units
+	// (see RenderQueue::setLights() and ShadowMapCache::render())
+	const char* lightSamplerNames[] = {LIGHT_CLUSTER_SAMPLER_LIGHTS, LIGHT_CLUSTER_SAMPLER_CLUSTERS, LIGHT_CLUSTER_SAMPLER_LIGHT_INDICES,
+		SHADOW_MAP_SAMPLER};
+	const GLint lightSamplerUnits[] = {LIGHT_CLUSTER_UNIT_LIGHTS, LIGHT_CLUSTER_UNIT_CLUSTERS, LIGHT_CLUSTER_UNIT_LIGHT_INDICES,
+		SHADOW_MAP_UNIT};
+
+	GLuint lastProgram = GLState::getProgram();
+	GLState::useProgram(mID); // Samplers can only be set on the current program in OpenGL 3.3
+
+	for(int i = 0; i < 4; i++)
+	{
+		GLint location = glGetUniformLocation(mID, lightSamplerNames[i]);
+
+		GLState::setUniform(location, lightSamplerUnits[i]); // Skips -1
+	}
+
+	if(lastProgram != GL_STATE_UNKNOWN)
+		GLState::useProgram(lastProgram);
 }
 
 // A uniform is attached to a shader, but can be modified whenever
-GLuint Shader::registerUniform(const std::string& uniformName) // Uniform name is the name as in the shader
+GLint Shader::registerUniform(const std::string& uniformName) // Uniform name is the name as in the shader
 {
-	GLuint uniformLocation = glGetUniformLocation(mID, uniformName.c_str()); // Returns the "index" of the variable in the shader.
+	GLint uniformLocation = glGetUniformLocation(mID, uniformName.c_str()); // Returns the "index" of the variable in the shader.
 	
 	if(uniformLocation != -1) // Valid uniform
 	{
-		GLuintMapPair uniformPair(uniformName, uniformLocation);
+		std::size_t uniformID = static_cast<std::size_t>(getUniformID(uniformName));
 
-		std::pair<GLuintMap::iterator, bool> newlyAddedPair = mUniformMap.insert(uniformPair); // Insert in map
-	
-		if(newlyAddedPair.second == false) // Already exists!
+		if(uniformID >= mUniformLocations.size())
+			mUniformLocations.resize(uniformID + 1, -1);
+
+		if(mUniformLocations[uniformID] != -1) // Already exists!
 		{
 			std::string error = "Uniform '" + uniformName + "' in shader '" + mName + "' already exists and cannot be added again!";
 			Utils::CRASH(error);
-			return newlyAddedPair.first->second; // Returns the uniform that was there before
+			return mUniformLocations[uniformID]; // Returns the uniform that was there before
 		}
+
+		mUniformLocations[uniformID] = uniformLocation;
 	} else // Invalid uniform
 	{
 			std::string error = "Uniform '" + uniformName + "' does not exist or is invalid in shader '" + mName + "'! Are you sure it is active (contributing to the output)?";
@@ -185,6 +269,18 @@ GLuint Shader::getID() const
 	return mID;
 }
 
+// Objects using this shader and sharing a geometry and a texture will be drawn together with the instanced shader.
+// It must take the per instance attributes (see RENDER_INSTANCE_ATTRIBUTE_* in Definitions.hpp) instead of the model matrix uniforms.
+void Shader::setInstancedShader(constShaderPointer instancedShader)
+{
+	mInstancedShader = instancedShader;
+}
+
+Shader::constShaderPointer Shader::getInstancedShader() const
+{
+	return mInstancedShader;
+}
+
 std::string Shader::getGLShaderDebugLog(GLuint object, PFNGLGETSHADERIVPROC glGet_iv, PFNGLGETSHADERINFOLOGPROC glGet__InfoLog)
 {
 	GLint logLength; // Amount of characters
@@ -200,17 +296,67 @@ std::string Shader::getGLShaderDebugLog(GLuint object, PFNGLGETSHADERIVPROC glGe
 	return "\n-----------GL LOG-----------\n" + log; // For looks
 }
 
-GLuint Shader::findUniform(const std::string& uniformName) const // Returns a read only int
+// Private
+void Shader::crashMissingUniform(int uniformID) const
 {
-	GLuintMap::const_iterator got = mUniformMap.find(uniformName); // Const iterator, we should not need to change this GLuint
+	std::string error = "Uniform '" + getUniformName(uniformID) + "' was not registered for shader '" + mName +
+		"'! Are you creating the right object type for your shader?";
+	Utils::CRASH(error);
+}
 
-	if(got == mUniformMap.end())
-	{
-		std::string error = uniformName;
-		error = "Uniform '" + error + "' was not registered for shader '" + mName + "'! Are you creating the right object type for your shader?";
-		Utils::CRASH(error);
+// Static
+// The same name always gives the same ID, in every shader. Look IDs up once and keep them,
+// engine uniforms already have theirs (SHADER_UNIFORM_*).
+int Shader::getUniformID(const std::string& uniformName)
+{
+	UniformNameTable& table = getUniformNameTable();
+	std::lock_guard<std::mutex> lock(table.mutex);
+
+	auto inserted = table.IDs.insert(std::make_pair(uniformName, static_cast<int>(table.names.size())));
+
+	if(inserted.second) // New name
+		table.names.push_back(uniformName);
+
+	return inserted.first->second;
+}
+
+// Static
+std::string Shader::getUniformName(int uniformID)
+{
+	UniformNameTable& table = getUniformNameTable();
+	std::lock_guard<std::mutex> lock(table.mutex);
+
+	if(uniformID < 0 || static_cast<std::size_t>(uniformID) >= table.names.size())
+		return "<unknown uniform " + std::to_string(uniformID) + ">";
+
+	return table.names[uniformID];
+}
+
+// What every render function uses, no strings involved
+GLint Shader::getUniform(int uniformID) const
+{
+	if(uniformID >= 0 && static_cast<std::size_t>(uniformID) < mUniformLocations.size()
+		&& mUniformLocations[uniformID] != -1)
+		return mUniformLocations[uniformID];
+
+	if(mID == 0 && !Graphics::isEnabled()) // Never compiled, it can't be found
 		return 0;
-	}
 
-	return got->second;
+	crashMissingUniform(uniformID);
+	return -1;
+}
+
+// Returns -1 instead of crashing if the shader doesn't have it, OpenGL ignores uniforms set at -1
+GLint Shader::getOptionalUniform(int uniformID) const
+{
+	if(uniformID >= 0 && static_cast<std::size_t>(uniformID) < mUniformLocations.size())
+		return mUniformLocations[uniformID];
+
+	return -1;
+}
+
+// Slower, turns the name into an ID first. Use getUniform() when drawing.
+GLint Shader::findUniform(const std::string& uniformName) const
+{
+	return getUniform(getUniformID(uniformName));
 }
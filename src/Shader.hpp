@@ -20,27 +20,33 @@
 #ifndef SHADER_HPP
 #define SHADER_HPP
 
-#include <map>
+#include <memory> // For smart pointers
 #include <glad/glad.h>
 #include <string>
+#include <vector>
+
+#include <Definitions.hpp> // For SHADER_UNIFORM_*
 
 class Shader
 {
 private:
-	using GLuintMap = std::map<std::string, GLuint>;
-	using GLuintMapPair = std::pair<std::string, GLuint>;
+	using GLintVector = std::vector<GLint>;
+
+	using constShaderPointer = std::shared_ptr<const Shader>;
 
 	std::string mName; // Useful for error messages, don't change this stupidly
+	constShaderPointer mInstancedShader; // Draws many objects using this shader at once, can be empty
 
 	GLuint mID; // the ID of the shader, give this to OpenGL stuff. Could be const, but I left it non-const to make things easier.
-	GLuintMap mUniformMap; // Uniform variables, uniforms[uniformName] = uniform location
+	GLintVector mUniformLocations; // Indexed by uniform ID (see getUniformID()), -1 if we don't have it
 
 	// Static because they donnot need an instance to work
 	static GLuint compileShader(const std::string& shaderPath, const std::string& shaderCode, GLenum type);
 	static GLuint linkShaderProgram(const std::string& shaderProgramName, GLuint vertexShader, GLuint fragmentShader);
 
 	void registerUniforms();
-	GLuint registerUniform(const std::string& uniformName);
+	GLint registerUniform(const std::string& uniformName);
+	void crashMissingUniform(int uniformID) const;
 
 public:
 	Shader(const std::string& name, const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
@@ -49,9 +55,17 @@ public:
 	std::string getName() const;
 	GLuint getID() const;
 
+	void setInstancedShader(constShaderPointer instancedShader);
+	constShaderPointer getInstancedShader() const;
+
 	static std::string getGLShaderDebugLog(GLuint object, PFNGLGETSHADERIVPROC glGet_iv, PFNGLGETSHADERINFOLOGPROC glGet__InfoLog);
 
-	GLuint findUniform(const std::string& uniformName) const;
+	static int getUniformID(const std::string& uniformName);
+	static std::string getUniformName(int uniformID);
+
+	GLint getUniform(int uniformID) const;
+	GLint getOptionalUniform(int uniformID) const;
+	GLint findUniform(const std::string& uniformName) const;
 };
 
 #endif /* SHADER_HPP */
\ No newline at end of file
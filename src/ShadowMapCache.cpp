@@ -0,0 +1,323 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+#include <ShadowMapCache.hpp>
+#include <Frustum.hpp>
+#include <GLState.hpp>
+#include <ObjectGeometry.hpp>
+#include <Profiler.hpp>
+#include <Utils.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath> // For std::atan
+#include <cstring> // For std::memcpy
+
+// Give it the engine's depth shader (see SHADOW_MAP_SHADER_*)
+ShadowMapCache::ShadowMapCache(constShaderPointer shader)
+{
+	mShader = shader;
+
+	mCachedTexture = 0;
+	mCachedFramebuffer = 0;
+	mTexture = 0;
+	mFramebuffer = 0;
+
+	for(auto &slot : mSlots)
+	{
+		slot.light = glm::vec4(0.0f);
+		slot.staticHash = 0;
+		slot.cached = false;
+		slot.dynamicCasters = false;
+	}
+}
+
+ShadowMapCache::~ShadowMapCache()
+{
+	deleteTextures();
+}
+
+// PRIVATE
+
+// Both atlases are SHADOW_MAP_FACE_COUNT tiles wide and SHADOW_MAP_MAX_LIGHTS tiles high
+void ShadowMapCache::createTextures()
+{
+	const GLsizei width = SHADOW_MAP_SIZE * SHADOW_MAP_FACE_COUNT;
+	const GLsizei height = SHADOW_MAP_SIZE * SHADOW_MAP_MAX_LIGHTS;
+
+	GLuint* textures[] = {&mCachedTexture, &mTexture};
+	GLuint* framebuffers[] = {&mCachedFramebuffer, &mFramebuffer};
+
+	for(int i = 0; i < 2; i++)
+	{
+		glGenTextures(1, textures[i]);
+		GLState::bindTexture(0, GL_TEXTURE_2D, *textures[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glGenFramebuffers(1, framebuffers[i]);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, *framebuffers[i]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, *textures[i], 0);
+		glDrawBuffer(GL_NONE); // Depth only
+		glReadBuffer(GL_NONE);
+
+		if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			Utils::CRASH("Shadow map framebuffer is incomplete!");
+	}
+
+	// The cached atlas is only copied, shaders compare against this one. Linear filtering blends 4 comparisons.
+	GLState::bindTexture(0, GL_TEXTURE_2D, mCachedTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	GLState::bindTexture(0, GL_TEXTURE_2D, mTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+	GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+void ShadowMapCache::deleteTextures()
+{
+	if(mTexture == 0)
+		return;
+
+	GLState::deleteFramebuffer(mCachedFramebuffer);
+	GLState::deleteFramebuffer(mFramebuffer);
+	GLState::deleteTexture(mCachedTexture);
+	GLState::deleteTexture(mTexture);
+
+	mCachedTexture = 0;
+	mCachedFramebuffer = 0;
+	mTexture = 0;
+	mFramebuffer = 0;
+}
+
+// FNV-1a over the geometry and model matrix of every static caster in range, that's all their depth depends on
+std::uint64_t ShadowMapCache::hashStaticCasters(const RenderSnapshot::renderItemVector& renderItems) const
+{
+	std::uint64_t hash = 14695981039346656037ULL;
+
+	for(std::size_t caster : mStaticCasters)
+	{
+		const RenderItem& renderItem = renderItems[caster];
+
+		unsigned char bytes[sizeof(const ObjectGeometry*) + sizeof(glm::mat4)];
+		const ObjectGeometry* objectGeometry = renderItem.objectGeometry.get();
+		std::memcpy(bytes, &objectGeometry, sizeof(objectGeometry));
+		std::memcpy(bytes + sizeof(objectGeometry), &renderItem.modelMatrix[0][0], sizeof(glm::mat4));
+
+		for(unsigned char byte : bytes)
+		{
+			hash ^= byte;
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	return hash;
+}
+
+// Clears the slot's row of tiles in the bound framebuffer
+void ShadowMapCache::clearTiles(int slot)
+{
+	GLState::setCapability(GL_SCISSOR_TEST, true);
+	glScissor(0, slot * SHADOW_MAP_SIZE, SHADOW_MAP_SIZE * SHADOW_MAP_FACE_COUNT, SHADOW_MAP_SIZE);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	GLState::setCapability(GL_SCISSOR_TEST, false);
+}
+
+// Copies the slot's cached tiles to the tiles shaders read, leaves that framebuffer bound
+void ShadowMapCache::copyCachedTiles(int slot)
+{
+	GLint x1 = SHADOW_MAP_SIZE * SHADOW_MAP_FACE_COUNT;
+	GLint y0 = slot * SHADOW_MAP_SIZE;
+	GLint y1 = y0 + SHADOW_MAP_SIZE;
+
+	GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, mCachedFramebuffer);
+	GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, mFramebuffer);
+	glBlitFramebuffer(0, y0, x1, y1, 0, y0, x1, y1, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+}
+
+// Draws the casters' depth in each face of the slot they can be seen from, in the bound framebuffer
+void ShadowMapCache::renderCasters(const RenderSnapshot::renderItemVector& renderItems, const std::vector<std::size_t>& casters,
+	const glm::vec4& light, int slot, RenderState& renderState)
+{
+	if(casters.empty())
+		return;
+
+	mCasterSpheres.resize(casters.size());
+	mCullResults.resize(casters.size());
+
+	for(std::size_t i = 0; i < casters.size(); i++)
+		mCasterSpheres[i] = mBoundingSpheres[casters[i]];
+
+	renderState.useProgram(mShader->getID());
+	GLint MVPLocation = mShader->getUniform(SHADER_UNIFORM_MVP);
+
+	for(int face = 0; face < SHADOW_MAP_FACE_COUNT; face++)
+	{
+		glm::mat4 faceMatrix = generateFaceMatrix(glm::vec3(light), light.w, face);
+		Frustum(faceMatrix).testSpheres(mCasterSpheres.data(), mCasterSpheres.size(), mCullResults.data());
+
+		glViewport(face * SHADOW_MAP_SIZE, slot * SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
+
+		for(std::size_t i = 0; i < casters.size(); i++)
+		{
+			if(mCullResults[i] == FRUSTUM_OUTSIDE)
+				continue;
+
+			const RenderItem& renderItem = renderItems[casters[i]];
+			const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
+
+			glm::mat4 MVP = faceMatrix * renderItem.modelMatrix * objectGeometry.getPositionDecodeMatrix();
+			GLState::setUniform(MVPLocation, MVP);
+
+			renderState.useVertexArray(objectGeometry.getVertexArray(OBJECT_GEOMETRY_LAYOUT_POSITION, false));
+
+			glDrawElements(GL_TRIANGLES, objectGeometry.getIndexCount(), objectGeometry.getIndexType(), (void*)0);
+			Profiler::countDrawCall();
+		}
+	}
+}
+
+// PUBLIC
+
+// Static
+// View-projection matrix of a cube face, looking from the light up to its range
+glm::mat4 ShadowMapCache::generateFaceMatrix(const glm::vec3& position, float range, int face)
+{
+	static const glm::vec3 directions[SHADOW_MAP_FACE_COUNT] =
+		{glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1)};
+	static const glm::vec3 ups[SHADOW_MAP_FACE_COUNT] =
+		{glm::vec3(0, -1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1), glm::vec3(0, -1, 0), glm::vec3(0, -1, 0)};
+
+	// A bit over 90 degrees, so a face has a texel of margin on each side and filtering never reads the next tile
+	float fieldOfView = 2.0f * std::atan(SHADOW_MAP_SIZE / (SHADOW_MAP_SIZE - 2.0f));
+
+	glm::mat4 projectionMatrix = glm::perspective(fieldOfView, 1.0f, range * SHADOW_MAP_NEAR_RATIO, range);
+	glm::mat4 viewMatrix = glm::lookAt(position, position + directions[face], ups[face]);
+
+	return projectionMatrix * viewMatrix;
+}
+
+// Static
+// From world space to the face's tile in the atlas: x and y are texture coordinates, z is the depth to compare
+glm::mat4 ShadowMapCache::generateTextureMatrix(const glm::vec3& position, float range, int slot, int face)
+{
+	glm::vec3 tileScale(0.5f / SHADOW_MAP_FACE_COUNT, 0.5f / SHADOW_MAP_MAX_LIGHTS, 0.5f);
+	glm::vec3 tileCenter((face + 0.5f) / SHADOW_MAP_FACE_COUNT, (slot + 0.5f) / SHADOW_MAP_MAX_LIGHTS, 0.5f);
+
+	glm::mat4 tileMatrix = glm::scale(glm::translate(glm::mat4(1.0f), tileCenter), tileScale);
+	return tileMatrix * generateFaceMatrix(position, range, face);
+}
+
+// Updates the shadow maps of the lights in shadowLights (indices in lights, -1 for unused slots) and binds them
+// on SHADOW_MAP_UNIT. Does nothing without shadow casting lights.
+void ShadowMapCache::render(const RenderSnapshot::renderItemVector& renderItems, const std::vector<FrameLight>& lights,
+	const glm::ivec4& shadowLights, RenderState& renderState)
+{
+	bool hasShadows = false;
+	for(int slot = 0; slot < SHADOW_MAP_MAX_LIGHTS; slot++)
+		hasShadows = hasShadows || shadowLights[slot] >= 0;
+
+	if(!hasShadows)
+		return;
+
+	mBoundingSpheres.resize(renderItems.size());
+	for(std::size_t i = 0; i < renderItems.size(); i++)
+		mBoundingSpheres[i] = renderItems[i].objectGeometry->getBoundingSphere(renderItems[i].modelMatrix);
+
+	GLuint lastDrawFramebuffer = GLState::getFramebuffer(GL_DRAW_FRAMEBUFFER);
+	GLuint lastReadFramebuffer = GLState::getFramebuffer(GL_READ_FRAMEBUFFER);
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	if(mTexture == 0)
+		createTextures();
+
+	bool cullFace = GLState::isCapabilityEnabled(GL_CULL_FACE);
+	GLState::setCapability(GL_CULL_FACE, false); // Planes cast shadows from both sides
+	GLState::setCapability(GL_POLYGON_OFFSET_FILL, true);
+	glPolygonOffset(SHADOW_MAP_OFFSET_FACTOR, SHADOW_MAP_OFFSET_UNITS);
+
+	for(int slotIndex = 0; slotIndex < SHADOW_MAP_MAX_LIGHTS; slotIndex++)
+	{
+		if(shadowLights[slotIndex] < 0)
+			continue;
+
+		const FrameLight& frameLight = lights[shadowLights[slotIndex]];
+		glm::vec4 light(glm::vec3(frameLight.position), frameLight.specularColor.w); // Position and range
+
+		// Casters in the light's range
+		mStaticCasters.clear();
+		mDynamicCasters.clear();
+
+		for(std::size_t i = 0; i < renderItems.size(); i++)
+		{
+			const glm::vec4& sphere = mBoundingSpheres[i];
+
+			if(glm::distance(glm::vec3(sphere), glm::vec3(light)) > sphere.w + light.w)
+				continue;
+
+			if(renderItems[i].staticBody)
+				mStaticCasters.push_back(i);
+			else
+				mDynamicCasters.push_back(i);
+		}
+
+		Slot& slot = mSlots[slotIndex];
+		std::uint64_t staticHash = hashStaticCasters(renderItems);
+		bool redrawn = false;
+
+		if(!slot.cached || slot.light != light || slot.staticHash != staticHash)
+		{
+			GLState::bindFramebuffer(GL_FRAMEBUFFER, mCachedFramebuffer);
+			clearTiles(slotIndex);
+			renderCasters(renderItems, mStaticCasters, light, slotIndex, renderState);
+
+			slot.light = light;
+			slot.staticHash = staticHash;
+			slot.cached = true;
+			redrawn = true;
+		}
+
+		// The tiles shaders read are still right if nothing was drawn on them, last frame and this one
+		if(redrawn || slot.dynamicCasters || !mDynamicCasters.empty())
+		{
+			copyCachedTiles(slotIndex);
+			renderCasters(renderItems, mDynamicCasters, light, slotIndex, renderState);
+		}
+
+		slot.dynamicCasters = !mDynamicCasters.empty();
+	}
+
+	GLState::setCapability(GL_POLYGON_OFFSET_FILL, false);
+	GLState::setCapability(GL_CULL_FACE, cullFace);
+
+	GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, lastDrawFramebuffer);
+	GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, lastReadFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	GLState::bindTexture(SHADOW_MAP_UNIT, GL_TEXTURE_2D, mTexture);
+}
@@ -0,0 +1,98 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+// Shadow maps for point lights (see Light::setShadowCasting()). Each shadow casting light gets a cube of depth maps,
+// 6 tiles in a row of one atlas texture, sampled by lit shaders through FrameData::shadowMatrices.
+// Static casters (PHYSICS_BODY_STATIC) are drawn once in a cached atlas. Every frame the cached tiles are copied
+// to the atlas shaders read, and the other casters near the light are drawn on top. A light's cached tiles are redrawn
+// only when it moves or when the static casters it reaches change (moved, added or removed).
+// RenderQueue drives it, use it on the thread owning the OpenGL context.
+
+#ifndef SHADOW_MAP_CACHE_HPP
+#define SHADOW_MAP_CACHE_HPP
+
+#include <RenderSnapshot.hpp>
+#include <RenderState.hpp>
+#include <Shader.hpp>
+#include <Definitions.hpp>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory> // For std::shared_ptr
+#include <cstdint> // For std::uint64_t
+#include <cstddef> // For std::size_t
+
+class ShadowMapCache
+{
+public:
+	using constShaderPointer = std::shared_ptr<const Shader>;
+
+private:
+	// A light's row of tiles
+	struct Slot
+	{
+		glm::vec4 light; // Position and range the cached tiles were drawn for
+		std::uint64_t staticHash; // Of the static casters in range, see hashStaticCasters()
+		bool cached; // The cached tiles are up to date for light and staticHash
+		bool dynamicCasters; // Something was drawn on top of the cached tiles last frame
+	};
+
+	constShaderPointer mShader; // Only writes depth
+
+	GLuint mCachedTexture; // Static casters, 0 until the first shadow casting light
+	GLuint mCachedFramebuffer;
+	GLuint mTexture; // What shaders read
+	GLuint mFramebuffer;
+
+	Slot mSlots[SHADOW_MAP_MAX_LIGHTS];
+
+	// For the frame being rendered
+	std::vector<glm::vec4> mBoundingSpheres; // Of every item, in world space
+	std::vector<std::size_t> mStaticCasters; // Items in range of the slot being drawn
+	std::vector<std::size_t> mDynamicCasters;
+	std::vector<glm::vec4> mCasterSpheres;
+	std::vector<unsigned char> mCullResults;
+
+	void createTextures();
+	void deleteTextures();
+
+	std::uint64_t hashStaticCasters(const RenderSnapshot::renderItemVector& renderItems) const;
+	void clearTiles(int slot);
+	void copyCachedTiles(int slot);
+	void renderCasters(const RenderSnapshot::renderItemVector& renderItems, const std::vector<std::size_t>& casters,
+		const glm::vec4& light, int slot, RenderState& renderState);
+
+public:
+	ShadowMapCache(constShaderPointer shader);
+	~ShadowMapCache();
+
+	// Would share the textures
+	ShadowMapCache(const ShadowMapCache&) = delete;
+	ShadowMapCache& operator=(const ShadowMapCache&) = delete;
+
+	static glm::mat4 generateFaceMatrix(const glm::vec3& position, float range, int face);
+	static glm::mat4 generateTextureMatrix(const glm::vec3& position, float range, int slot, int face);
+
+	void render(const RenderSnapshot::renderItemVector& renderItems, const std::vector<FrameLight>& lights,
+		const glm::ivec4& shadowLights, RenderState& renderState);
+};
+
+#endif /* SHADOW_MAP_CACHE_HPP */
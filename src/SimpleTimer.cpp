@@ -18,13 +18,11 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include <SimpleTimer.hpp>
-
-#include <SDL.h>
+#include <HighResolutionClock.hpp>
 
 SimpleTimer::SimpleTimer()
 {
-	mStartTicks = 0;
-	mEndTicks = 0;
+	mStartTime = 0;
 }
 
 SimpleTimer::~SimpleTimer()
@@ -32,13 +30,20 @@ SimpleTimer::~SimpleTimer()
 	// Do nothing
 }
 
-int SimpleTimer::start() // Can be called multiple times (resets timer)
+// Returns the clock's time, in nanoseconds
+std::int64_t SimpleTimer::start() // Can be called multiple times (resets timer)
 {
-	mStartTicks = SDL_GetTicks(); // SDL_GetTicks() returns the number of miliseconds since SDL started
-	return mStartTicks;
+	mStartTime = HighResolutionClock::getNanoseconds();
+	return mStartTime;
 }
 
+// In miliseconds
 int SimpleTimer::getTicks()
 {
-	return SDL_GetTicks() - mStartTicks;
+	return static_cast<int>(getNanoseconds() / 1000000);
+}
+
+std::int64_t SimpleTimer::getNanoseconds()
+{
+	return HighResolutionClock::getNanoseconds() - mStartTime;
 }
\ No newline at end of file
@@ -20,18 +20,20 @@
 #ifndef SIMPLETIMER_HPP
 #define SIMPLETIMER_HPP
 
+#include <cstdint>
+
 class SimpleTimer
 {
 private:
-	int mStartTicks; // The time when the timer was started
-	int mEndTicks; // The time when the timer has stopped
+	std::int64_t mStartTime; // The time when the timer was started, in nanoseconds
 
 public:
 	SimpleTimer();
 	~SimpleTimer();
 
-	int start();
+	std::int64_t start();
 	int getTicks();
+	std::int64_t getNanoseconds();
 };
 
 #endif /* SIMPLETIMER_HPP */
\ No newline at end of file
@@ -31,6 +31,7 @@
 // Static member initialized
 int Sound::mInstanceCount = 0;
 Mix_Music* Sound::mLastPlayedMusic = nullptr;
+bool Sound::mAudioEnabled = true;
 
 Sound::Sound(const std::string& name, const std::string& path, int type)
 {
@@ -89,6 +90,9 @@ Sound::~Sound()
 // Loads the sound specified in mPath
 bool Sound::load()
 {
+	if(!mAudioEnabled)
+		return true;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -120,6 +124,20 @@ bool Sound::load()
 	setVolume(MIX_MAX_VOLUME); // Make sure the volume is at maximum. This is to make sure it will stay the same in the future.
 }
 
+// Static
+// Without audio (simulation-only), sounds can still be created and used, they just don't do anything
+// Set before creating sounds!
+void Sound::setAudioEnabled(bool enabled)
+{
+	mAudioEnabled = enabled;
+}
+
+// Static
+bool Sound::isAudioEnabled()
+{
+	return mAudioEnabled;
+}
+
 std::string Sound::getName()
 {
 	return mName;
@@ -131,6 +149,9 @@ std::string Sound::getName()
 // Will replace the song that is already playing
 bool Sound::play(int numberOfLoops)
 {
+	if(!mAudioEnabled)
+		return true;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -162,6 +183,9 @@ bool Sound::play(int numberOfLoops)
 // Does NOT check if it is paused! Only checks if play() or similar was called.
 bool Sound::isPlaying()
 {
+	if(!mAudioEnabled)
+		return false;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -187,6 +211,9 @@ bool Sound::isPlaying()
 // Returns true on success
 bool Sound::halt()
 {
+	if(!mAudioEnabled)
+		return true;
+
 	if(!isPlaying()) // If it's not playing
 	{
 		Utils::CRASH("Sound '" + mName + "' cannot be halted since it is not playing! Please play the song before trying to halt it.");
@@ -215,6 +242,9 @@ bool Sound::halt()
 // Pausing can't fail, it will pause anything, including a halted sound.
 void Sound::pause()
 {
+	if(!mAudioEnabled)
+		return;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -237,6 +267,9 @@ void Sound::pause()
 // Does not check if the sound is playing or was halted
 bool Sound::isPaused()
 {
+	if(!mAudioEnabled)
+		return false;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -262,6 +295,9 @@ bool Sound::isPaused()
 // Resumes from a pause
 void Sound::resume()
 {
+	if(!mAudioEnabled)
+		return;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -285,6 +321,9 @@ void Sound::resume()
 // If loops is -1, it will loop forever
 bool Sound::fadeIn(float fadeTime, int loops)
 {
+	if(!mAudioEnabled)
+		return true;
+
 	int fadeTimeInMS = static_cast<int>(fadeTime * 1000.0f); // Convert to miliseconds
 
 	switch(mType)
@@ -316,6 +355,9 @@ bool Sound::fadeIn(float fadeTime, int loops)
 // When finished, halts the sound
 bool Sound::fadeOut(float fadeTime)
 {
+	if(!mAudioEnabled)
+		return true;
+
 	int fadeTimeInMS = static_cast<int>(fadeTime * 1000.0f); // Convert to miliseconds
 
 	if(!isPlaying()) // If it's not playing
@@ -352,6 +394,9 @@ bool Sound::fadeOut(float fadeTime)
 // Volume is between 0 to 128 (MIX_MAX_VOLUME)
 void Sound::setVolume(int volume)
 {
+	if(!mAudioEnabled)
+		return;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -370,6 +415,9 @@ void Sound::setVolume(int volume)
 
 int Sound::getVolume()
 {
+	if(!mAudioEnabled)
+		return 0;
+
 	switch(mType)
 	{
 	case SOUND_MUSIC:
@@ -32,6 +32,7 @@ private:
 
 	// Static members (not functions) are not linked to any instance. Like a global!
 	static int mInstanceCount; // Number of Sound instances
+	static bool mAudioEnabled; // When disabled, sounds aren't loaded and do nothing
 
 	// SDL_mixer needs pointers
 	// Smells like C!
@@ -49,6 +50,9 @@ public:
 	Sound(const Sound& other);
 	~Sound();
 
+	static void setAudioEnabled(bool enabled);
+	static bool isAudioEnabled();
+
 	std::string getName();
 
 	bool play(int numberOfLoops = 0);
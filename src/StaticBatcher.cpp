@@ -0,0 +1,212 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <StaticBatcher.hpp>
+#include <ObjectGeometry.hpp>
+#include <Object.hpp>
+
+#include <algorithm> // For std::sort
+#include <tuple> // For std::tie
+#include <typeinfo> // For typeid
+#include <cmath> // For std::floor
+#include <cstring> // For std::memcpy
+
+StaticBatcher::StaticBatcher()
+{
+	mStaticHash = 0;
+	mBatchedItemCount = 0;
+}
+
+StaticBatcher::~StaticBatcher()
+{
+	// Do nothing
+}
+
+bool StaticBatcher::BatchKey::operator<(const BatchKey& other) const
+{
+	return std::tie(objectType, shader, texture, chunk.x, chunk.y, chunk.z)
+		< std::tie(other.objectType, other.shader, other.texture, other.chunk.x, other.chunk.y, other.chunk.z);
+}
+
+// PRIVATE
+
+// Static
+bool StaticBatcher::canBatch(const RenderItem& renderItem)
+{
+	return renderItem.staticBody && renderItem.object && renderItem.objectGeometry;
+}
+
+// Static
+StaticBatcher::BatchKey StaticBatcher::generateKey(const RenderItem& renderItem)
+{
+	// Model matrices are in pixels, chunks in meters
+	glm::vec3 center = glm::vec3(renderItem.objectGeometry->getBoundingSphere(renderItem.modelMatrix)) / PHYSICS_PIXELS_PER_METER;
+
+	BatchKey key = {typeid(*renderItem.object), renderItem.shader.get(), renderItem.texture.get(),
+		glm::ivec3(glm::floor(center / STATIC_BATCH_CHUNK_SIZE))};
+	return key;
+}
+
+// FNV-1a over everything a batch is made from, in order
+std::uint64_t StaticBatcher::hashStaticItems(const RenderSnapshot::renderItemVector& renderItems) const
+{
+	std::uint64_t hash = 14695981039346656037ULL;
+
+	for(const auto &staticItem : mStaticItems)
+	{
+		const RenderItem& renderItem = renderItems[staticItem.index];
+		const void* pointers[] = {renderItem.object.get(), renderItem.objectGeometry.get(), renderItem.shader.get(),
+			renderItem.texture.get()};
+
+		unsigned char bytes[sizeof(pointers) + sizeof(glm::mat4)];
+		std::memcpy(bytes, pointers, sizeof(pointers));
+		std::memcpy(bytes + sizeof(pointers), &renderItem.modelMatrix[0][0], sizeof(glm::mat4));
+
+		for(unsigned char byte : bytes)
+		{
+			hash ^= byte;
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	return hash;
+}
+
+// Merges mStaticItems[first] to mStaticItems[last - 1] in world space. They have the same key.
+void StaticBatcher::addBatch(const RenderSnapshot::renderItemVector& renderItems, std::size_t first, std::size_t last)
+{
+	const RenderItem& firstItem = renderItems[mStaticItems[first].index];
+
+	if(last - first == 1) // Nothing to merge with
+	{
+		mBatches.push_back(firstItem);
+		return;
+	}
+
+	ObjectGeometry::uintVector indices;
+	ObjectGeometry::vertexVector vertices;
+
+	for(std::size_t i = first; i < last; i++)
+	{
+		const RenderItem& renderItem = renderItems[mStaticItems[i].index];
+		const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
+
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(renderItem.modelMatrix)));
+		unsigned int firstVertex = static_cast<unsigned int>(vertices.size());
+
+		for(const auto &vertex : objectGeometry.getVertices())
+		{
+			ObjectGeometry::Vertex worldVertex;
+			worldVertex.position = glm::vec3(renderItem.modelMatrix * glm::vec4(vertex.position, 1.0f));
+			worldVertex.UV = vertex.UV;
+			worldVertex.normal = glm::normalize(normalMatrix * vertex.normal);
+
+			vertices.push_back(worldVertex);
+		}
+
+		for(unsigned int index : objectGeometry.getIndices())
+			indices.push_back(firstVertex + index);
+	}
+
+	RenderItem batch = firstItem; // Same object type, shader and texture
+	batch.objectGeometry = std::make_shared<ObjectGeometry>("staticBatch", indices, vertices);
+	batch.modelMatrix = glm::mat4(1.0f); // Already in world space
+
+	mBatches.push_back(batch);
+	mBatchedItemCount += last - first;
+}
+
+void StaticBatcher::build(const RenderSnapshot::renderItemVector& renderItems)
+{
+	mBatches.clear();
+	mBatchedItemCount = 0;
+
+	std::sort(mStaticItems.begin(), mStaticItems.end(), [](const StaticItem& first, const StaticItem& other)
+	{
+		return first.key < other.key;
+	});
+
+	std::size_t batchStart = 0;
+	std::size_t batchVertexCount = 0;
+
+	for(std::size_t i = 0; i < mStaticItems.size(); i++)
+	{
+		std::size_t vertexCount = renderItems[mStaticItems[i].index].objectGeometry->getVertices().size();
+
+		// Split keys with too many vertices, each batch needs at least one item
+		bool sameKey = i == batchStart || !(mStaticItems[batchStart].key < mStaticItems[i].key);
+		bool fits = i == batchStart || batchVertexCount + vertexCount <= STATIC_BATCH_MAX_VERTICES;
+
+		if(!sameKey || !fits)
+		{
+			addBatch(renderItems, batchStart, i);
+			batchStart = i;
+			batchVertexCount = 0;
+		}
+
+		batchVertexCount += vertexCount;
+	}
+
+	if(!mStaticItems.empty())
+		addBatch(renderItems, batchStart, mStaticItems.size());
+}
+
+// PUBLIC
+
+// Returns the items to draw instead: the ones that aren't static, then the batches.
+// They stay valid until the next call.
+const RenderSnapshot::renderItemVector& StaticBatcher::batch(const RenderSnapshot::renderItemVector& renderItems)
+{
+	mStaticItems.clear();
+	mRenderItems.clear();
+
+	for(std::size_t i = 0; i < renderItems.size(); i++)
+	{
+		if(canBatch(renderItems[i]))
+		{
+			StaticItem staticItem = {generateKey(renderItems[i]), i};
+			mStaticItems.push_back(staticItem);
+		} else
+			mRenderItems.push_back(renderItems[i]);
+	}
+
+	std::uint64_t staticHash = hashStaticItems(renderItems);
+
+	if(staticHash != mStaticHash)
+	{
+		build(renderItems);
+		mStaticHash = staticHash;
+	}
+
+	mRenderItems.insert(mRenderItems.end(), mBatches.begin(), mBatches.end());
+	return mRenderItems;
+}
+
+// Including items alone in their batch
+std::size_t StaticBatcher::getBatchCount() const
+{
+	return mBatches.size();
+}
+
+// Items merged with others
+std::size_t StaticBatcher::getBatchedItemCount() const
+{
+	return mBatchedItemCount;
+}
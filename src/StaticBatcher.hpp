@@ -0,0 +1,84 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Merges static objects (PHYSICS_BODY_STATIC) into a few big geometries, so a static level costs a handful of draw calls.
+// Items of the same object type, shader and texture whose centers are in the same STATIC_BATCH_CHUNK_SIZE cube
+// have their vertices moved to world space and put in one ObjectGeometry, drawn as one item with the first object's
+// render function. Batches are still culled (by chunk) and cast cached shadows like the items they replace.
+// Batches are rebuilt when a static item moves, appears or disappears, so make sure what is static stays still.
+// RenderQueue drives it, use it on the thread owning the OpenGL context.
+
+#ifndef STATIC_BATCHER_HPP
+#define STATIC_BATCHER_HPP
+
+#include <RenderSnapshot.hpp>
+#include <Definitions.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <typeindex> // For std::type_index
+#include <cstdint> // For std::uint64_t
+#include <cstddef> // For std::size_t
+
+class StaticBatcher
+{
+private:
+	// Items with the same key can be merged
+	struct BatchKey
+	{
+		std::type_index objectType; // Picks the render function
+		const Shader* shader;
+		const Texture* texture;
+		glm::ivec3 chunk;
+
+		bool operator<(const BatchKey& other) const;
+	};
+
+	struct StaticItem
+	{
+		BatchKey key;
+		std::size_t index; // In the items given to batch()
+	};
+
+	RenderSnapshot::renderItemVector mBatches; // Built from the static items, items alone in their batch are kept as they are
+	RenderSnapshot::renderItemVector mRenderItems; // What batch() returns
+	std::vector<StaticItem> mStaticItems;
+	std::uint64_t mStaticHash;
+	std::size_t mBatchedItemCount;
+
+	static bool canBatch(const RenderItem& renderItem);
+	static BatchKey generateKey(const RenderItem& renderItem);
+
+	std::uint64_t hashStaticItems(const RenderSnapshot::renderItemVector& renderItems) const;
+	void addBatch(const RenderSnapshot::renderItemVector& renderItems, std::size_t first, std::size_t last);
+	void build(const RenderSnapshot::renderItemVector& renderItems);
+
+public:
+	StaticBatcher();
+	~StaticBatcher();
+
+	const RenderSnapshot::renderItemVector& batch(const RenderSnapshot::renderItemVector& renderItems);
+
+	std::size_t getBatchCount() const;
+	std::size_t getBatchedItemCount() const;
+};
+
+#endif /* STATIC_BATCHER_HPP */
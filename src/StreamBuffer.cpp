@@ -0,0 +1,243 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <StreamBuffer.hpp>
+#include <GLState.hpp>
+#include <Graphics.hpp>
+#include <Utils.hpp>
+
+#include <cstring> // For std::memcpy
+
+StreamBuffer::StreamBuffer()
+{
+	mBuffer = 0;
+	mFrameSize = STREAM_BUFFER_FRAME_SIZE;
+	mMapping = nullptr;
+	mUniformAlignment = 256; // The biggest OpenGL allows, asked when the buffer is created
+
+	for(auto &fence : mFences)
+		fence = nullptr;
+
+	mFrame = 0;
+	mOffset = 0;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	if(mBuffer != 0)
+		retireBuffer();
+
+	deleteRetiredBuffers(true); // Without waiting
+}
+
+// PRIVATE
+
+void StreamBuffer::createBuffer()
+{
+	GLsizeiptr size = mFrameSize * STREAM_BUFFER_FRAMES;
+
+	glGenBuffers(1, &mBuffer);
+	GLState::bindBuffer(GL_COPY_WRITE_BUFFER, mBuffer); // Doesn't disturb other bindings
+
+	if(GLAD_GL_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+		mMapping = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+
+		if(!mMapping)
+			Utils::CRASH("Unable to map the stream buffer!");
+	} else
+		glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &mUniformAlignment);
+
+	mFrame = 0;
+	mOffset = 0;
+}
+
+// Regions of the old buffer might still be read, it is deleted after the GPU is done with this frame
+void StreamBuffer::retireBuffer()
+{
+	for(auto &fence : mFences) // The retired buffer's fence covers them
+	{
+		if(fence)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	RetiredBuffer retiredBuffer;
+	retiredBuffer.buffer = mBuffer;
+	retiredBuffer.fence = nullptr;
+	mRetiredBuffers.push_back(retiredBuffer);
+
+	mBuffer = 0;
+	mMapping = nullptr; // Deleting the buffer unmaps it
+}
+
+// Deletes the buffers the GPU is done with, or all of them.
+// OpenGL keeps deleted buffers alive until the commands reading them are done anyway, but not their bindings.
+void StreamBuffer::deleteRetiredBuffers(bool all)
+{
+	std::size_t kept = 0;
+
+	for(auto &retiredBuffer : mRetiredBuffers)
+	{
+		bool done = all || (retiredBuffer.fence && glClientWaitSync(retiredBuffer.fence, 0, 0) != GL_TIMEOUT_EXPIRED);
+
+		if(!done)
+		{
+			mRetiredBuffers[kept++] = retiredBuffer;
+			continue;
+		}
+
+		if(retiredBuffer.fence)
+			glDeleteSync(retiredBuffer.fence);
+
+		GLState::deleteBuffer(retiredBuffer.buffer);
+	}
+
+	mRetiredBuffers.resize(kept);
+}
+
+void StreamBuffer::waitForFence(GLsync& fence)
+{
+	if(!fence)
+		return;
+
+	GLbitfield flags = 0;
+	GLuint64 timeout = 0; // Try without waiting first
+
+	while(true)
+	{
+		GLenum result = glClientWaitSync(fence, flags, timeout);
+
+		if(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+			break;
+
+		if(result != GL_TIMEOUT_EXPIRED)
+		{
+			Utils::WARN("Waiting on a stream buffer fence failed!");
+			break;
+		}
+
+		// The GPU is a whole region behind, make sure it has our commands and wait
+		flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		timeout = STREAM_BUFFER_WAIT_TIMEOUT;
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+// PUBLIC
+
+// Moves to the next region, waits if the GPU is still reading it
+void StreamBuffer::beginFrame()
+{
+	if(!Graphics::isEnabled())
+		return;
+
+	deleteRetiredBuffers(false);
+
+	if(mBuffer == 0)
+		createBuffer();
+	else
+		mFrame = (mFrame + 1) % STREAM_BUFFER_FRAMES;
+
+	waitForFence(mFences[mFrame]);
+	mOffset = 0;
+}
+
+// Call after the frame's last draw call
+void StreamBuffer::endFrame()
+{
+	if(mBuffer == 0)
+		return;
+
+	mFences[mFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	for(auto &retiredBuffer : mRetiredBuffers)
+	{
+		if(!retiredBuffer.fence)
+			retiredBuffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+// Copies data to the frame's region and returns its offset in the buffer, a multiple of alignment (1 for none).
+// If the region is full, a bigger buffer replaces this one: use getID() after writing, not before.
+GLintptr StreamBuffer::write(const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+	if(mBuffer == 0) // Before the first frame
+		createBuffer();
+
+	GLintptr frameStart = mFrame * mFrameSize;
+	GLintptr offset = ((frameStart + mOffset + alignment - 1) / alignment) * alignment; // Alignment isn't always a power of 2
+
+	if(offset + size > frameStart + mFrameSize)
+	{
+		do
+			mFrameSize *= 2;
+		while(mFrameSize < size);
+
+		retireBuffer();
+		createBuffer();
+
+		frameStart = 0;
+		offset = 0;
+	}
+
+	if(mMapping)
+		std::memcpy(mMapping + offset, data, size);
+	else if(size > 0)
+	{
+		GLState::bindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		void* mapping = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, flags);
+
+		if(mapping)
+		{
+			std::memcpy(mapping, data, size);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		} else
+			Utils::WARN("Unable to map the stream buffer!");
+	}
+
+	mOffset = offset + size - frameStart;
+	return offset;
+}
+
+GLuint StreamBuffer::getID() const
+{
+	return mBuffer;
+}
+
+// Offsets of uniform blocks must be multiples of this
+GLint StreamBuffer::getUniformAlignment() const
+{
+	return mUniformAlignment;
+}
+
+bool StreamBuffer::isPersistent() const
+{
+	return mMapping != nullptr;
+}
@@ -0,0 +1,84 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// A buffer data is streamed through every frame: instance data, frame uniforms, debug shapes...
+// It is split in STREAM_BUFFER_FRAMES regions, one per frame. A frame writes in its region while the GPU
+// reads the last frames' ones, and a fence stops us from writing in a region the GPU hasn't finished reading.
+// With ARB_buffer_storage, the buffer stays mapped (persistent and coherent) and writes are plain copies.
+// Without it (it is not in OpenGL 3.3), each write maps its range unsynchronized, which is safe thanks to the fences.
+// Writes only stay valid for the frame. Call beginFrame() and endFrame() around every frame, on the OpenGL thread.
+
+#ifndef STREAM_BUFFER_HPP
+#define STREAM_BUFFER_HPP
+
+#include <Definitions.hpp>
+
+#include <glad/glad.h>
+
+#include <vector>
+
+class StreamBuffer
+{
+private:
+	// Replaced by a bigger buffer, deleted when the GPU is done with it
+	struct RetiredBuffer
+	{
+		GLuint buffer;
+		GLsync fence; // Null until the frame that used it ends
+	};
+
+	GLuint mBuffer; // 0 until the first frame
+	GLsizeiptr mFrameSize; // Size of a region
+	unsigned char* mMapping; // The whole buffer when persistently mapped, null otherwise
+	GLint mUniformAlignment;
+
+	GLsync mFences[STREAM_BUFFER_FRAMES]; // Set when the region's frame ends, null when the GPU is done with it
+	int mFrame; // Region being written
+	GLsizeiptr mOffset; // Where the next write goes in the region
+
+	std::vector<RetiredBuffer> mRetiredBuffers;
+
+	void createBuffer();
+	void retireBuffer();
+	void deleteRetiredBuffers(bool all);
+	void waitForFence(GLsync& fence);
+
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	void beginFrame();
+	void endFrame();
+
+	GLintptr write(const void* data, GLsizeiptr size, GLsizeiptr alignment);
+
+	// Returns the offset of data[0] in the buffer
+	template<typename dataType>
+	GLintptr write(const std::vector<dataType>& data, GLsizeiptr alignment)
+	{
+		return write(data.data(), sizeof(dataType) * data.size(), alignment);
+	}
+
+	GLuint getID() const;
+	GLint getUniformAlignment() const;
+	bool isPersistent() const;
+};
+
+#endif /* STREAM_BUFFER_HPP */
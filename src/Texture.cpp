@@ -21,6 +21,8 @@
 #include <Definitions.hpp> // For various definitions
 
 #include <Utils.hpp> // For log
+#include <Graphics.hpp>
+#include <GLState.hpp>
 
 #include <fstream> // For files
 #include <vector>
@@ -48,11 +50,17 @@ Texture::Texture(const Texture& other)
 
 Texture::~Texture()
 {
-	glDeleteTextures(1, &mID); // Delete this texture. Might save memory.
+	if(mID != 0)
+		GLState::deleteTexture(mID); // Delete this texture. Might save memory.
 }
 
 bool Texture::load()
 {
+	mID = 0;
+
+	if(!Graphics::isEnabled()) // No pixels needed without graphics
+		return true;
+
 	switch(mType)
 	{
 	case TEXTURE_BMP:
@@ -135,7 +143,7 @@ GLuint Texture::loadBMPTexture(const std::string& texturePath) // Adds a texture
 	glGenTextures(1, &textureID);
 
 	// "Bind" the new texture so that future functions will modify this
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
 
 	// Give the image to OpenGL
 	// The second color format (GL_RGB or GL_BGR) can be changed to invert colors
@@ -231,7 +239,7 @@ GLuint Texture::loadDDSTexture(const std::string& texturePath)
 	glGenTextures(1, &textureID);
 
 	// "Bind" the newly created texture : all future texture functions will modify this
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
 
 	// Fill each mipmap one after another
 	unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
@@ -33,6 +33,8 @@
 class Texture
 {
 private:
+	friend class MicroBench; // bench/MicroBench.cpp times the private hot spots
+
 	std::string mName; // May be useful, for error messages for example. Don't change this stupidly.
 	std::string mPath;
 	int mType;
@@ -18,6 +18,8 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include <TexturedObject.hpp>
+#include <Profiler.hpp>
+#include <GLState.hpp>
 #include <Utils.hpp>
 
 // In:
@@ -28,6 +30,14 @@
 // - mat4 MVP
 // - sampler2D textureSampler
 
+// Instanced shader in:
+// - layout locations 0 and 1: same as above
+// - layout location 3: mat4 model matrix, per instance
+
+// Instanced shader uniforms:
+// - sampler2D textureSampler
+// - FrameData block, for the view-projection matrix (see texturedInstanced.v.glsl)
+
 TexturedObject::TexturedObject(constObjectGeometryPointer objectGeometry,
 							   constShaderPointer shaderPointer, constTexturePointer texturePointer,
 							   bool physicsCircularShape, int physicsType)
@@ -51,57 +61,59 @@ TexturedObject::constTexturePointer TexturedObject::getTexture()
 	return mTexturePointer;
 }
 
-void TexturedObject::render(const Camera& camera)
+void TexturedObject::fillRenderItem(RenderItem& renderItem) const
 {
-	const ObjectGeometry::uintBuffer& indexBuffer = getObjectGeometry()->getIndexBuffer();
-	const ObjectGeometry::vec3Buffer& positionBuffer = getObjectGeometry()->getPositionBuffer();
-	const ObjectGeometry::vec2Buffer& UVBuffer = getObjectGeometry()->getUVBuffer();
+	Object::fillRenderItem(renderItem);
+	renderItem.texture = mTexturePointer;
+}
 
-	glm::mat4 modelMatrix = getPhysicsBody().generateModelMatrix();
+void TexturedObject::render(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+	RenderState& renderState) const
+{
+	const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
 
-	glm::mat4 MVP = camera.getProjectionMatrix() * camera.getViewMatrix() * modelMatrix;
+	glm::mat4 MVP = projectionMatrix * viewMatrix * renderItem.modelMatrix * objectGeometry.getPositionDecodeMatrix();
 	
-	glUseProgram(getShader()->getID());
-	glUniformMatrix4fv(getShader()->findUniform("MVP"), 1, GL_FALSE, &MVP[0][0]);
-	glUniform1i(getShader()->findUniform("textureSampler"), 0); // The first texture, not necessary for now
-
-	// Positions
-	glEnableVertexAttribArray(0);
-	positionBuffer.bind(GL_ARRAY_BUFFER);
-	glVertexAttribPointer(
-		0,					// Attribute 0, no particular reason but same as the vertex shader's layout and glEnableVertexAttribArray
-		3,					// Size. Number of values per vertex, must be 1, 2, 3 or 4.
-		GL_FLOAT,			// Type of data (GLfloats)
-		GL_FALSE,			// Normalized?
-		0,					// Stride
-		(void*)0			// Array buffer offset
-	);
+	if(renderState.useProgram(renderItem.shader->getID()))
+		GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_TEXTURE_SAMPLER), 0); // The first texture, not necessary for now
 
-	// UV coords
-	glEnableVertexAttribArray(1);
-	UVBuffer.bind(GL_ARRAY_BUFFER);
-	glVertexAttribPointer(
-		1,					// Attribute 1, no particular reason but same as the vertex shader's layout and glEnableVertexAttribArray
-		2,					// Size. Number of values per cell, must be 1, 2, 3 or 4.
-		GL_FLOAT,			// Type of data (GLfloats)
-		GL_FALSE,			// Normalized?
-		0,					// Stride
-		(void*)0			// Array buffer offset
-	);
+	GLState::setUniform(renderItem.shader->getUniform(SHADER_UNIFORM_MVP), MVP);
 
-	// Texture
-	glActiveTexture(GL_TEXTURE0); // Set the active texture unit, you can have more than 1 texture at once
-	glBindTexture(GL_TEXTURE_2D, mTexturePointer->getID());
+	renderState.useVertexArray(objectGeometry.getVertexArray(OBJECT_GEOMETRY_LAYOUT_POSITION_UV, false));
+	renderState.bindTexture(renderItem.texture->getID());
 
 	// Draw!
 	// Use the index buffer, more efficient!
 	glDrawElements(
 		GL_TRIANGLES,            // Mode
-		indexBuffer.getLength(), // Count
-		GL_UNSIGNED_INT,         // Type
-		(void*)0                 // Element array buffer offset
+		objectGeometry.getIndexCount(), // Count
+		objectGeometry.getIndexType(),  // Type
+		(void*)0                        // Element array buffer offset
 	);
+	Profiler::countDrawCall();
+}
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-}
\ No newline at end of file
+bool TexturedObject::canRenderInstanced() const
+{
+	return true;
+}
+
+// Uses the shader's instanced shader, see texturedInstanced.v.glsl
+void TexturedObject::renderInstanced(const InstanceBatch& instanceBatch, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+	RenderState& renderState) const
+{
+	const RenderItem& renderItem = *instanceBatch.renderItem;
+	const Shader& shader = *renderItem.shader->getInstancedShader();
+	const ObjectGeometry& objectGeometry = *renderItem.objectGeometry;
+
+	if(renderState.useProgram(shader.getID()))
+		GLState::setUniform(shader.getUniform(SHADER_UNIFORM_TEXTURE_SAMPLER), 0);
+
+	renderState.useVertexArray(objectGeometry.getVertexArray(OBJECT_GEOMETRY_LAYOUT_POSITION_UV, true));
+	renderState.useInstances(instanceBatch.instanceBuffer, instanceBatch.firstInstance);
+	renderState.bindTexture(renderItem.texture->getID());
+
+	glDrawElementsInstanced(GL_TRIANGLES, objectGeometry.getIndexCount(), objectGeometry.getIndexType(), (void*)0,
+		instanceBatch.instanceCount);
+	Profiler::countDrawCall();
+}
@@ -43,7 +43,13 @@ public:
 	void setTexture(constTexturePointer texturePointer);
 	constTexturePointer getTexture();
 
-	void render(const Camera& camera) override;
+	using Object::render; // Keep render(camera) visible
+	void fillRenderItem(RenderItem& renderItem) const override;
+	void render(const RenderItem& renderItem, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		RenderState& renderState) const override;
+	bool canRenderInstanced() const override;
+	void renderInstanced(const InstanceBatch& instanceBatch, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
+		RenderState& renderState) const override;
 };
 
 #endif /* TEXTURED_OBJECT_HPP */
\ No newline at end of file
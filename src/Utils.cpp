@@ -23,15 +23,18 @@
 #include <SDL.h> // For quitting
 #include <SDL_mixer.h> // For quitting
 #include <fstream>
+#include <mutex> // Jobs can log too
 
 #include <sstream> // For std::getLine()
 
 namespace Utils
 {
 std::ofstream gLogFile(LOG_FILE, std::ios::app); // Evil global
+std::mutex gLogFileMutex;
 
 void closeLogFile() // Log file opens by itself, but doesn't close by itself
 {
+	std::lock_guard<std::mutex> lock(gLogFileMutex);
 	gLogFile.close();
 }
 
@@ -50,6 +53,7 @@ void clearDataOutput()
 
 void directly_logprint(const std::string& msg, int line, const char* file)
 {
+	std::lock_guard<std::mutex> lock(gLogFileMutex);
 	gLogFile << msg << '\n';
 
 #ifndef NDEBUG // Debug
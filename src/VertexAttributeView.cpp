@@ -0,0 +1,123 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+#include <VertexAttributeView.hpp>
+#include <ObjectGeometry.hpp>
+#include <Utils.hpp>
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+template<typename attributeType>
+VertexAttributeView<attributeType>::VertexAttributeView(const ObjectGeometry* objectGeometry, int attribute)
+{
+	mObjectGeometry = objectGeometry;
+	mMutableObjectGeometry = nullptr;
+	mAttribute = attribute;
+}
+
+template<typename attributeType>
+VertexAttributeView<attributeType>::VertexAttributeView(ObjectGeometry* objectGeometry, int attribute)
+{
+	mObjectGeometry = objectGeometry;
+	mMutableObjectGeometry = objectGeometry;
+	mAttribute = attribute;
+}
+
+// Private
+template<typename attributeType>
+attributeType VertexAttributeView<attributeType>::getValue(std::size_t vertexIndex) const
+{
+	const ObjectGeometry::Vertex& vertex = mObjectGeometry->mVertices[vertexIndex];
+	const char* attribute = reinterpret_cast<const char*>(&vertex) + ObjectGeometry::getVertexAttribute(mAttribute).offset;
+
+	return *reinterpret_cast<const attributeType*>(attribute);
+}
+
+// Private
+template<typename attributeType>
+void VertexAttributeView<attributeType>::setValue(std::size_t vertexIndex, const attributeType& value)
+{
+	ObjectGeometry::Vertex& vertex = mMutableObjectGeometry->mVertices[vertexIndex];
+	char* attribute = reinterpret_cast<char*>(&vertex) + ObjectGeometry::getVertexAttribute(mAttribute).offset;
+
+	*reinterpret_cast<attributeType*>(attribute) = value;
+}
+
+// Amount of vertices
+template<typename attributeType>
+int VertexAttributeView<attributeType>::getLength() const
+{
+	return static_cast<int>(mObjectGeometry->mVertices.size());
+}
+
+template<typename attributeType>
+std::vector<attributeType> VertexAttributeView<attributeType>::read() const
+{
+	std::vector<attributeType> data(mObjectGeometry->mVertices.size());
+
+	for(std::size_t i = 0; i < data.size(); i++)
+		data[i] = getValue(i);
+
+	return data;
+}
+
+// Must have a value for every vertex, the other attributes are kept
+template<typename attributeType>
+void VertexAttributeView<attributeType>::setData(const std::vector<attributeType>& data)
+{
+	if(data.size() != mObjectGeometry->mVertices.size())
+	{
+		Utils::WARN("Geometry '" + mObjectGeometry->getName() + "' has " + std::to_string(mObjectGeometry->mVertices.size()) +
+			" vertices, can't set " + std::to_string(data.size()) + " values! Create a new geometry to change the vertex count.");
+		return;
+	}
+
+	modify(0, data);
+}
+
+// Like GPUBuffer::modify(), offset is in bytes as if this attribute had its own buffer
+template<typename attributeType>
+void VertexAttributeView<attributeType>::modify(GLintptr offset, const std::vector<attributeType>& data)
+{
+	if(!mMutableObjectGeometry)
+	{
+		Utils::CRASH("Can't modify the vertices of geometry '" + mObjectGeometry->getName() + "' through a read only view!");
+		return;
+	}
+
+	std::size_t first = offset / sizeof(attributeType);
+
+	if(first + data.size() > mObjectGeometry->mVertices.size())
+	{
+		Utils::WARN("Modifying past the last vertex of geometry '" + mObjectGeometry->getName() + "'! Ignoring.");
+		return;
+	}
+
+	for(std::size_t i = 0; i < data.size(); i++)
+		setValue(first + i, data[i]);
+
+	mMutableObjectGeometry->updateVertexBuffer(first, data.size());
+}
+
+// The only types we need
+template class VertexAttributeView<glm::vec2>;
+template class VertexAttributeView<glm::vec3>;
@@ -0,0 +1,56 @@
+//// Copyright 2016 Carl Hewett
+////
+//// This file is part of SDL3D.
+////
+//// SDL3D is free software: you can redistribute it and/or modify
+//// it under the terms of the GNU General Public License as published by
+//// the Free Software Foundation, either version 3 of the License, or
+//// (at your option) any later version.
+////
+//// SDL3D is distributed in the hope that it will be useful,
+//// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//// GNU General Public License for more details.
+////
+//// You should have received a copy of the GNU General Public License
+//// along with SDL3D. If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+
+
+// Looks like one attribute (ex: positions) of an ObjectGeometry's interleaved vertices, as if it had its own buffer.
+// Reading doesn't touch OpenGL, writing updates the geometry's vertex buffer.
+// Only valid while the geometry is alive!
+
+#ifndef VERTEX_ATTRIBUTE_VIEW_HPP
+#define VERTEX_ATTRIBUTE_VIEW_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+class ObjectGeometry;
+
+template<typename attributeType>
+class VertexAttributeView
+{
+private:
+	const ObjectGeometry* mObjectGeometry;
+	ObjectGeometry* mMutableObjectGeometry; // Null for read only views
+	int mAttribute; // OBJECT_GEOMETRY_ATTRIBUTE_*
+
+	attributeType getValue(std::size_t vertexIndex) const;
+	void setValue(std::size_t vertexIndex, const attributeType& value);
+
+public:
+	VertexAttributeView(const ObjectGeometry* objectGeometry, int attribute);
+	VertexAttributeView(ObjectGeometry* objectGeometry, int attribute);
+
+	int getLength() const;
+	std::vector<attributeType> read() const;
+
+	void setData(const std::vector<attributeType>& data);
+	void modify(GLintptr offset, const std::vector<attributeType>& data);
+};
+
+#endif /* VERTEX_ATTRIBUTE_VIEW_HPP */